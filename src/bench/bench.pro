@@ -19,6 +19,7 @@ SOURCES += \
     host.cpp \
     hostmodel.cpp \
     hostwidget.cpp \
+    latencyhistogram.cpp \
     dummydelegate.cpp \
     allhostswidget.cpp \
     hostmanager.cpp \
@@ -42,6 +43,7 @@ HEADERS += \
     host.h \
     hostmodel.h \
     hostwidget.h \
+    latencyhistogram.h \
     dummydelegate.h \
     allhostswidget.h \
     hostmanager.h \
@@ -102,6 +102,12 @@ HostWidget::HostWidget(QWidget *parent) :
     m_sendProgress->setValue(1);
     m_stackedLayout->insertWidget(PROGRESS_STACK_INDEX, m_sendProgress);
 
+    m_latencyLabel = new QLabel(m_groupBox);
+    m_latencyLabel->setAlignment(Qt::AlignCenter);
+    m_latencyLabel->setEnabled(false);
+    m_latencyLabel->hide();
+    vbox->addWidget(m_latencyLabel);
+
     vbox->addWidget(toolBar);;
 
     connect(&m_publisher, &RemotePublisher::connected, this, &HostWidget::connected);
@@ -110,10 +116,15 @@ HostWidget::HostWidget(QWidget *parent) :
     connect(&m_publisher, &RemotePublisher::connectionError, this, &HostWidget::onConnectionError);
     connect(&m_publisher, &RemotePublisher::sendingError, this, &HostWidget::onSendingError);
     connect(&m_publisher, &RemotePublisher::sentSuccessfully, this, &HostWidget::onSentSuccessfully);
+    // Nodes acknowledging changes are only done once they applied them
+    connect(&m_publisher, &RemotePublisher::acknowledged, this, &HostWidget::onSentSuccessfully);
+    connect(&m_publisher, &RemotePublisher::latencyMeasured, this, &HostWidget::onLatencyMeasured);
+    connect(&m_publisher, &RemotePublisher::superseded, this, &HostWidget::onSuperseded);
     connect(&m_publisher, &RemotePublisher::needsPinAuthentication, this, &HostWidget::showPinDialog);
     connect(&m_publisher, &RemotePublisher::pinOk, this, &HostWidget::onPinOk);
     connect(&m_publisher, &RemotePublisher::remoteLog, this, &HostWidget::remoteLog);
     connect(&m_publisher, &RemotePublisher::clearLog, this, &HostWidget::clearLog);
+    connect(&m_publisher, &RemotePublisher::sendProgress, this, &HostWidget::updateProgress);
 }
 
 void HostWidget::setHost(Host *host)
@@ -148,13 +159,16 @@ void HostWidget::setLiveHubEngine(LiveHubEngine *engine)
     m_engine = engine;
 
     m_publisher.setWorkspace(m_engine->workspace());
+    m_publisher.setHub(m_engine);
 
     connect(m_engine.data(), &LiveHubEngine::workspaceChanged, &m_publisher, &RemotePublisher::setWorkspace);
     connect(m_engine.data(), &LiveHubEngine::workspaceChanged, this, &HostWidget::refreshDocumentLabel);
     connect(m_engine.data(), &LiveHubEngine::fileChanged, this, &HostWidget::sendDocument);
+    connect(m_engine.data(), &LiveHubEngine::fileRemoved, this, &HostWidget::removeDocument);
     connect(m_engine.data(), &LiveHubEngine::beginPublishWorkspace, &m_publisher, &RemotePublisher::beginBulkSend);
     connect(m_engine.data(), &LiveHubEngine::endPublishWorkspace, &m_publisher, &RemotePublisher::endBulkSend);
     connect(&m_publisher, &RemotePublisher::needsPublishWorkspace, this, &HostWidget::publishWorkspace);
+    connect(&m_publisher, &RemotePublisher::updatingWorkspace, this, &HostWidget::onUpdatingWorkspace);
 }
 
 void HostWidget::setCurrentFile(const LiveDocument &currentFile)
@@ -350,14 +364,37 @@ void HostWidget::publishWorkspace()
     disconnect(m_engine.data(), &LiveHubEngine::publishFile, this, &HostWidget::sendDocument);
 }
 
+void HostWidget::onUpdatingWorkspace(const QList<QUuid> &uuids)
+{
+    if (uuids.isEmpty())
+        return;
+
+    m_stackedLayout->setCurrentIndex(PROGRESS_STACK_INDEX);
+    m_changeIds.append(uuids);
+}
+
 void HostWidget::sendDocument(const LiveDocument& document)
 {
-    if (m_publisher.state() != QAbstractSocket::ConnectedState)
+    // Journaled by the publisher, replayed on reconnect
+    if (m_publisher.state() != QAbstractSocket::ConnectedState) {
+        m_publisher.sendDocument(document);
         return;
+    }
 
     m_stackedLayout->setCurrentIndex(PROGRESS_STACK_INDEX);
     m_changeIds.append(m_publisher.sendDocument(document));
-    m_sendProgress->setMaximum(m_sendProgress->maximum() + 1);
+}
+
+void HostWidget::updateProgress(qint64 bytesSent, qint64 bytesTotal)
+{
+    // Permille, byte counts may exceed the range of QProgressBar
+    m_sendProgress->setMaximum(1000);
+    m_sendProgress->setValue(bytesTotal > 0 ? int(bytesSent * 1000 / bytesTotal) : 1000);
+}
+
+void HostWidget::removeDocument(const LiveDocument& document)
+{
+    m_publisher.removeDocument(document);
 }
 
 void HostWidget::sendXOffset(int offset)
@@ -403,6 +440,9 @@ void HostWidget::onSendingError(const QUuid &uuid, QAbstractSocket::SocketError
 
 void HostWidget::onSentSuccessfully(const QUuid &uuid)
 {
+    if (m_publisher.isAwaitingAcknowledgement(uuid))
+        return;
+
     if (uuid == m_activateId) {
         m_connectDisconnectAction->setIcon(QIcon(":images/okay_ball.svg"));
         m_activateId = QUuid();
@@ -417,7 +457,6 @@ void HostWidget::onSentSuccessfully(const QUuid &uuid)
         m_rotationId = QUuid();
     } else if (m_changeIds.contains(uuid)) {
         m_changeIds.removeAll(uuid);
-        m_sendProgress->setValue(m_sendProgress->value() + 1);
         if (m_changeIds.isEmpty()) {
             m_connectDisconnectAction->setIcon(QIcon(":images/okay_ball.svg"));
             resetProgressBar();
@@ -425,6 +464,38 @@ void HostWidget::onSentSuccessfully(const QUuid &uuid)
     }
 }
 
+void HostWidget::onSuperseded(const QUuid &uuid)
+{
+    // A newer version of the document is on its way
+    if (m_changeIds.removeAll(uuid) && m_changeIds.isEmpty())
+        resetProgressBar();
+}
+
+void HostWidget::onLatencyMeasured(qint64 roundTrip, qint64 applyLatency)
+{
+    if (roundTrip >= 0)
+        m_roundTrips.add(roundTrip);
+    m_applyLatencies.add(applyLatency);
+
+    QString text = tr("Applied in %1 ms").arg(applyLatency);
+    if (roundTrip >= 0)
+        text += tr(", RTT %1 ms").arg(roundTrip);
+    m_latencyLabel->setText(text);
+
+    QString toolTip = tr("<b>Apply latency</b> (median %1 ms, 95%: %2 ms)<pre>%3</pre>")
+            .arg(m_applyLatencies.percentile(50))
+            .arg(m_applyLatencies.percentile(95))
+            .arg(m_applyLatencies.toString().toHtmlEscaped());
+    if (m_roundTrips.count() > 0) {
+        toolTip += tr("<b>Round trip</b> (median %1 ms, 95%: %2 ms)<pre>%3</pre>")
+                .arg(m_roundTrips.percentile(50))
+                .arg(m_roundTrips.percentile(95))
+                .arg(m_roundTrips.toString().toHtmlEscaped());
+    }
+    m_latencyLabel->setToolTip(toolTip);
+    m_latencyLabel->show();
+}
+
 void HostWidget::resetProgressBar()
 {
     m_sendProgress->setValue(1);
@@ -35,6 +35,8 @@
 #include <QtWidgets>
 #include <remotepublisher.h>
 
+#include "latencyhistogram.h"
+
 class Host;
 class LiveDocument;
 
@@ -82,7 +84,9 @@ private slots:
     void onDisconnected();
     void onConnectionError(QAbstractSocket::SocketError error);
 
+    void onUpdatingWorkspace(const QList<QUuid> &uuids);
     void sendDocument(const LiveDocument &document);
+    void removeDocument(const LiveDocument &document);
 
     void sendXOffset(int offset);
     void sendYOffset(int offset);
@@ -90,6 +94,9 @@ private slots:
 
     void onSentSuccessfully(const QUuid &uuid);
     void onSendingError(const QUuid &uuid, QAbstractSocket::SocketError socketError);
+    void onSuperseded(const QUuid &uuid);
+    void onLatencyMeasured(qint64 roundTrip, qint64 applyLatency);
+    void updateProgress(qint64 bytesSent, qint64 bytesTotal);
     void resetProgressBar();
 
     void showPinDialog();
@@ -107,6 +114,7 @@ private:
     QLabel* m_documentLabel;
 //    QLabel* m_statusLabel;
     QProgressBar* m_sendProgress;
+    QLabel* m_latencyLabel;
     QToolButton* m_menuButton;
     QMenu* m_menu;
     QAction* m_publishAction;
@@ -126,5 +134,8 @@ private:
     QUuid m_xOffsetId;
     QUuid m_yOffsetId;
     QUuid m_rotationId;
+
+    LatencyHistogram m_roundTrips;
+    LatencyHistogram m_applyLatencies;
 };
 
@@ -0,0 +1,112 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "latencyhistogram.h"
+
+#include <algorithm>
+
+LatencyHistogram::LatencyHistogram()
+    : m_buckets(BucketCount, 0)
+    , m_count(0)
+{
+}
+
+void LatencyHistogram::add(qint64 msecs)
+{
+    int bucket = 0;
+    while (bucket < BucketCount - 1 && msecs > upperBound(bucket))
+        ++bucket;
+    ++m_buckets[bucket];
+    ++m_count;
+}
+
+void LatencyHistogram::clear()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+}
+
+int LatencyHistogram::count() const
+{
+    return m_count;
+}
+
+// Returns the upper bound of the bucket holding the given percentile, -1
+// without measurements. The last bucket has none, its lower bound is used.
+qint64 LatencyHistogram::percentile(int percent) const
+{
+    if (m_count == 0)
+        return -1;
+
+    const int rank = qMax(1, (m_count * percent + 99) / 100);
+    int seen = 0;
+    int bucket = 0;
+    for (; bucket < BucketCount - 1; ++bucket) {
+        seen += m_buckets.at(bucket);
+        if (seen >= rank)
+            break;
+    }
+    return upperBound(qMin(bucket, BucketCount - 2));
+}
+
+QString LatencyHistogram::toString() const
+{
+    const int maximum = *std::max_element(m_buckets.constBegin(), m_buckets.constEnd());
+    if (maximum == 0)
+        return QString();
+
+    int first = 0;
+    while (m_buckets.at(first) == 0)
+        ++first;
+    int last = BucketCount - 1;
+    while (m_buckets.at(last) == 0)
+        --last;
+
+    const int barWidth = 20;
+    QString text;
+    for (int bucket = first; bucket <= last; ++bucket) {
+        const QString bound = bucket == BucketCount - 1
+                ? QString::fromLatin1(" >%1").arg(upperBound(bucket - 1), 5)
+                : QString::fromLatin1("<=%1").arg(upperBound(bucket), 5);
+        const int count = m_buckets.at(bucket);
+        text += QString::fromLatin1("%1 ms %2 %3\n")
+                .arg(bound)
+                .arg(QString(count * barWidth / maximum, QLatin1Char('#')), -barWidth)
+                .arg(count);
+    }
+    return text;
+}
+
+qint64 LatencyHistogram::upperBound(int bucket)
+{
+    return qint64(1) << bucket;
+}
@@ -462,6 +462,7 @@ void MasterApplication::applyOptions(const Options &options)
         else {
             ProjectManager pr;
             if (pr.read(options.project())) {
+               m_window->setIgnoreRules(pr.ignoreRules());
                m_window->setWorkspace(pr.workspace());
                m_window->setImportPaths(pr.imports());
                m_window->activateDocument(LiveDocument(pr.mainDocument()));
@@ -211,6 +211,24 @@ void MainWindow::setupWorkspaceView()
         m_hub->setWorkspace(m_hub->workspace());
     });
 
+    auto scanLabel = new QLabel;
+    scanLabel->setContentsMargins(4, 2, 4, 2);
+    scanLabel->setVisible(false);
+    layout->addWidget(scanLabel);
+
+    connect(m_hub, &LiveHubEngine::workspaceChanged, scanLabel, [scanLabel]() {
+        scanLabel->setText(tr("Scanning workspace..."));
+        scanLabel->setVisible(true);
+    });
+    connect(m_hub, &LiveHubEngine::watchingProgress, scanLabel, [scanLabel](int directories) {
+        scanLabel->setText(tr("Scanning workspace... %1 directories").arg(directories));
+    });
+    connect(m_hub, &LiveHubEngine::watchingReady, scanLabel, &QWidget::hide);
+    connect(m_hub, &LiveHubEngine::errorChanged, scanLabel, [this, scanLabel]() {
+        if (m_hub->hasError())
+            scanLabel->hide();
+    });
+
     layout->addWidget(m_workspace);
 
     m_workspaceDock->setWidget(contents);
@@ -504,6 +522,11 @@ void MainWindow::setImportPaths(const QStringList &pathList)
     m_node->qmlEngine()->setImportPathList(pathList + m_qmlDefaultimportList);
 }
 
+void MainWindow::setIgnoreRules(const QStringList &rules)
+{
+    m_hub->setIgnoreRules(rules);
+}
+
 void MainWindow::setStaysOnTop(bool enabled)
 {
     m_stayOnTop->setChecked(enabled);
@@ -655,6 +678,7 @@ void MainWindow::openProjectFile(const QString &path)
         s.endArray();
 
         setImportPaths(paths);
+        setIgnoreRules(m_projectManager->ignoreRules());
         QString path = QDir(m_projectManager->projectLocation()).absoluteFilePath(m_projectManager->workspace());
         setWorkspace(path);
         activateDocument(LiveDocument(m_projectManager->mainDocument()));
@@ -682,6 +706,7 @@ void MainWindow::newProject()
     m_projectManager->create(m_newProjectWizard->projectName());
 
     setImportPaths(m_newProjectWizard->imports());
+    setIgnoreRules(m_projectManager->ignoreRules());
     QString path = QDir(m_projectManager->projectLocation()).absoluteFilePath(m_newProjectWizard->workspace());
     setWorkspace(path);
     activateDocument(LiveDocument(m_newProjectWizard->mainDocument()));
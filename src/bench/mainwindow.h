@@ -66,6 +66,7 @@ public:
     void setWorkspace(const QString& path, bool activateRootPath = true);
     void setPluginPath(const QString& path);
     void setImportPaths(const QStringList& pathList);
+    void setIgnoreRules(const QStringList& rules);
     void setStaysOnTop(bool enabled);
     void setProject(const QString& projectFile);
     void init();
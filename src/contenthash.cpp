@@ -0,0 +1,309 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "contenthash.h"
+
+namespace {
+
+const quint64 Prime1 = Q_UINT64_C(0x9E3779B185EBCA87);
+const quint64 Prime2 = Q_UINT64_C(0xC2B2AE3D27D4EB4F);
+const quint64 Prime3 = Q_UINT64_C(0x165667B19E3779F9);
+const quint64 Prime4 = Q_UINT64_C(0x85EBCA77C2B2AE63);
+const quint64 Prime5 = Q_UINT64_C(0x27D4EB2F165667C5);
+
+inline quint64 rotateLeft(quint64 value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline quint64 xxhRound(quint64 accumulator, quint64 input)
+{
+    accumulator += input * Prime2;
+    accumulator = rotateLeft(accumulator, 31);
+    return accumulator * Prime1;
+}
+
+inline quint64 mergeRound(quint64 accumulator, quint64 value)
+{
+    accumulator ^= xxhRound(0, value);
+    return accumulator * Prime1 + Prime4;
+}
+
+// Streaming XXH64, see https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+class Xxh64
+{
+public:
+    explicit Xxh64(quint64 seed)
+        : m_seed(seed)
+        , m_v1(seed + Prime1 + Prime2)
+        , m_v2(seed + Prime2)
+        , m_v3(seed)
+        , m_v4(seed - Prime1)
+        , m_buffered(0)
+        , m_total(0)
+    {
+    }
+
+    void update(const uchar *data, qint64 size)
+    {
+        m_total += quint64(size);
+
+        if (m_buffered + size < 32) {
+            memcpy(m_buffer + m_buffered, data, size_t(size));
+            m_buffered += int(size);
+            return;
+        }
+
+        if (m_buffered > 0) {
+            const int fill = 32 - m_buffered;
+            memcpy(m_buffer + m_buffered, data, size_t(fill));
+            consume(m_buffer);
+            data += fill;
+            size -= fill;
+            m_buffered = 0;
+        }
+
+        for (; size >= 32; data += 32, size -= 32)
+            consume(data);
+
+        memcpy(m_buffer, data, size_t(size));
+        m_buffered = int(size);
+    }
+
+    quint64 digest() const
+    {
+        quint64 hash;
+        if (m_total >= 32) {
+            hash = rotateLeft(m_v1, 1) + rotateLeft(m_v2, 7) + rotateLeft(m_v3, 12) + rotateLeft(m_v4, 18);
+            hash = mergeRound(hash, m_v1);
+            hash = mergeRound(hash, m_v2);
+            hash = mergeRound(hash, m_v3);
+            hash = mergeRound(hash, m_v4);
+        } else {
+            hash = m_seed + Prime5;
+        }
+
+        hash += m_total;
+
+        const uchar *p = m_buffer;
+        const uchar *end = m_buffer + m_buffered;
+        while (p + 8 <= end) {
+            hash ^= xxhRound(0, qFromLittleEndian<quint64>(p));
+            hash = rotateLeft(hash, 27) * Prime1 + Prime4;
+            p += 8;
+        }
+        if (p + 4 <= end) {
+            hash ^= quint64(qFromLittleEndian<quint32>(p)) * Prime1;
+            hash = rotateLeft(hash, 23) * Prime2 + Prime3;
+            p += 4;
+        }
+        while (p < end) {
+            hash ^= quint64(*p) * Prime5;
+            hash = rotateLeft(hash, 11) * Prime1;
+            ++p;
+        }
+
+        hash ^= hash >> 33;
+        hash *= Prime2;
+        hash ^= hash >> 29;
+        hash *= Prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+private:
+    void consume(const uchar *p)
+    {
+        m_v1 = xxhRound(m_v1, qFromLittleEndian<quint64>(p));
+        m_v2 = xxhRound(m_v2, qFromLittleEndian<quint64>(p + 8));
+        m_v3 = xxhRound(m_v3, qFromLittleEndian<quint64>(p + 16));
+        m_v4 = xxhRound(m_v4, qFromLittleEndian<quint64>(p + 24));
+    }
+
+    quint64 m_seed;
+    quint64 m_v1;
+    quint64 m_v2;
+    quint64 m_v3;
+    quint64 m_v4;
+    uchar m_buffer[32];
+    int m_buffered;
+    quint64 m_total;
+};
+
+// Files are read in blocks of this size when not mapped
+const qint64 ReadBlockSize = 64 * 1024;
+
+} // namespace
+
+/*!
+ \class ContentHash
+ \inmodule qmllive
+ \brief A compact fingerprint of file contents
+
+ ContentHash combines the size of the content with its 64 bit XXH64 hash.
+ XXH64 processes several gigabytes per second on a single core and gives the
+ same result on every platform, so hashes computed by a hub and a node can be
+ compared with each other. It is meant to detect changes, not to protect
+ against deliberate collisions.
+
+ A default constructed hash isNull(), which is also returned for files which
+ can not be read.
+ */
+
+/*!
+ Returns the hash of \a data
+ */
+ContentHash ContentHash::fromData(const QByteArray &data)
+{
+    return fromData(reinterpret_cast<const uchar *>(data.constData()), data.size());
+}
+
+/*!
+ Returns the hash of \a size bytes at \a data
+ */
+ContentHash ContentHash::fromData(const uchar *data, qint64 size)
+{
+    Xxh64 state(0);
+    state.update(data, size);
+
+    ContentHash hash;
+    hash.m_size = size;
+    hash.m_value = state.digest();
+    return hash;
+}
+
+/*!
+ \enum ContentHash::ReadMode
+
+ Selects how fromFile() reads the file:
+
+ \value Buffered
+        The file is read in blocks. Safe for files other processes may
+        truncate or rewrite in place while they are hashed, like the files of
+        a workspace being edited.
+ \value Mapped
+        The file is memory mapped where possible. Only use this for files
+        which are replaced atomically, truncating a mapped file while it is
+        hashed raises SIGBUS.
+ */
+
+/*!
+ Returns the hash of the contents of the file \a path, read according to
+ \a mode. Returns a null hash if the file can not be read.
+
+ This function is thread-safe.
+ */
+ContentHash ContentHash::fromFile(const QString &path, ReadMode mode)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return ContentHash();
+
+    const qint64 size = file.size();
+    if (size == 0)
+        return fromData(QByteArray());
+
+    if (mode == Mapped) {
+        if (uchar *data = file.map(0, size)) {
+            const ContentHash hash = fromData(data, size);
+            file.unmap(data);
+            return hash;
+        }
+    }
+
+    // The size is the one actually read, the file may change meanwhile
+    Xxh64 state(0);
+    QByteArray block(int(qMin(size, ReadBlockSize)), Qt::Uninitialized);
+    qint64 total = 0;
+    forever {
+        const qint64 read = file.read(block.data(), block.size());
+        if (read < 0)
+            return ContentHash();
+        if (read == 0)
+            break;
+        state.update(reinterpret_cast<const uchar *>(block.constData()), read);
+        total += read;
+    }
+
+    ContentHash hash;
+    hash.m_size = total;
+    hash.m_value = state.digest();
+    return hash;
+}
+
+/*!
+ \fn ContentHash::isNull() const
+
+ Returns true for a default constructed hash
+ */
+
+/*!
+ \fn ContentHash::size() const
+
+ Returns the size of the hashed content in bytes, or -1 for a null hash
+ */
+
+/*!
+ \fn ContentHash::value() const
+
+ Returns the 64 bit hash value
+ */
+
+/*!
+ Returns the hash as a hexadecimal string, for debugging
+ */
+QString ContentHash::toString() const
+{
+    if (isNull())
+        return QStringLiteral("null");
+    return QStringLiteral("%1:%2").arg(m_size).arg(m_value, 16, 16, QLatin1Char('0'));
+}
+
+/*!
+ \relates ContentHash
+
+ Writes \a hash to the stream \a out
+ */
+QDataStream &operator<<(QDataStream &out, const ContentHash &hash)
+{
+    return out << hash.m_size << hash.m_value;
+}
+
+/*!
+ \relates ContentHash
+
+ Reads \a hash from the stream \a in
+ */
+QDataStream &operator>>(QDataStream &in, ContentHash &hash)
+{
+    return in >> hash.m_size >> hash.m_value;
+}
@@ -0,0 +1,81 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore>
+
+#include "qmllive_global.h"
+
+class QMLLIVESHARED_EXPORT ContentHash
+{
+public:
+    enum ReadMode
+    {
+        Buffered,
+        Mapped
+    };
+
+    ContentHash() {}
+
+    static ContentHash fromData(const QByteArray &data);
+    static ContentHash fromData(const uchar *data, qint64 size);
+    static ContentHash fromFile(const QString &path, ReadMode mode = Buffered);
+
+    bool isNull() const { return m_size < 0; }
+    qint64 size() const { return m_size; }
+    quint64 value() const { return m_value; }
+    QString toString() const;
+
+    bool operator==(const ContentHash &other) const
+    {
+        return m_size == other.m_size && m_value == other.m_value;
+    }
+    bool operator!=(const ContentHash &other) const { return !operator==(other); }
+
+private:
+    friend QDataStream &operator<<(QDataStream &out, const ContentHash &hash);
+    friend QDataStream &operator>>(QDataStream &in, ContentHash &hash);
+
+    qint64 m_size = -1;
+    quint64 m_value = 0;
+};
+
+QMLLIVESHARED_EXPORT QDataStream &operator<<(QDataStream &out, const ContentHash &hash);
+QMLLIVESHARED_EXPORT QDataStream &operator>>(QDataStream &in, ContentHash &hash);
+
+inline uint qHash(const ContentHash &hash, uint seed = 0)
+{
+    return qHash(hash.value(), seed);
+}
+
+Q_DECLARE_METATYPE(ContentHash)
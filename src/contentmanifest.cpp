@@ -0,0 +1,118 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "contentmanifest.h"
+
+namespace {
+const quint32 Magic = 0x514c4d46; // "QLMF"
+const quint8 Version = 1;
+// An empty path length followed by the size and hash value
+const int MinimumEntrySize = 4 + 8 + 8;
+// Magic, version and count
+const int HeaderSize = 4 + 1 + 4;
+}
+
+/*!
+ \class ContentManifest
+ \inmodule qmllive
+ \brief Lists the documents of a workspace with their ContentHash
+
+ A node sends the manifest of its workspace when asking a hub to publish the
+ workspace. The hub then only needs to publish the documents which are
+ missing or differ, and to remove the ones it does not have.
+
+ Paths are relative to the workspace.
+ */
+
+/*!
+ Parses a manifest serialized with toData() from \a data
+
+ The returned manifest is not valid if \a data is empty or malformed, e.g.
+ when it was sent by a node without manifest support.
+ */
+ContentManifest ContentManifest::fromData(const QByteArray &data)
+{
+    ContentManifest manifest;
+    if (data.isEmpty())
+        return manifest;
+
+    QDataStream in(data);
+    quint32 magic = 0;
+    quint8 version = 0;
+    quint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != Magic || version != Version)
+        return manifest;
+
+    // The count comes from the peer, only trust it as far as the data goes
+    const int available = (data.size() - HeaderSize) / MinimumEntrySize;
+    manifest.m_hashes.reserve(int(qMin<quint32>(count, quint32(qMax(available, 0)))));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        ContentHash hash;
+        in >> path >> hash;
+        manifest.m_hashes.insert(path, hash);
+    }
+
+    manifest.m_valid = in.status() == QDataStream::Ok;
+    if (!manifest.m_valid)
+        manifest.m_hashes.clear();
+    return manifest;
+}
+
+/*!
+ Serializes the manifest for sending it to a hub
+ */
+QByteArray ContentManifest::toData() const
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << Magic << Version << quint32(m_hashes.count());
+    for (auto it = m_hashes.constBegin(); it != m_hashes.constEnd(); ++it)
+        out << it.key() << it.value();
+    return data;
+}
+
+/*!
+ \fn ContentManifest::isValid() const
+
+ Returns true if the manifest was parsed successfully or explicitly made
+ valid with setValid()
+ */
+
+/*!
+ Records the document \a path with its content \a hash
+ */
+void ContentManifest::insert(const QString &path, const ContentHash &hash)
+{
+    m_hashes.insert(path, hash);
+}
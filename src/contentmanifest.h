@@ -0,0 +1,62 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore>
+
+#include "contenthash.h"
+#include "qmllive_global.h"
+
+class QMLLIVESHARED_EXPORT ContentManifest
+{
+public:
+    ContentManifest() {}
+
+    static ContentManifest fromData(const QByteArray &data);
+    QByteArray toData() const;
+
+    bool isValid() const { return m_valid; }
+    void setValid(bool valid) { m_valid = valid; }
+
+    void insert(const QString &path, const ContentHash &hash);
+    bool contains(const QString &path) const { return m_hashes.contains(path); }
+    ContentHash value(const QString &path) const { return m_hashes.value(path); }
+    int count() const { return m_hashes.count(); }
+    QStringList paths() const { return m_hashes.keys(); }
+
+private:
+    bool m_valid = false;
+    QHash<QString, ContentHash> m_hashes;
+};
+
+Q_DECLARE_METATYPE(ContentManifest)
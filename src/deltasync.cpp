@@ -0,0 +1,331 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "deltasync.h"
+#include "contenthash.h"
+
+namespace {
+
+const quint32 SignatureMagic = 0x514c5347; // "QLSG"
+const quint32 DeltaMagic = 0x514c444c; // "QLDL"
+const quint8 Version = 1;
+
+const int MinimumBlockSize = 512;
+const int MaximumBlockSize = 64 * 1024;
+
+// Bytes per block in a signature, the weak and the strong checksum
+const int SignatureBlockSize = 4 + 8;
+
+enum Operation : quint8 {
+    End,
+    Copy,
+    Literal
+};
+
+struct Block
+{
+    quint32 weak;
+    quint64 strong;
+};
+
+// Rolling checksum as used by rsync, a and b are kept mod 2^16
+struct WeakChecksum
+{
+    quint32 a = 0;
+    quint32 b = 0;
+    int length = 0;
+
+    void reset(const uchar *data, int size)
+    {
+        a = 0;
+        b = 0;
+        length = size;
+        for (int i = 0; i < size; ++i) {
+            a += data[i];
+            b += quint32(size - i) * data[i];
+        }
+        a &= 0xffff;
+        b &= 0xffff;
+    }
+
+    void roll(uchar out, uchar in)
+    {
+        a = (a - out + in) & 0xffff;
+        b = (b - quint32(length) * out + a) & 0xffff;
+    }
+
+    quint32 value() const { return (b << 16) | a; }
+};
+
+quint64 strongChecksum(const uchar *data, int size)
+{
+    return ContentHash::fromData(data, size).value();
+}
+
+} // namespace
+
+/*!
+ \class DeltaSync
+ \internal
+ \brief Rolling checksum delta transfer in the manner of rsync
+
+ The receiving side describes the version of a document it has with
+ signature(). The sending side finds the blocks of that version in the new
+ version with delta(), so only the ranges which changed need to be sent. The
+ receiving side reconstructs the new version with patch().
+
+ Both signature and delta carry a ContentHash of the version they were
+ computed for, so patch() refuses to apply a delta to anything but exactly
+ that version and verifies the result.
+ */
+
+/*!
+ Returns the block size used for a document of \a size bytes
+
+ Roughly the square root of the size, which balances the size of the
+ signature against the granularity of matching.
+ */
+int DeltaSync::blockSize(qint64 size)
+{
+    const int root = int(qSqrt(qreal(size)));
+    int blockSize = MinimumBlockSize;
+    while (blockSize < root && blockSize < MaximumBlockSize)
+        blockSize *= 2;
+    return blockSize;
+}
+
+/*!
+ Returns the block signature of \a base
+ */
+QByteArray DeltaSync::signature(const QByteArray &base)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(base.constData());
+    const int size = base.size();
+    const int length = blockSize(size);
+
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out << SignatureMagic << Version << ContentHash::fromData(base) << quint32(length);
+
+    const quint32 count = quint32((size + length - 1) / length);
+    out << count;
+    WeakChecksum weak;
+    for (quint32 i = 0; i < count; ++i) {
+        const int offset = int(i) * length;
+        const int blockLength = qMin(length, size - offset);
+        weak.reset(data + offset, blockLength);
+        out << weak.value() << strongChecksum(data + offset, blockLength);
+    }
+
+    return bytes;
+}
+
+/*!
+ Returns the delta turning the version described by \a signature into
+ \a target
+
+ Returns a null QByteArray if \a signature is not valid.
+ */
+QByteArray DeltaSync::delta(const QByteArray &signature, const QByteArray &target)
+{
+    QDataStream in(signature);
+    quint32 magic = 0;
+    quint8 version = 0;
+    ContentHash baseHash;
+    quint32 length = 0;
+    quint32 count = 0;
+    in >> magic >> version >> baseHash >> length >> count;
+    if (magic != SignatureMagic || version != Version || length == 0 || length > quint32(MaximumBlockSize)
+            || baseHash.isNull()
+            || qint64(count) != (baseHash.size() + length - 1) / length)
+        return QByteArray();
+    // The claimed size comes from the peer, the blocks must actually be there
+    if (qint64(count) * SignatureBlockSize > signature.size() - in.device()->pos())
+        return QByteArray();
+
+    QVector<Block> blocks(int(count));
+    QMultiHash<quint32, int> index;
+    index.reserve(int(count));
+    for (quint32 i = 0; i < count; ++i) {
+        in >> blocks[int(i)].weak >> blocks[int(i)].strong;
+        index.insert(blocks.at(int(i)).weak, int(i));
+    }
+    if (in.status() != QDataStream::Ok)
+        return QByteArray();
+
+    // The last block may be shorter, it can only match the end of the target
+    const int blockLength = int(length);
+    const int tailLength = count ? int(baseHash.size() - qint64(count - 1) * blockLength) : 0;
+
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out << DeltaMagic << Version << baseHash << ContentHash::fromData(target) << length;
+
+    const uchar *data = reinterpret_cast<const uchar *>(target.constData());
+    const int size = target.size();
+    int literalStart = 0;
+    int copyFirst = -1;
+    int copyCount = 0;
+
+    auto flushCopy = [&]() {
+        if (copyCount) {
+            out << quint8(Copy) << quint32(copyFirst) << quint32(copyCount);
+            copyCount = 0;
+        }
+    };
+    auto flushLiteral = [&](int end) {
+        if (end > literalStart) {
+            flushCopy();
+            out << quint8(Literal)
+                << QByteArray::fromRawData(target.constData() + literalStart, end - literalStart);
+        }
+    };
+    auto addCopy = [&](int block) {
+        if (copyCount && copyFirst + copyCount == block) {
+            ++copyCount;
+        } else {
+            flushCopy();
+            copyFirst = block;
+            copyCount = 1;
+        }
+    };
+
+    int i = 0;
+    WeakChecksum weak;
+    if (size >= blockLength)
+        weak.reset(data, blockLength);
+    while (i + blockLength <= size) {
+        int match = -1;
+        const quint32 value = weak.value();
+        auto it = index.constFind(value);
+        if (it != index.constEnd()) {
+            const quint64 strong = strongChecksum(data + i, blockLength);
+            for (; it != index.constEnd() && it.key() == value; ++it) {
+                const int candidate = it.value();
+                const bool full = candidate != int(count) - 1 || tailLength == blockLength;
+                if (full && blocks.at(candidate).strong == strong) {
+                    match = candidate;
+                    break;
+                }
+            }
+        }
+
+        if (match >= 0) {
+            flushLiteral(i);
+            addCopy(match);
+            i += blockLength;
+            literalStart = i;
+            if (i + blockLength <= size)
+                weak.reset(data + i, blockLength);
+        } else {
+            if (i + blockLength < size)
+                weak.roll(data[i], data[i + blockLength]);
+            ++i;
+        }
+    }
+
+    if (tailLength > 0 && tailLength < blockLength && size >= tailLength) {
+        const int tail = size - tailLength;
+        if (tail >= literalStart
+                && blocks.at(int(count) - 1).strong == strongChecksum(data + tail, tailLength)) {
+            flushLiteral(tail);
+            addCopy(int(count) - 1);
+            literalStart = size;
+        }
+    }
+
+    flushLiteral(size);
+    flushCopy();
+    out << quint8(End);
+    return bytes;
+}
+
+/*!
+ Applies \a delta to \a base and returns the new version
+
+ Returns a null QByteArray if \a delta was not computed for \a base, the
+ result does not match the version it was computed from or it would be
+ larger than \a maximumSize bytes.
+ */
+QByteArray DeltaSync::patch(const QByteArray &base, const QByteArray &delta, qint64 maximumSize)
+{
+    QDataStream in(delta);
+    quint32 magic = 0;
+    quint8 version = 0;
+    ContentHash baseHash;
+    ContentHash targetHash;
+    quint32 length = 0;
+    in >> magic >> version >> baseHash >> targetHash >> length;
+    if (magic != DeltaMagic || version != Version || targetHash.isNull() || length == 0)
+        return QByteArray();
+    // The target size comes from the peer
+    if (targetHash.size() > maximumSize)
+        return QByteArray();
+    if (ContentHash::fromData(base) != baseHash)
+        return QByteArray();
+
+    QByteArray result;
+    result.reserve(int(targetHash.size()));
+    forever {
+        quint8 op = End;
+        in >> op;
+        if (in.status() != QDataStream::Ok)
+            return QByteArray();
+        if (op == End)
+            break;
+
+        if (op == Copy) {
+            quint32 first = 0;
+            quint32 count = 0;
+            in >> first >> count;
+            const qint64 offset = qint64(first) * length;
+            if (count == 0 || offset + qint64(count - 1) * length >= base.size())
+                return QByteArray();
+            result.append(base.mid(int(offset), int(qint64(count) * length)));
+        } else if (op == Literal) {
+            QByteArray literal;
+            in >> literal;
+            result.append(literal);
+        } else {
+            return QByteArray();
+        }
+        if (result.size() > targetHash.size())
+            return QByteArray();
+    }
+
+    if (ContentHash::fromData(result) != targetHash)
+        return QByteArray();
+
+    if (result.isNull())
+        result = QByteArray("");
+    return result;
+}
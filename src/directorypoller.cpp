@@ -0,0 +1,281 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "directorypoller.h"
+
+/*!
+ \class DirectoryPoller
+ \internal
+ \brief Detects changes in directories by periodically comparing snapshots
+
+ The poller covers directories which can not be watched natively, e.g. because
+ the system limit of watches was reached. It reports changes with the same
+ signals as the native backends.
+
+ Directories are polled round-robin. Every interval() only as many of them are
+ polled as fit into budget() percent of that interval, measured by wall clock
+ time spent taking and comparing DirectorySnapshot tables. A large tree thus
+ takes longer to sweep instead of taking more CPU. averageCost() and
+ cycleTime() report the cost of polling so far.
+ */
+
+/*!
+ Standard constructor using \a parent as parent
+ */
+DirectoryPoller::DirectoryPoller(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_budget(5)
+    , m_next(0)
+    , m_polls(0)
+    , m_pollTime(0)
+    , m_cycleTime(-1)
+{
+    m_timer->setInterval(100);
+    connect(m_timer, &QTimer::timeout, this, &DirectoryPoller::poll);
+}
+
+/*!
+ Starts polling \a path
+
+ The first snapshot is taken with the next poll of \a path, changes happening
+ before are not reported. Use \a snapshotNow to take it immediately instead,
+ e.g. when taking over a directory which was watched natively so far.
+ */
+void DirectoryPoller::addPath(const QString &path, bool snapshotNow)
+{
+    if (m_snapshots.contains(path))
+        return;
+
+    m_paths.append(path);
+    m_snapshots.insert(path, snapshotNow ? DirectorySnapshot::take(path) : DirectorySnapshot());
+    updateTimer();
+}
+
+/*!
+ Stops polling \a path, directories below it stay polled
+ */
+void DirectoryPoller::removePath(const QString &path)
+{
+    if (!m_snapshots.remove(path))
+        return;
+
+    const int index = m_paths.indexOf(path);
+    m_paths.removeAt(index);
+    if (index < m_next)
+        --m_next;
+    updateTimer();
+}
+
+/*!
+ Stops polling \a path and all directories below it
+ */
+void DirectoryPoller::removeTree(const QString &path)
+{
+    const QString prefix = path + QLatin1Char('/');
+    for (int i = m_paths.count() - 1; i >= 0; --i) {
+        const QString &entry = m_paths.at(i);
+        if (entry != path && !entry.startsWith(prefix))
+            continue;
+        m_snapshots.remove(entry);
+        m_paths.removeAt(i);
+        if (i < m_next)
+            --m_next;
+    }
+    updateTimer();
+}
+
+/*!
+ Stops polling all directories
+ */
+void DirectoryPoller::removeAllPaths()
+{
+    m_paths.clear();
+    m_snapshots.clear();
+    m_next = 0;
+    m_cycleTimer.invalidate();
+    updateTimer();
+}
+
+/*!
+ Returns the time between two polls in milliseconds
+ */
+int DirectoryPoller::interval() const
+{
+    return m_timer->interval();
+}
+
+/*!
+ Sets the time between two polls to \a msecs
+ */
+void DirectoryPoller::setInterval(int msecs)
+{
+    m_timer->setInterval(qMax(1, msecs));
+}
+
+/*!
+ \fn DirectoryPoller::budget() const
+
+ Returns the share of each interval() in percent which may be spent polling
+ */
+
+/*!
+ Sets the polling budget to \a percent of each interval()
+
+ At least one directory is polled per interval, even when that exceeds the
+ budget.
+ */
+void DirectoryPoller::setBudget(int percent)
+{
+    m_budget = qBound(1, percent, 100);
+}
+
+/*!
+ Returns the average time in nanoseconds it took to poll a single directory
+ */
+qint64 DirectoryPoller::averageCost() const
+{
+    return m_polls ? m_pollTime / m_polls : 0;
+}
+
+/*!
+ \fn DirectoryPoller::cycleTime() const
+
+ Returns the time in milliseconds the last complete round over all
+ directories took, or -1 if no round completed yet. This is the worst case
+ latency of detecting a change.
+ */
+
+/*!
+ Polls all directories at once, ignoring the budget
+ */
+void DirectoryPoller::sweep()
+{
+    // Copy, as changes may be acted upon while iterating
+    const QStringList paths = m_paths;
+    foreach (const QString &path, paths)
+        pollDirectory(path);
+}
+
+void DirectoryPoller::poll()
+{
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 budget = qint64(m_timer->interval()) * m_budget * 10000;
+
+    int polled = 0;
+    while (polled < m_paths.count() && (polled == 0 || timer.nsecsElapsed() < budget)) {
+        if (m_next >= m_paths.count()) {
+            m_next = 0;
+            if (m_cycleTimer.isValid())
+                m_cycleTime = m_cycleTimer.elapsed();
+            m_cycleTimer.start();
+        }
+        if (!m_cycleTimer.isValid())
+            m_cycleTimer.start();
+        pollDirectory(m_paths.at(m_next++));
+        ++polled;
+    }
+}
+
+void DirectoryPoller::pollDirectory(const QString &path)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    auto it = m_snapshots.find(path);
+    if (it == m_snapshots.end())
+        return;
+
+    const DirectorySnapshot snapshot = DirectorySnapshot::take(path);
+    const DirectorySnapshot previous = *it;
+    *it = snapshot;
+
+    DirectorySnapshot::Changes changes;
+    if (!previous.isNull())
+        changes = previous.diff(snapshot);
+
+    m_pollTime += timer.nsecsElapsed();
+    ++m_polls;
+
+    if (previous.isNull() && !snapshot.exists()) {
+        // Vanished before being polled the first time, nobody to tell
+        removePath(path);
+        return;
+    }
+
+    if (previous.exists() && !snapshot.exists()) {
+        emit directoryRemoved(path);
+        return;
+    }
+
+    foreach (const QString &file, changes.changedFiles)
+        emit fileChanged(file);
+    foreach (const QString &file, changes.removedFiles)
+        emit fileRemoved(file);
+    foreach (const QString &dir, changes.createdDirectories)
+        emit directoryCreated(dir);
+    foreach (const QString &dir, changes.removedDirectories)
+        emit directoryRemoved(dir);
+}
+
+void DirectoryPoller::updateTimer()
+{
+    if (m_paths.isEmpty())
+        m_timer->stop();
+    else if (!m_timer->isActive())
+        m_timer->start();
+}
+
+/*!
+ \fn DirectoryPoller::fileChanged(const QString &path)
+
+ Reports that the file \a path was created or modified
+ */
+
+/*!
+ \fn DirectoryPoller::fileRemoved(const QString &path)
+
+ Reports that the file \a path was removed
+ */
+
+/*!
+ \fn DirectoryPoller::directoryCreated(const QString &path)
+
+ Reports that the directory \a path was created inside a polled directory
+ */
+
+/*!
+ \fn DirectoryPoller::directoryRemoved(const QString &path)
+
+ Reports that the directory \a path was removed
+ */
@@ -0,0 +1,85 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore>
+
+#include "directorysnapshot.h"
+
+class DirectoryPoller : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DirectoryPoller(QObject *parent = 0);
+
+    void addPath(const QString &path, bool snapshotNow = false);
+    void removePath(const QString &path);
+    void removeTree(const QString &path);
+    void removeAllPaths();
+    bool contains(const QString &path) const { return m_snapshots.contains(path); }
+    int count() const { return m_paths.count(); }
+
+    int interval() const;
+    void setInterval(int msecs);
+    int budget() const { return m_budget; }
+    void setBudget(int percent);
+
+    qint64 averageCost() const;
+    qint64 cycleTime() const { return m_cycleTime; }
+
+public Q_SLOTS:
+    void sweep();
+
+Q_SIGNALS:
+    void fileChanged(const QString &path);
+    void fileRemoved(const QString &path);
+    void directoryCreated(const QString &path);
+    void directoryRemoved(const QString &path);
+
+private Q_SLOTS:
+    void poll();
+
+private:
+    void pollDirectory(const QString &path);
+    void updateTimer();
+
+    QTimer *m_timer;
+    int m_budget;
+    QStringList m_paths;
+    int m_next;
+    QHash<QString, DirectorySnapshot> m_snapshots;
+    qint64 m_polls;
+    qint64 m_pollTime;
+    QElapsedTimer m_cycleTimer;
+    qint64 m_cycleTime;
+};
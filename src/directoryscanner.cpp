@@ -0,0 +1,115 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "directoryscanner.h"
+
+namespace {
+const int BATCH_SIZE = 256;
+const int BATCH_INTERVAL = 50; // ms
+}
+
+/*!
+ \class DirectoryScanner
+ \internal
+ \brief Enumerates a directory tree on a worker thread
+
+ The tree below path() is walked breadth first, so shallow directories are
+ reported before deeper ones. Results are streamed in batches through
+ directoriesFound(), the first batch starting with path() itself.
+
+ Directories matched by the IgnoreMatcher passed on construction are neither
+ reported nor descended into.
+
+ Use QThread::requestInterruption() to cancel a running scan. No more batches
+ are reported after that.
+ */
+
+/*!
+ Constructs a scanner for the tree below \a path with \a parent
+ */
+DirectoryScanner::DirectoryScanner(const QString &path, QObject *parent)
+    : QThread(parent)
+    , m_path(path)
+{
+}
+
+/*!
+ Constructs a scanner for the tree below \a path skipping directories matched
+ by \a ignore, with \a parent
+ */
+DirectoryScanner::DirectoryScanner(const QString &path, const IgnoreMatcher &ignore, QObject *parent)
+    : QThread(parent)
+    , m_path(path)
+    , m_ignore(ignore)
+{
+}
+
+void DirectoryScanner::run()
+{
+    QStringList batch;
+    batch.append(m_path);
+
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+
+    QQueue<QString> pending;
+    pending.enqueue(m_path);
+    while (!pending.isEmpty() && !isInterruptionRequested()) {
+        QDirIterator iter(pending.dequeue(), QDir::Dirs | QDir::NoDotAndDotDot);
+        while (iter.hasNext()) {
+            const QString path = iter.next();
+            if (m_ignore.matches(path.mid(m_path.length() + 1), true))
+                continue;
+            batch.append(path);
+            // Do not follow links, they may form cycles
+            if (!iter.fileInfo().isSymLink())
+                pending.enqueue(path);
+        }
+
+        if (batch.count() >= BATCH_SIZE || batchTimer.elapsed() >= BATCH_INTERVAL) {
+            if (isInterruptionRequested())
+                return;
+            emit directoriesFound(batch);
+            batch.clear();
+            batchTimer.restart();
+        }
+    }
+
+    if (!batch.isEmpty() && !isInterruptionRequested())
+        emit directoriesFound(batch);
+}
+
+/*!
+ \fn DirectoryScanner::directoriesFound(const QStringList &paths)
+
+ Reports the next batch of \a paths found, in breadth first order
+ */
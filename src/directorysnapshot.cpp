@@ -0,0 +1,225 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "directorysnapshot.h"
+
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*!
+ \class DirectorySnapshot
+ \internal
+ \brief The stat table of the entries of one directory
+
+ A snapshot records modification time, size and, where available, inode of
+ every entry directly inside path(). Comparing two snapshots of the same
+ directory with diff() tells which files changed and which sub directories
+ appeared or vanished, without looking at file contents.
+ */
+
+/*!
+ \class DirectorySnapshot::Changes
+ \internal
+ \brief The result of comparing two snapshots, all as absolute paths
+ */
+
+/*!
+ Reads the entries of the directory \a path
+
+ On Unix the directory is read with a single readdir() pass and one fstatat()
+ per entry, avoiding the overhead of QFileInfo. The returned snapshot does
+ not exist() if \a path could not be opened.
+ */
+DirectorySnapshot DirectorySnapshot::take(const QString &path)
+{
+    DirectorySnapshot snapshot;
+    snapshot.m_path = path;
+
+#ifdef Q_OS_UNIX
+    DIR *dir = ::opendir(QFile::encodeName(path).constData());
+    if (!dir)
+        return snapshot;
+
+    snapshot.m_exists = true;
+    const int fd = ::dirfd(dir);
+    while (struct dirent *dirent = ::readdir(dir)) {
+        const char *name = dirent->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+            continue;
+
+        struct stat status;
+        // Dangling links and entries removed meanwhile are skipped
+        if (::fstatat(fd, name, &status, 0) != 0)
+            continue;
+
+        Entry entry;
+#ifdef Q_OS_DARWIN
+        entry.mtime = qint64(status.st_mtimespec.tv_sec) * 1000000000 + status.st_mtimespec.tv_nsec;
+#else
+        entry.mtime = qint64(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#endif
+        entry.size = status.st_size;
+        entry.inode = status.st_ino;
+        entry.isDir = S_ISDIR(status.st_mode);
+#ifdef DT_LNK
+        // Saves an lstat() where the file system reports the entry type
+        if (dirent->d_type != DT_UNKNOWN) {
+            entry.isLink = dirent->d_type == DT_LNK;
+        } else
+#endif
+        {
+            struct stat linkStatus;
+            entry.isLink = ::fstatat(fd, name, &linkStatus, AT_SYMLINK_NOFOLLOW) == 0
+                    && S_ISLNK(linkStatus.st_mode);
+        }
+        snapshot.m_entries.insert(QFile::decodeName(name), entry);
+    }
+    ::closedir(dir);
+#else
+    if (!QFileInfo(path).isDir())
+        return snapshot;
+
+    snapshot.m_exists = true;
+    QDirIterator iter(path, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+    while (iter.hasNext()) {
+        iter.next();
+        const QFileInfo info = iter.fileInfo();
+        Entry entry;
+        entry.mtime = info.lastModified().toMSecsSinceEpoch() * 1000000;
+        entry.size = info.size();
+        entry.isDir = info.isDir();
+        entry.isLink = info.isSymLink();
+        snapshot.m_entries.insert(info.fileName(), entry);
+    }
+#endif
+
+    return snapshot;
+}
+
+/*!
+ Compares this snapshot with a \a newer one of the same directory
+
+ Files are reported as changed when they were created or their modification
+ time, size or inode differ. Sub directories are only reported when they were
+ created or removed, their contents are covered by their own snapshot.
+ */
+DirectorySnapshot::Changes DirectorySnapshot::diff(const DirectorySnapshot &newer) const
+{
+    Changes changes;
+    const QString prefix = m_path + QLatin1Char('/');
+
+    for (auto it = newer.m_entries.constBegin(); it != newer.m_entries.constEnd(); ++it) {
+        const auto old = m_entries.constFind(it.key());
+        const bool existed = old != m_entries.constEnd();
+        if (it->isDir) {
+            if (!existed || !old->isDir)
+                changes.createdDirectories.append(prefix + it.key());
+            if (existed && !old->isDir)
+                changes.removedFiles.append(prefix + it.key());
+        } else if (!existed || *old != *it) {
+            if (existed && old->isDir)
+                changes.removedDirectories.append(prefix + it.key());
+            changes.changedFiles.append(prefix + it.key());
+        }
+    }
+
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        if (newer.m_entries.contains(it.key()))
+            continue;
+        if (it->isDir)
+            changes.removedDirectories.append(prefix + it.key());
+        else
+            changes.removedFiles.append(prefix + it.key());
+    }
+
+    return changes;
+}
+
+/*!
+ \fn DirectorySnapshot::isNull() const
+
+ Returns true for a default constructed snapshot which was never taken
+ */
+
+/*!
+ \fn DirectorySnapshot::exists() const
+
+ Returns true if the directory could be read when the snapshot was taken
+ */
+
+/*!
+ \fn DirectorySnapshot::contains(const QString &name) const
+
+ Returns true if the directory contained an entry \a name
+ */
+
+/*!
+ \fn DirectorySnapshot::entry(const QString &name) const
+
+ Returns the recorded stat data of the entry \a name
+ */
+
+/*!
+ Returns the names of all entries which are not directories
+ */
+QStringList DirectorySnapshot::fileNames() const
+{
+    QStringList names;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        if (!it->isDir)
+            names.append(it.key());
+    }
+    return names;
+}
+
+/*!
+ Returns the names of all sub directories, including links to directories
+ */
+QStringList DirectorySnapshot::directoryNames() const
+{
+    QStringList names;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        if (it->isDir)
+            names.append(it.key());
+    }
+    return names;
+}
+
+/*!
+ \fn DirectorySnapshot::removeEntry(const QString &name)
+
+ Forgets the entry \a name, e.g. when its removal is known already
+ */
@@ -0,0 +1,89 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore>
+
+class DirectorySnapshot
+{
+public:
+    struct Entry {
+        qint64 mtime = 0;
+        qint64 size = 0;
+        quint64 inode = 0;
+        bool isDir = false;
+        bool isLink = false;
+
+        bool operator==(const Entry &other) const
+        {
+            return mtime == other.mtime && size == other.size
+                    && inode == other.inode && isDir == other.isDir
+                    && isLink == other.isLink;
+        }
+        bool operator!=(const Entry &other) const { return !operator==(other); }
+    };
+
+    struct Changes {
+        QStringList changedFiles;
+        QStringList removedFiles;
+        QStringList createdDirectories;
+        QStringList removedDirectories;
+
+        bool isEmpty() const
+        {
+            return changedFiles.isEmpty() && removedFiles.isEmpty()
+                    && createdDirectories.isEmpty() && removedDirectories.isEmpty();
+        }
+    };
+
+    DirectorySnapshot() {}
+
+    static DirectorySnapshot take(const QString &path);
+
+    bool isNull() const { return m_path.isNull(); }
+    bool exists() const { return m_exists; }
+    QString path() const { return m_path; }
+    int count() const { return m_entries.count(); }
+    bool contains(const QString &name) const { return m_entries.contains(name); }
+    Entry entry(const QString &name) const { return m_entries.value(name); }
+    QStringList fileNames() const;
+    QStringList directoryNames() const;
+    void removeEntry(const QString &name) { m_entries.remove(name); }
+
+    Changes diff(const DirectorySnapshot &newer) const;
+
+private:
+    QString m_path;
+    bool m_exists = false;
+    QHash<QString, Entry> m_entries;
+};
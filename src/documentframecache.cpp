@@ -0,0 +1,229 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "documentframecache.h"
+
+#ifdef QMLLIVE_DEBUG
+#define DEBUG qDebug()
+#else
+#define DEBUG if (0) qDebug()
+#endif
+
+namespace {
+
+struct CachedFrame;
+typedef QHash<const char *, CachedFrame *> FrameIndex;
+
+struct CachedFrame
+{
+    CachedFrame(FrameIndex *index, const QString &key, qint64 mtime, qint64 size,
+                const DocumentFrameCache::Frame &frame)
+        : index(index), key(key), mtime(mtime), size(size), frame(frame)
+    {
+        index->insert(frame.data.constData(), this);
+    }
+    ~CachedFrame() { index->remove(frame.data.constData()); }
+
+    FrameIndex *index;
+    QString key;
+    qint64 mtime;
+    qint64 size;
+    DocumentFrameCache::Frame frame;
+    int compressionLevel = 0;
+    QByteArray compressed;
+};
+
+// Costs are counted in KiB to stay within the int range of QCache. The index
+// finds the frame some content was read from, it is declared first so it
+// outlives the frames.
+struct FrameCache
+{
+    QMutex mutex;
+    FrameIndex index;
+    QCache<QString, CachedFrame> frames{32 * 1024};
+};
+
+Q_GLOBAL_STATIC(FrameCache, s_cache)
+
+int cost(const QByteArray &data)
+{
+    return int(data.size() / 1024) + 1;
+}
+
+} // namespace
+
+/*!
+ \class DocumentFrameCache
+ \internal
+ \brief Shares the encoded sendDocument content between publishers
+
+ Every RemotePublisher connected to a host sends the same document content
+ when a file changes. The content is read and encoded only once, the first
+ publisher to send it puts it into the cache and all others get the same
+ implicitly shared QByteArray. The compressed content is kept with the frame
+ as well, see compress().
+
+ Entries are dropped with invalidate() when the file is reported changed.
+ They are also validated against the modification time and size of the
+ file, the least recently used ones are dropped once maximumSize() is
+ exceeded.
+ */
+
+/*!
+ Returns the content of the frame without copying it
+
+ The returned QByteArray refers to data, it must not outlive the frame.
+ */
+QByteArray DocumentFrameCache::Frame::content() const
+{
+    return QByteArray::fromRawData(data.constData() + contentOffset, data.size() - contentOffset);
+}
+
+/*!
+ Returns the sendDocument content for the file at \a path, sent as the
+ workspace \a document
+
+ Returns a null frame if the file can not be read.
+ */
+DocumentFrameCache::Frame DocumentFrameCache::frame(const QString &path, const QString &document)
+{
+    const QFileInfo info(path);
+    const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+    const qint64 size = info.size();
+    const QString key = path + QLatin1Char('\n') + document;
+
+    {
+        QMutexLocker locker(&s_cache->mutex);
+        CachedFrame *cached = s_cache->frames.object(key);
+        if (cached && cached->mtime == mtime && cached->size == size)
+            return cached->frame;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "ERROR: can't open file: " << path;
+        return Frame();
+    }
+
+    Frame frame;
+    QDataStream out(&frame.data, QIODevice::WriteOnly);
+    out << document;
+    // QByteArray is streamed as its 32 bit length followed by the bytes
+    frame.contentOffset = frame.data.size() + int(sizeof(quint32));
+    out << file.readAll();
+
+    DEBUG << "DocumentFrameCache: encoded" << document << frame.data.size() << "bytes";
+
+    QMutexLocker locker(&s_cache->mutex);
+    s_cache->frames.insert(key, new CachedFrame(&s_cache->index, key, mtime, size, frame), cost(frame.data));
+    return frame;
+}
+
+/*!
+ Returns \a data compressed with zlib at \a level
+
+ When \a data is the data of a cached frame, the result is kept with the
+ frame, so the content sent to many hosts is compressed only once. It is
+ dropped together with the frame. If compression does not make the content
+ smaller, \a data itself is returned.
+ */
+QByteArray DocumentFrameCache::compress(const QByteArray &data, int level)
+{
+    {
+        QMutexLocker locker(&s_cache->mutex);
+        const CachedFrame *cached = s_cache->index.value(data.constData());
+        if (cached && cached->frame.data.size() == data.size() && cached->compressionLevel == level
+                && !cached->compressed.isNull())
+            return cached->compressed;
+    }
+
+    QByteArray result = qCompress(data, level);
+    if (result.size() >= data.size())
+        result = data;
+
+    QMutexLocker locker(&s_cache->mutex);
+    CachedFrame *cached = s_cache->index.value(data.constData());
+    if (!cached || cached->frame.data.size() != data.size())
+        return result;
+
+    // Re-inserted to account for the compressed copy
+    const QString key = cached->key;
+    s_cache->frames.take(key);
+    cached->compressionLevel = level;
+    cached->compressed = result;
+    const int compressedCost = result.constData() == data.constData() ? 0 : cost(result);
+    s_cache->frames.insert(key, cached, cost(data) + compressedCost);
+    return result;
+}
+
+/*!
+ Returns the maximum size of all cached frames in bytes, 32 MiB by default
+ */
+qint64 DocumentFrameCache::maximumSize()
+{
+    QMutexLocker locker(&s_cache->mutex);
+    return qint64(s_cache->frames.maxCost()) * 1024;
+}
+
+/*!
+ Sets the maximum size of all cached frames to \a bytes
+ */
+void DocumentFrameCache::setMaximumSize(qint64 bytes)
+{
+    QMutexLocker locker(&s_cache->mutex);
+    s_cache->frames.setMaxCost(int(qMin<qint64>(bytes / 1024, INT_MAX)));
+}
+
+/*!
+ Drops the cached frames of the file at \a path
+
+ The modification time and size alone do not tell every change, e.g. on
+ file systems storing the time in seconds or with tools keeping it.
+ */
+void DocumentFrameCache::invalidate(const QString &path)
+{
+    const QString prefix = path + QLatin1Char('\n');
+    QMutexLocker locker(&s_cache->mutex);
+    foreach (const QString &key, s_cache->frames.keys()) {
+        if (key.startsWith(prefix))
+            s_cache->frames.remove(key);
+    }
+}
+
+/*!
+ Drops all cached frames
+ */
+void DocumentFrameCache::clear()
+{
+    QMutexLocker locker(&s_cache->mutex);
+    s_cache->frames.clear();
+}
@@ -0,0 +1,263 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "ignorematcher.h"
+
+/*!
+ \class IgnoreMatcher
+ \internal
+ \brief Decides which workspace entries are neither watched nor published
+
+ The rules follow the \c .gitignore syntax:
+
+ \list
+ \li Empty lines and lines starting with \c # are skipped.
+ \li A pattern without a slash matches the name of an entry at any depth,
+     e.g. \c *.swp or \c .git.
+ \li A pattern containing a slash is matched against the whole path relative
+     to the workspace, e.g. \c /build or \c assets/cache. A leading \c **\/
+     matches at any depth.
+ \li A trailing slash matches directories only, e.g. \c build/.
+ \li \c * and \c ? match within one path section, \c ** across sections and
+     \c [...] a character class.
+ \li A leading \c ! includes an entry again that was excluded by an earlier
+     rule. The last matching rule wins.
+ \endlist
+
+ Rules are compiled once on construction. Literal names, suffixes like
+ \c *.swp and prefixes like \c .#* are compared as plain strings, only the
+ remaining patterns use regular expressions.
+ */
+
+/*!
+ Compiles the \a rules into a matcher
+ */
+IgnoreMatcher::IgnoreMatcher(const QStringList &rules)
+{
+    foreach (const QString &source, rules) {
+        Rule rule;
+        if (compile(source, &rule)) {
+            m_sources.append(source.trimmed());
+            m_rules.append(rule);
+        }
+    }
+}
+
+/*!
+ Returns the rules used when a project does not configure any: version
+ control directories, editor swap and backup files and QML caches
+ */
+QStringList IgnoreMatcher::defaultRules()
+{
+    return QStringList()
+            << QStringLiteral(".git/")
+            << QStringLiteral(".svn/")
+            << QStringLiteral(".hg/")
+            << QStringLiteral("*.swp")
+            << QStringLiteral("*.swo")
+            << QStringLiteral("*~")
+            << QStringLiteral(".#*")
+            << QStringLiteral("*.qmlc")
+            << QStringLiteral("*.jsc")
+            << QStringLiteral(".DS_Store");
+}
+
+/*!
+ \fn IgnoreMatcher::rules() const
+
+ Returns the rules this matcher was compiled from, without blank lines and
+ comments
+ */
+
+/*!
+ \fn IgnoreMatcher::isEmpty() const
+
+ Returns true if no rule is set, nothing is ignored then
+ */
+
+/*!
+ Returns true if the rules exclude the entry \a relativePath itself
+
+ \a isDir tells whether the entry is a directory. Parent directories are not
+ considered, use this when walking a tree and not descending into ignored
+ directories anyway.
+ */
+bool IgnoreMatcher::matches(const QString &relativePath, bool isDir) const
+{
+    if (m_rules.isEmpty() || relativePath.isEmpty())
+        return false;
+
+    const QString name = relativePath.mid(relativePath.lastIndexOf(QLatin1Char('/')) + 1);
+    for (int i = m_rules.count() - 1; i >= 0; --i) {
+        const Rule &rule = m_rules.at(i);
+        if (rule.directoryOnly && !isDir)
+            continue;
+
+        bool match = false;
+        switch (rule.kind) {
+        case Name:
+            match = name == rule.pattern;
+            break;
+        case Suffix:
+            match = name.endsWith(rule.pattern);
+            break;
+        case Prefix:
+            match = name.startsWith(rule.pattern);
+            break;
+        case Path:
+            match = relativePath == rule.pattern;
+            break;
+        case Wildcard:
+            match = rule.expression.match(rule.anchored ? relativePath : name).hasMatch();
+            break;
+        }
+
+        if (match)
+            return !rule.negated;
+    }
+    return false;
+}
+
+/*!
+ Returns true if the entry \a relativePath or any of its parent directories
+ is excluded by the rules
+
+ \a isDir tells whether the entry itself is a directory.
+ */
+bool IgnoreMatcher::isIgnored(const QString &relativePath, bool isDir) const
+{
+    if (m_rules.isEmpty())
+        return false;
+
+    int end = relativePath.indexOf(QLatin1Char('/'));
+    while (end != -1) {
+        if (matches(relativePath.left(end), true))
+            return true;
+        end = relativePath.indexOf(QLatin1Char('/'), end + 1);
+    }
+    return matches(relativePath, isDir);
+}
+
+bool IgnoreMatcher::compile(const QString &source, Rule *rule)
+{
+    QString pattern = source.trimmed();
+    if (pattern.isEmpty() || pattern.startsWith(QLatin1Char('#')))
+        return false;
+
+    if (pattern.startsWith(QLatin1Char('!'))) {
+        rule->negated = true;
+        pattern.remove(0, 1);
+    }
+    if (pattern.endsWith(QLatin1Char('/'))) {
+        rule->directoryOnly = true;
+        pattern.chop(1);
+    }
+    if (pattern.startsWith(QLatin1String("**/")))
+        pattern.remove(0, 3);
+    else if (pattern.contains(QLatin1Char('/')))
+        rule->anchored = true;
+    if (pattern.startsWith(QLatin1Char('/')))
+        pattern.remove(0, 1);
+    // "**/a/b" still needs to match whole paths, at any depth
+    if (!rule->anchored && pattern.contains(QLatin1Char('/'))) {
+        rule->anchored = true;
+        pattern.prepend(QLatin1String("**/"));
+    }
+
+    if (pattern.isEmpty())
+        return false;
+
+    auto hasWildcard = [](const QString &text) {
+        return text.contains(QLatin1Char('*')) || text.contains(QLatin1Char('?'))
+                || text.contains(QLatin1Char('['));
+    };
+
+    if (!hasWildcard(pattern)) {
+        rule->kind = rule->anchored ? Path : Name;
+        rule->pattern = pattern;
+    } else if (!rule->anchored && pattern.startsWith(QLatin1Char('*')) && !hasWildcard(pattern.mid(1))) {
+        rule->kind = Suffix;
+        rule->pattern = pattern.mid(1);
+    } else if (!rule->anchored && pattern.endsWith(QLatin1Char('*')) && !hasWildcard(pattern.left(pattern.length() - 1))) {
+        rule->kind = Prefix;
+        rule->pattern = pattern.left(pattern.length() - 1);
+    } else {
+        rule->kind = Wildcard;
+        rule->pattern = pattern;
+        rule->expression.setPattern(wildcardToExpression(pattern));
+        rule->expression.optimize();
+        if (!rule->expression.isValid()) {
+            qWarning() << "Invalid ignore rule" << source;
+            return false;
+        }
+    }
+    return true;
+}
+
+QString IgnoreMatcher::wildcardToExpression(const QString &pattern)
+{
+    QString expression(QLatin1Char('^'));
+    for (int i = 0; i < pattern.length(); ++i) {
+        const QChar c = pattern.at(i);
+        if (c == QLatin1Char('*')) {
+            if (i + 1 < pattern.length() && pattern.at(i + 1) == QLatin1Char('*')) {
+                ++i;
+                if (i + 1 < pattern.length() && pattern.at(i + 1) == QLatin1Char('/')) {
+                    // "**/" matches zero or more leading directories
+                    ++i;
+                    expression += QLatin1String("(?:.*/)?");
+                } else {
+                    expression += QLatin1String(".*");
+                }
+            } else {
+                expression += QLatin1String("[^/]*");
+            }
+        } else if (c == QLatin1Char('?')) {
+            expression += QLatin1String("[^/]");
+        } else if (c == QLatin1Char('[')) {
+            const int close = pattern.indexOf(QLatin1Char(']'), i + 1);
+            if (close == -1) {
+                expression += QLatin1String("\\[");
+            } else {
+                QString set = pattern.mid(i + 1, close - i - 1);
+                if (set.startsWith(QLatin1Char('!')))
+                    set[0] = QLatin1Char('^');
+                expression += QLatin1Char('[') + set + QLatin1Char(']');
+                i = close;
+            }
+        } else {
+            expression += QRegularExpression::escape(QString(c));
+        }
+    }
+    expression += QLatin1Char('$');
+    return expression;
+}
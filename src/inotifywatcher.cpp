@@ -0,0 +1,242 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "inotifywatcher.h"
+
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <errno.h>
+#include <unistd.h>
+
+#ifdef QMLLIVE_DEBUG
+#define DEBUG qDebug()
+#else
+#define DEBUG if (0) qDebug()
+#endif
+
+namespace {
+const uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB
+        | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+}
+
+/*!
+ \class InotifyWatcher
+ \internal
+ \brief Linux inotify based directory watcher reporting individual files
+
+ Unlike QFileSystemWatcher, which only tells that something changed within a
+ directory, this reports the affected entry itself. Every watched directory
+ costs one inotify watch descriptor; subdirectories have to be added
+ explicitly, just like with QFileSystemWatcher.
+ */
+
+/*!
+ Creates the inotify instance. Check isValid() for success.
+ */
+InotifyWatcher::InotifyWatcher(QObject *parent)
+    : QObject(parent)
+    , m_fd(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+    , m_notifier(0)
+{
+    if (m_fd == -1) {
+        qWarning() << "inotify_init1 failed:" << qt_error_string(errno);
+        return;
+    }
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &InotifyWatcher::readEvents);
+}
+
+InotifyWatcher::~InotifyWatcher()
+{
+    if (m_fd != -1)
+        ::close(m_fd);
+}
+
+/*!
+ Starts watching the directory \a path. Returns false when the kernel refused
+ to add another watch, e.g. because fs.inotify.max_user_watches was reached.
+ */
+bool InotifyWatcher::addPath(const QString &path)
+{
+    if (!isValid())
+        return false;
+
+    if (m_wdByPath.contains(path))
+        return true;
+
+    int wd = ::inotify_add_watch(m_fd, QFile::encodeName(path).constData(), WATCH_MASK);
+    if (wd == -1) {
+        DEBUG << "inotify_add_watch failed:" << path << qt_error_string(errno);
+        return false;
+    }
+
+    // The same inode may be reachable through several paths (bind mounts, links)
+    forget(wd);
+    m_pathByWd.insert(wd, path);
+    m_wdByPath.insert(path, wd);
+    return true;
+}
+
+/*!
+ Stops watching \a path and, if \a recursive is true, all watched directories
+ below it.
+ */
+void InotifyWatcher::removePath(const QString &path, bool recursive)
+{
+    if (!recursive) {
+        const int wd = m_wdByPath.value(path, -1);
+        if (wd != -1) {
+            ::inotify_rm_watch(m_fd, wd);
+            forget(wd);
+        }
+        return;
+    }
+
+    const QString prefix = path + QLatin1Char('/');
+    QList<int> stale;
+    for (auto it = m_wdByPath.constBegin(); it != m_wdByPath.constEnd(); ++it) {
+        if (it.key() == path || it.key().startsWith(prefix))
+            stale.append(it.value());
+    }
+
+    foreach (int wd, stale) {
+        ::inotify_rm_watch(m_fd, wd);
+        forget(wd);
+    }
+}
+
+void InotifyWatcher::removeAllPaths()
+{
+    for (auto it = m_pathByWd.constBegin(); it != m_pathByWd.constEnd(); ++it)
+        ::inotify_rm_watch(m_fd, it.key());
+    m_pathByWd.clear();
+    m_wdByPath.clear();
+}
+
+void InotifyWatcher::forget(int wd)
+{
+    const QString path = m_pathByWd.take(wd);
+    if (!path.isNull())
+        m_wdByPath.remove(path);
+}
+
+void InotifyWatcher::readEvents()
+{
+    int available = 0;
+    if (::ioctl(m_fd, FIONREAD, &available) == -1 || available <= 0)
+        available = 4096;
+
+    // Stored as events, so the records read into it are suitably aligned
+    QVarLengthArray<inotify_event, 4096 / sizeof(inotify_event)>
+            buffer((available + sizeof(inotify_event) - 1) / sizeof(inotify_event));
+    const ssize_t length = ::read(m_fd, buffer.data(), buffer.size() * sizeof(inotify_event));
+    if (length <= 0)
+        return;
+
+    const char *at = reinterpret_cast<const char *>(buffer.constData());
+    const char *const end = at + length;
+    while (at < end) {
+        const inotify_event *event = reinterpret_cast<const inotify_event *>(at);
+        at += sizeof(inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            qWarning() << "inotify event queue overflowed, rescanning";
+            emit overflowed();
+            continue;
+        }
+
+        const QString dirPath = m_pathByWd.value(event->wd);
+        if (dirPath.isNull())
+            continue;
+
+        if (event->mask & IN_IGNORED) {
+            forget(event->wd);
+            continue;
+        }
+
+        // The parent directory reports these as IN_DELETE/IN_MOVED_FROM, except
+        // for the root which has no watched parent
+        if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+            emit directoryRemoved(dirPath);
+            continue;
+        }
+
+        if (event->len == 0)
+            continue;
+
+        const QString path = dirPath + QLatin1Char('/') + QFile::decodeName(event->name);
+        DEBUG << "inotify event" << QString::number(event->mask, 16) << path;
+
+        if (event->mask & IN_ISDIR) {
+            if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                emit directoryCreated(path);
+            else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+                emit directoryRemoved(path);
+        } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+            emit fileRemoved(path);
+        } else {
+            emit fileChanged(path);
+        }
+    }
+}
+
+/*!
+ \fn InotifyWatcher::fileChanged(const QString &path)
+
+ A regular file \a path was created, written to or moved into a watched directory
+ */
+
+/*!
+ \fn InotifyWatcher::fileRemoved(const QString &path)
+
+ A regular file \a path was deleted or moved out of a watched directory
+ */
+
+/*!
+ \fn InotifyWatcher::directoryCreated(const QString &path)
+
+ A subdirectory \a path appeared in a watched directory. It is not watched
+ automatically.
+ */
+
+/*!
+ \fn InotifyWatcher::directoryRemoved(const QString &path)
+
+ The directory \a path was deleted or moved away
+ */
+
+/*!
+ \fn InotifyWatcher::overflowed()
+
+ The kernel dropped events. Everything watched should be considered changed.
+ */
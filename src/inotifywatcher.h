@@ -0,0 +1,69 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore>
+
+class InotifyWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit InotifyWatcher(QObject *parent = 0);
+    ~InotifyWatcher();
+
+    bool isValid() const { return m_fd != -1; }
+
+    bool addPath(const QString &path);
+    void removePath(const QString &path, bool recursive = true);
+    void removeAllPaths();
+    bool contains(const QString &path) const { return m_wdByPath.contains(path); }
+    int count() const { return m_wdByPath.count(); }
+
+Q_SIGNALS:
+    void fileChanged(const QString &path);
+    void fileRemoved(const QString &path);
+    void directoryCreated(const QString &path);
+    void directoryRemoved(const QString &path);
+    void overflowed();
+
+private Q_SLOTS:
+    void readEvents();
+
+private:
+    void forget(int wd);
+
+    int m_fd;
+    QSocketNotifier *m_notifier;
+    QHash<int, QString> m_pathByWd;
+    QHash<QString, int> m_wdByPath;
+};
@@ -1,11 +1,19 @@
-QT += network
+QT += network concurrent
 
 SOURCES += \
     $$PWD/ipcserver.cpp \
     $$PWD/ipcconnection.cpp \
-    $$PWD/ipcclient.cpp
+    $$PWD/ipcprotocol.cpp \
+    $$PWD/ipcmethod.cpp \
+    $$PWD/ipcclient.cpp \
+    $$PWD/ipctransport.cpp \
+    $$PWD/ipcsharedmemory.cpp
 
 HEADERS += \
     $$PWD/ipcserver.h \
     $$PWD/ipcconnection.h \
-    $$PWD/ipcclient.h
+    $$PWD/ipcprotocol.h \
+    $$PWD/ipcmethod.h \
+    $$PWD/ipcclient.h \
+    $$PWD/ipctransport.h \
+    $$PWD/ipcsharedmemory.h
@@ -31,6 +31,7 @@
 ****************************************************************************/
 
 #include "ipcclient.h"
+#include "ipcsharedmemory.h"
 #include <QElapsedTimer>
 #include <QPointer>
 
@@ -45,10 +46,26 @@ public:
     QUuid m_uuid;
     QString m_method;
     QByteArray m_data;
+    std::function<QByteArray()> m_producer;
+    QString m_key;
+    IpcClient::Lane m_lane;
+    bool m_internal;
     int m_tries;
-    qint64 m_bytes;
+    quint32 m_sequence;
+    qint64 m_end;
 };
 
+namespace {
+// Packages are only handed to the socket while less than this is buffered
+const qint64 DefaultHighWaterMark = 256 * 1024;
+// Smaller content does not gain enough from compression
+const int DefaultCompressionThreshold = 1024;
+// Large enough for a few documents of several megabytes
+const int DefaultSharedMemorySize = 16 * 1024 * 1024;
+// Smaller content is cheaper to copy through the socket
+const int SharedMemoryThreshold = 64 * 1024;
+}
+
 /*!
  * \class IpcClient
  * \brief Client to send remote calls to an IpcServer.
@@ -73,6 +90,59 @@ public:
  * Don't use the waitFor*-Methods in your gui applications. They will block
  * the eventloop. Instead react on the signals when the packages are sent or
  * an error happened.
+ *
+ * Packages are written to the socket in order as long as less than
+ * highWaterMark() bytes are waiting to be written. Content which is expensive
+ * to hold in memory, e.g. file contents, can be passed as a producer
+ * function. It is only called once the package is about to be written, so
+ * the memory used stays bounded however many packages are queued.
+ *
+ * The high-water mark is the window of bytes in flight. Any number of
+ * packages may be in it, so the link does not idle between them on high
+ * latency connections. Packages get a sequence number per connection and
+ * are complete once the socket wrote the stream up to their end.
+ *
+ * Packages can be sent with a key. A package still queued is superseded by
+ * a later package with the same key, which takes its place in the queue.
+ * This way only the latest version of e.g. a document is sent, however often
+ * it changes while the connection is busy.
+ *
+ * Each package is queued in one of the lanes given by Lane. Packages of a
+ * lane are sent in order, but only while all lanes before it are empty. So a
+ * package is never sent before packages queued earlier in its own or a more
+ * urgent lane, while it may overtake packages of less urgent lanes. Large
+ * content should be sent in several packages, as a package being written is
+ * never interrupted. Control messages are written even when the high-water
+ * mark is reached, they do not wait for the window.
+ *
+ * Content of at least compressionThreshold() bytes is compressed with zlib
+ * when the peer announced it accepts it, see IpcConnection.
+ *
+ * Packages are sent in compact binary frames once the peer announced it
+ * reads them, older peers receive text frames, see IpcProtocol.
+ *
+ * Servers on the same machine are connected with a local socket instead of
+ * TCP, see IpcTransport. Content is not compressed then. Content of 64 KiB
+ * and more is passed in a ring of sharedMemorySize() bytes shared with the
+ * peer, so only a small reference goes through the socket, see
+ * IpcSharedMemory. The ring is only used once the peer confirmed it attached
+ * to it. Content sent before, content not fitting into the ring and all
+ * content after the peer failed to attach is sent inline.
+ */
+
+/*!
+ * \enum IpcClient::Lane
+ *
+ * This enum type selects how urgently a package is sent:
+ *
+ * \value ControlLane
+ *        Small messages acting on the peer right away, e.g. settings and
+ *        pings. Sent before anything else.
+ * \value InteractiveLane
+ *        Content the user waits for, e.g. the document just edited.
+ * \value BulkLane
+ *        Everything else, in the order it was sent. This is the default.
+ * \omitvalue LaneCount
  */
 
 /*!
@@ -80,33 +150,93 @@ public:
  */
 IpcClient::IpcClient(QObject *parent)
     : QObject(parent)
-    , m_socket(new QTcpSocket(this))
-    , m_current(0)
-    , m_written(0)
-    , m_connection(new IpcConnection(m_socket))
-{
-    connect(m_socket, &QAbstractSocket::connected, this, &IpcClient::connected);
-    connect(m_socket, &QAbstractSocket::connected, this, &IpcClient::processQueue);
-    connect(m_socket, &QAbstractSocket::disconnected, this, &IpcClient::disconnected);
-    auto QAbstractSocket__error = &QAbstractSocket::error;
-    connect(m_socket, &QAbstractSocket::errorOccurred, this, &IpcClient::onError);
-    connect(m_socket, &QAbstractSocket::bytesWritten, this, &IpcClient::onBytesWritten);
+    , m_transport(new IpcTransport(this))
+    , m_sentOffset(0)
+    , m_writtenOffset(0)
+    , m_highWaterMark(DefaultHighWaterMark)
+    , m_compressionLevel(-1)
+    , m_compressionThreshold(DefaultCompressionThreshold)
+    , m_compressor([](const QByteArray &data, int level) { return qCompress(data, level); })
+    , m_protocolVersion(IpcProtocol::CurrentVersion)
+    , m_sequence(0)
+    , m_sharedMemorySize(DefaultSharedMemorySize)
+    , m_sharedMemory(0)
+    , m_sharedMemoryAttached(false)
+    , m_sharedMemoryFailed(false)
+    , m_connection(new IpcConnection(m_transport, this))
+{
+    connect(m_transport, &IpcTransport::connected, this, &IpcClient::connected);
+    connect(m_transport, &IpcTransport::connected, this, &IpcClient::onConnected);
+    connect(m_transport, &IpcTransport::disconnected, this, &IpcClient::disconnected);
+    connect(m_transport, &IpcTransport::errorOccurred, this, &IpcClient::onError);
+    connect(m_transport, &IpcTransport::bytesWritten, this, &IpcClient::onBytesWritten);
+    connect(m_transport, &IpcTransport::sharedMemoryAttached, this, &IpcClient::confirmSharedMemory);
+    connect(m_transport, &IpcTransport::peerSharedMemoryAttached, this, &IpcClient::onSharedMemoryAttached);
 
     connect(m_connection, &IpcConnection::received, this, &IpcClient::received);
 }
 
+/*!
+ * \brief Constructs an IpcClient with parent \a parent writing to the
+ * connected \a socket, e.g. to answer a client of an IpcServer
+ */
 IpcClient::IpcClient(QTcpSocket *socket, QObject *parent)
+    : IpcClient(IpcTransport::forSocket(socket), parent)
+{
+}
+
+/*!
+ * \brief Constructs an IpcClient with parent \a parent writing to the
+ * connected \a transport, e.g. to answer a client of an IpcServer
+ *
+ * \sa IpcServer::clientConnected()
+ */
+IpcClient::IpcClient(IpcTransport *transport, QObject *parent)
     : QObject(parent)
-    , m_socket(socket)
-    , m_current(0)
-    , m_written(0)
+    , m_transport(transport)
+    , m_sentOffset(0)
+    , m_writtenOffset(0)
+    , m_highWaterMark(DefaultHighWaterMark)
+    , m_compressionLevel(-1)
+    , m_compressionThreshold(DefaultCompressionThreshold)
+    , m_compressor([](const QByteArray &data, int level) { return qCompress(data, level); })
+    , m_protocolVersion(IpcProtocol::CurrentVersion)
+    , m_sequence(0)
+    , m_sharedMemorySize(DefaultSharedMemorySize)
+    , m_sharedMemory(0)
+    , m_sharedMemoryAttached(false)
+    , m_sharedMemoryFailed(false)
     , m_connection(0)
 {
-    connect(m_socket, &QAbstractSocket::connected, this, &IpcClient::connected);
-    connect(m_socket, &QAbstractSocket::disconnected, this, &IpcClient::disconnected);
-    auto QAbstractSocket__error = &QAbstractSocket::errorOccurred;
-    connect(m_socket, QAbstractSocket__error, this, &IpcClient::onError);
-    connect(m_socket, &QAbstractSocket::bytesWritten, this, &IpcClient::onBytesWritten);
+    connect(m_transport, &IpcTransport::connected, this, &IpcClient::connected);
+    connect(m_transport, &IpcTransport::disconnected, this, &IpcClient::disconnected);
+    connect(m_transport, &IpcTransport::errorOccurred, this, &IpcClient::onError);
+    connect(m_transport, &IpcTransport::bytesWritten, this, &IpcClient::onBytesWritten);
+    connect(m_transport, &IpcTransport::sharedMemoryAttached, this, &IpcClient::confirmSharedMemory);
+    connect(m_transport, &IpcTransport::peerSharedMemoryAttached, this, &IpcClient::onSharedMemoryAttached);
+
+    sendHello();
+#if QT_VERSION < QT_VERSION_CHECK(5, 4, 0)
+    QTimer::singleShot(0, this, SLOT(processQueue()));
+#else
+    QTimer::singleShot(0, this, &IpcClient::processQueue);
+#endif
+}
+
+/*!
+ * Destroys the client, releasing its shared memory
+ */
+IpcClient::~IpcClient()
+{
+    delete m_sharedMemory;
+}
+
+/*!
+ * Returns the transport packages are written to
+ */
+IpcTransport *IpcClient::transport() const
+{
+    return m_transport;
 }
 
 /*!
@@ -114,15 +244,18 @@ IpcClient::IpcClient(QTcpSocket *socket, QObject *parent)
  */
 QAbstractSocket::SocketState IpcClient::state() const
 {
-    return m_socket->state();
+    return m_transport->state();
 }
 
 /*!
  * Sets the Ip-Address to \a hostName and port to \a port to be used for a IPC call.
+ *
+ * Servers on this machine are connected with a local socket if possible,
+ * see setLocalTransportEnabled().
  */
 void IpcClient::connectToServer(const QString &hostName, int port)
 {
-    m_socket->connectToHost(hostName, port);
+    m_transport->connectToHost(hostName, port);
 }
 
 /*!
@@ -131,17 +264,79 @@ void IpcClient::connectToServer(const QString &hostName, int port)
  * Expects the \a method to be in the form of "echo(QString)" and uses \a data as the content of the arguments
  * Returns a QUuid which identifies this Package
  *
- * \sa sentSuccessfully(), sendingError()
+ * If \a key is not empty, a queued package with the same key is superseded.
+ * The package is queued in \a lane, the package superseded may have been
+ * queued in another one.
+ *
+ * \sa sentSuccessfully(), sendingError(), superseded()
  */
-QUuid IpcClient::send(const QString &method, const QByteArray &data)
+QUuid IpcClient::send(const QString &method, const QByteArray &data, const QString &key, Lane lane)
 {
     Package *pkg = new Package;
     pkg->m_method = method;
     pkg->m_data = data;
+    pkg->m_key = key;
+    pkg->m_lane = lane;
+    return enqueue(pkg);
+}
+
+/*!
+ * Send call to server given by destination, producing the content lazily
+ *
+ * Works like the other overload, but \a producer is only called to create
+ * the content of \a method right before it is written to the socket. A
+ * queued package with the same non-empty \a key is superseded. If it
+ * returns a null QByteArray, the package is dropped and sendingError() is
+ * emitted for it.
+ */
+QUuid IpcClient::send(const QString &method, const std::function<QByteArray()> &producer,
+                      const QString &key, Lane lane)
+{
+    Package *pkg = new Package;
+    pkg->m_method = method;
+    pkg->m_producer = producer;
+    pkg->m_key = key;
+    pkg->m_lane = lane;
+    return enqueue(pkg);
+}
+
+QUuid IpcClient::enqueue(Package *pkg)
+{
     pkg->m_uuid = QUuid::createUuid();
-    pkg->m_bytes = 0;
+    pkg->m_internal = false;
+    pkg->m_sequence = 0;
+    pkg->m_end = 0;
     pkg->m_tries = 0;
-    m_queue.enqueue(pkg);
+
+    Package *stale = 0;
+    if (!pkg->m_key.isEmpty()) {
+        for (int lane = 0; lane < LaneCount && !stale; ++lane) {
+            QQueue<Package*> &queue = m_lanes[lane];
+            for (int i = 0; i < queue.count(); ++i) {
+                if (queue.at(i)->m_key != pkg->m_key)
+                    continue;
+                stale = queue.at(i);
+                // Keep the place in the queue, unless the lane changes
+                if (lane == pkg->m_lane)
+                    queue[i] = pkg;
+                else
+                    queue.removeAt(i);
+                break;
+            }
+        }
+    }
+
+    if (stale) {
+        DEBUG << "IpcClient: superseding queued" << stale->m_method << "for" << stale->m_key;
+        const bool replaced = stale->m_lane == pkg->m_lane;
+        const QUuid uuid = stale->m_uuid;
+        delete stale;
+        emit superseded(uuid);
+        if (replaced)
+            return pkg->m_uuid;
+    }
+
+    m_lanes[pkg->m_lane].enqueue(pkg);
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 4, 0)
     QTimer::singleShot(0, this, SLOT(processQueue()));
@@ -152,6 +347,188 @@ QUuid IpcClient::send(const QString &method, const QByteArray &data)
     return pkg->m_uuid;
 }
 
+void IpcClient::onConnected()
+{
+    m_transport->resetPeer();
+    delete m_sharedMemory;
+    m_sharedMemory = 0;
+    m_sharedMemoryAttached = false;
+    m_sharedMemoryFailed = false;
+    m_methodIds.clear();
+    m_sequence = 0;
+    m_sentOffset = 0;
+    m_writtenOffset = 0;
+    sendHello();
+    processQueue();
+}
+
+// Announces what this side accepts, ahead of anything else queued
+void IpcClient::sendHello()
+{
+    Package *pkg = new Package;
+    pkg->m_uuid = QUuid::createUuid();
+    pkg->m_method = QStringLiteral("ipcHello()");
+    pkg->m_data = IpcConnection::helloContent(m_transport->kind() == IpcTransport::LocalTransport);
+    pkg->m_lane = ControlLane;
+    pkg->m_internal = true;
+    pkg->m_sequence = 0;
+    pkg->m_end = 0;
+    pkg->m_tries = 0;
+    m_lanes[ControlLane].prepend(pkg);
+}
+
+/*!
+ * Returns the zlib compression level, -1 selects the zlib default
+ *
+ * \sa setCompressionLevel()
+ */
+int IpcClient::compressionLevel() const
+{
+    return m_compressionLevel;
+}
+
+/*!
+ * Sets the zlib compression \a level from 0 to 9, 0 disables compression
+ *
+ * Lower levels take less time on the sending side, decompression costs
+ * about the same for all levels.
+ */
+void IpcClient::setCompressionLevel(int level)
+{
+    m_compressionLevel = qBound(-1, level, 9);
+}
+
+/*!
+ * Returns the content size from which on content is compressed
+ */
+int IpcClient::compressionThreshold() const
+{
+    return m_compressionThreshold;
+}
+
+/*!
+ * Sets the content size from which on content is compressed to \a bytes
+ */
+void IpcClient::setCompressionThreshold(int bytes)
+{
+    m_compressionThreshold = bytes;
+}
+
+/*!
+ * Sets the function compressing content to \a compressor
+ *
+ * It is called with the content and the compressionLevel(). The default
+ * compresses with qCompress(). A compressor may return content it compressed
+ * before, e.g. when the same content is sent to several peers. Results not
+ * smaller than the content are not used.
+ */
+void IpcClient::setCompressor(const Compressor &compressor)
+{
+    m_compressor = compressor;
+}
+
+/*!
+ * Returns the highest frame version used to send packages
+ *
+ * \sa setProtocolVersion()
+ */
+int IpcClient::protocolVersion() const
+{
+    return m_protocolVersion;
+}
+
+/*!
+ * Limits the frames used to send packages to \a version, e.g.
+ * IpcProtocol::TextVersion to talk like older versions do
+ *
+ * Frames of a higher version than the peer announced are never used.
+ */
+void IpcClient::setProtocolVersion(int version)
+{
+    m_protocolVersion = qBound<int>(IpcProtocol::TextVersion, version, IpcProtocol::CurrentVersion);
+}
+
+/*!
+ * Returns whether servers on this machine are connected with a local
+ * socket, true by default
+ */
+bool IpcClient::isLocalTransportEnabled() const
+{
+    return m_transport->isLocalTransportEnabled();
+}
+
+/*!
+ * Sets whether servers on this machine are connected with a local socket
+ * to \a enabled. Takes effect with the next connectToServer().
+ */
+void IpcClient::setLocalTransportEnabled(bool enabled)
+{
+    m_transport->setLocalTransportEnabled(enabled);
+}
+
+/*!
+ * Returns the size of the ring shared with a local peer, 16 MiB by default
+ *
+ * \sa setSharedMemorySize()
+ */
+int IpcClient::sharedMemorySize() const
+{
+    return m_sharedMemorySize;
+}
+
+/*!
+ * Sets the size of the ring shared with a local peer to \a bytes, 0
+ * disables passing content in shared memory
+ *
+ * The ring is created when the first large content is sent on a
+ * connection, changing its size only affects later connections.
+ */
+void IpcClient::setSharedMemorySize(int bytes)
+{
+    m_sharedMemorySize = qMax(bytes, 0);
+}
+
+/*!
+ * Returns the number of bytes buffered by the socket before no further
+ * packages are written to it
+ *
+ * \sa setHighWaterMark()
+ */
+qint64 IpcClient::highWaterMark() const
+{
+    return m_highWaterMark;
+}
+
+/*!
+ * Sets the high-water mark of the socket buffer to \a bytes
+ *
+ * A lower mark bounds the memory used for sending, a higher one keeps more
+ * data in flight. At least one package is always written, whatever its size.
+ */
+void IpcClient::setHighWaterMark(qint64 bytes)
+{
+    m_highWaterMark = qMax<qint64>(bytes, 1);
+}
+
+/*!
+ * Returns the number of bytes written to the socket but not yet sent
+ */
+qint64 IpcClient::bytesToWrite() const
+{
+    return m_transport->device()->bytesToWrite();
+}
+
+/*!
+ * Returns the number of packages not yet completely sent
+ */
+int IpcClient::pendingCount() const
+{
+    int count = m_sending.count();
+    for (int lane = 0; lane < LaneCount; ++lane)
+        count += m_lanes[lane].count();
+    return count;
+}
+
 /*!
  * Waits until the client is connected to the server
  * \a msecs specfies the time how long to wait
@@ -163,7 +540,7 @@ QUuid IpcClient::send(const QString &method, const QByteArray &data)
  */
 bool IpcClient::waitForConnected(int msecs)
 {
-    return m_socket->waitForConnected(msecs);
+    return m_transport->waitForConnected(msecs);
 }
 
 /*!
@@ -177,7 +554,7 @@ bool IpcClient::waitForConnected(int msecs)
  */
 bool IpcClient::waitForDisconnected(int msecs)
 {
-    return m_socket->waitForDisconnected(msecs);
+    return m_transport->waitForDisconnected(msecs);
 }
 
 /*!
@@ -192,14 +569,13 @@ bool IpcClient::waitForDisconnected(int msecs)
 bool IpcClient::waitForSent(const QUuid uuid, int msecs)
 {
     QPointer<Package> waitForPackage = 0;
-    if (m_current && m_current->m_uuid == uuid) {
-        waitForPackage = m_current;
-    } else {
-        foreach (Package *pkg, m_queue) {
-            if (pkg->m_uuid == uuid) {
-                waitForPackage = pkg;
-                break;
-            }
+    QList<Package*> pending = m_sending;
+    for (int lane = 0; lane < LaneCount; ++lane)
+        pending += m_lanes[lane];
+    foreach (Package *pkg, pending) {
+        if (pkg->m_uuid == uuid) {
+            waitForPackage = pkg;
+            break;
         }
     }
 
@@ -211,7 +587,7 @@ bool IpcClient::waitForSent(const QUuid uuid, int msecs)
 
     bool sent = false;
     while (!sent && (msecs == -1 || stopWatch.elapsed() < msecs)) {
-        if (!m_socket->waitForBytesWritten(msecs - stopWatch.elapsed()))
+        if (!m_transport->waitForBytesWritten(msecs - stopWatch.elapsed()))
             return false;
 
         if (!waitForPackage)
@@ -286,69 +662,189 @@ QString IpcClient::errorToString(QAbstractSocket::SocketError error)
  */
 void IpcClient::disconnectFromServer()
 {
-    m_socket->disconnectFromHost();
+    m_transport->disconnectFromHost();
+}
+
+// Returns the most urgent lane with queued packages, -1 if there is none
+int IpcClient::nextLane() const
+{
+    for (int lane = 0; lane < LaneCount; ++lane) {
+        if (!m_lanes[lane].isEmpty())
+            return lane;
+    }
+    return -1;
 }
 
 void IpcClient::processQueue()
 {
-    if (m_current)
-        return;
+    for (int lane = nextLane(); lane >= 0; lane = nextLane()) {
+        // Control messages are small, they do not wait for the window
+        if (lane != ControlLane && m_transport->device()->bytesToWrite() >= m_highWaterMark)
+            return;
 
-    if (!m_queue.isEmpty()) {
-        m_current = m_queue.head();
-        m_current->m_tries++;
+        QQueue<Package*> &queue = m_lanes[lane];
+        Package *pkg = queue.head();
+        pkg->m_tries++;
 
-        if (m_current->m_tries >= 5) {
-            DEBUG << "Tried to sent the package" << m_current->m_tries << "times, but didn't succeed";
-            m_queue.dequeue();
-            onError(QAbstractSocket::ConnectionRefusedError);
-#if QT_VERSION < QT_VERSION_CHECK(5, 4, 0)
-            QTimer::singleShot(0, this, SLOT(processQueue()));
-#else
-            QTimer::singleShot(0, this, &IpcClient::processQueue);
-#endif
-            return;
+        if (pkg->m_tries >= 5) {
+            DEBUG << "Tried to sent the package" << pkg->m_tries << "times, but didn't succeed";
+            queue.dequeue();
+            fail(pkg, QAbstractSocket::ConnectionRefusedError);
+            continue;
         }
 
-        int size = sendPackage(m_current->m_method, m_current->m_data);
-
-        if (size != -1) {
-            m_queue.dequeue();
-            m_current->m_bytes = size;
-        } else {
+        if (m_transport->state() != QAbstractSocket::ConnectedState) {
+            DEBUG << "Tried to write on a Unconnected Socket. Try again later";
 #if QT_VERSION < QT_VERSION_CHECK(5, 4, 0)
             QTimer::singleShot(1000, this, SLOT(processQueue()));
 #else
             QTimer::singleShot(1000, this, &IpcClient::processQueue);
 #endif
-            m_current = 0;
+            return;
         }
+
+        queue.dequeue();
+
+        if (pkg->m_producer) {
+            pkg->m_data = pkg->m_producer();
+            pkg->m_producer = nullptr;
+            if (pkg->m_data.isNull()) {
+                fail(pkg, QAbstractSocket::UnknownSocketError);
+                continue;
+            }
+        }
+
+        if (!m_sharedMemory && usesSharedMemory(pkg))
+            createSharedMemory();
+        write(pkg);
     }
 }
 
-void IpcClient::onBytesWritten(qint64 written)
+// Writes the package, it is complete once the stream was written up to its end
+void IpcClient::write(Package *pkg)
+{
+    pkg->m_sequence = ++m_sequence;
+    m_sentOffset += sendPackage(pkg);
+    pkg->m_end = m_sentOffset;
+    // Written to the socket buffer, no need to keep a copy
+    pkg->m_data.clear();
+    m_sending.enqueue(pkg);
+}
+
+// Returns true if the content of the package is passed in shared memory
+bool IpcClient::usesSharedMemory(const Package *pkg) const
 {
-    Q_ASSERT(m_current);
+    return m_sharedMemorySize > 0 && !m_sharedMemoryFailed
+            && pkg->m_data.size() >= SharedMemoryThreshold
+            && m_transport->kind() == IpcTransport::LocalTransport
+            && qMin(m_protocolVersion, m_transport->peerVersion()) >= IpcProtocol::BinaryVersion
+            && m_transport->peerEncodings().contains(QLatin1String("shm"));
+}
 
-    m_written += written;
-    if (m_written < m_current->m_bytes)
+// Creates the ring for large content and announces it to the peer
+void IpcClient::createSharedMemory()
+{
+    m_sharedMemory = new IpcSharedMemory;
+    if (!m_sharedMemory->create(m_sharedMemorySize)) {
+        qWarning() << "Unable to create shared memory, sending content inline:"
+                   << m_sharedMemory->errorString();
+        delete m_sharedMemory;
+        m_sharedMemory = 0;
+        m_sharedMemoryFailed = true;
         return;
+    }
 
-    m_written = m_written - m_current->m_bytes;
-    emit sentSuccessfully(m_current->m_uuid);
-    m_lastSuccess = m_current->m_uuid;
-    delete m_current;
-    m_current = 0;
+    Package *pkg = new Package;
+    pkg->m_uuid = QUuid::createUuid();
+    pkg->m_method = QStringLiteral("ipcSharedMemory()");
+    QDataStream out(&pkg->m_data, QIODevice::WriteOnly);
+    out << m_sharedMemory->key();
+    pkg->m_lane = ControlLane;
+    pkg->m_internal = true;
+    pkg->m_sequence = 0;
+    pkg->m_end = 0;
+    pkg->m_tries = 0;
+    write(pkg);
+}
 
+// Tells the peer whether the IpcConnection reading the transport attached
+// to the ring \a key of the peer
+void IpcClient::confirmSharedMemory(const QString &key, bool ok)
+{
+    Package *pkg = new Package;
+    pkg->m_uuid = QUuid::createUuid();
+    pkg->m_method = QStringLiteral("ipcSharedMemoryAttached()");
+    QDataStream out(&pkg->m_data, QIODevice::WriteOnly);
+    out << key << ok;
+    pkg->m_lane = ControlLane;
+    pkg->m_internal = true;
+    pkg->m_sequence = 0;
+    pkg->m_end = 0;
+    pkg->m_tries = 0;
+    m_lanes[ControlLane].enqueue(pkg);
     processQueue();
 }
 
+void IpcClient::onSharedMemoryAttached(const QString &key, bool ok)
+{
+    if (!m_sharedMemory || m_sharedMemory->key() != key)
+        return;
+
+    if (ok) {
+        DEBUG << "IpcClient: peer attached to shared memory" << key;
+        m_sharedMemoryAttached = true;
+        return;
+    }
+
+    qWarning() << "Peer is unable to attach to shared memory, sending content inline";
+    delete m_sharedMemory;
+    m_sharedMemory = 0;
+    m_sharedMemoryFailed = true;
+}
+
+void IpcClient::onBytesWritten(qint64 written)
+{
+    emit bytesWritten(written);
+
+    // Packages are complete once the stream was written up to their end
+    m_writtenOffset += written;
+    while (!m_sending.isEmpty() && m_sending.head()->m_end <= m_writtenOffset) {
+        Package *pkg = m_sending.dequeue();
+        if (!pkg->m_internal) {
+            emit sentSuccessfully(pkg->m_uuid);
+            m_lastSuccess = pkg->m_uuid;
+        }
+        delete pkg;
+    }
+
+    processQueue();
+}
+
+void IpcClient::fail(Package *pkg, QAbstractSocket::SocketError socketError)
+{
+    if (!pkg->m_internal)
+        emit sendingError(pkg->m_uuid, socketError);
+    delete pkg;
+
+    if ((m_transport->state() != QAbstractSocket::ConnectedState &&
+        m_transport->state() != QAbstractSocket::BoundState) ||
+        socketError == QAbstractSocket::RemoteHostClosedError) {
+        emit connectionError(socketError);
+    }
+}
+
 void IpcClient::onError(QAbstractSocket::SocketError socketError)
 {
-    if (m_current) {
-        emit sendingError(m_current->m_uuid, socketError);
-        delete m_current;
-        m_current = 0;
+    if (!m_sending.isEmpty()) {
+        // Whatever was handed to the socket is lost
+        while (!m_sending.isEmpty()) {
+            Package *pkg = m_sending.dequeue();
+            if (!pkg->m_internal)
+                emit sendingError(pkg->m_uuid, socketError);
+            delete pkg;
+        }
+        m_sentOffset = 0;
+        m_writtenOffset = 0;
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 4, 0)
         QTimer::singleShot(0, this, SLOT(processQueue()));
@@ -357,28 +853,73 @@ void IpcClient::onError(QAbstractSocket::SocketError socketError)
 #endif
     }
 
-    if ((m_socket->state() != QAbstractSocket::ConnectedState &&
-        m_socket->state() != QAbstractSocket::BoundState) ||
+    if ((m_transport->state() != QAbstractSocket::ConnectedState &&
+        m_transport->state() != QAbstractSocket::BoundState) ||
         socketError == QAbstractSocket::RemoteHostClosedError) {
         emit connectionError(socketError);
     }
 }
 
-qint64 IpcClient::sendPackage(const QString &method, const QByteArray &data)
+qint64 IpcClient::sendPackage(const Package *pkg)
 {
-    DEBUG << "IpcClient::send: " << method;
+    const QString &method = pkg->m_method;
+    const QByteArray &data = pkg->m_data;
+    DEBUG << "IpcClient::send: " << method << "sequence" << pkg->m_sequence;
+
+    QIODevice *device = m_transport->device();
+    QByteArray content = data;
+    bool compressed = false;
+    bool shared = false;
+    quint64 position;
+    if (m_sharedMemoryAttached && usesSharedMemory(pkg) && m_sharedMemory->write(data, &position)) {
+        DEBUG << "\tpassed" << data.size() << "bytes in shared memory";
+        content = IpcProtocol::sharedMemoryReference(position, data.size());
+        shared = true;
+    } else if (m_compressionLevel != 0 && data.size() >= m_compressionThreshold
+            && m_transport->kind() != IpcTransport::LocalTransport
+            && m_transport->peerEncodings().contains(QLatin1String("zlib"))) {
+        const QByteArray packed = m_compressor(data, m_compressionLevel);
+        if (packed.size() < data.size()) {
+            DEBUG << "\tcompressed" << data.size() << "to" << packed.size();
+            content = packed;
+            compressed = true;
+        }
+    }
 
-    if (!m_socket->isValid() || m_socket->state() != QAbstractSocket::ConnectedState) {
-        DEBUG << "Tried to write on a Unconnected Socket. Try again later";
-        return -1;
+    if (qMin(m_protocolVersion, m_transport->peerVersion()) < IpcProtocol::BinaryVersion) {
+        const QByteArray header = IpcProtocol::textHeader(method, compressed, content.size());
+        device->write(header);
+        device->write(content);
+        return header.size() + content.size();
     }
 
-    m_socket->write(QString("Method:%1\n").arg(method).toLatin1());
-    m_socket->write(QString("Content-Length:%1\n").arg(data.length()).toLatin1());
-    m_socket->write(QString("\n").toLatin1());
-    m_socket->write(data);
+    IpcProtocol::FrameHeader frame;
+    frame.flags = (compressed ? IpcProtocol::CompressedFlag : IpcProtocol::NoFlags)
+            | (shared ? IpcProtocol::SharedMemoryFlag : IpcProtocol::NoFlags);
+    frame.length = content.size();
+    frame.sequence = pkg->m_sequence;
+
+    // The first frame of a method defines its id, id 0 always names it
+    QByteArray name;
+    auto it = m_methodIds.constFind(method);
+    if (it != m_methodIds.constEnd()) {
+        frame.methodId = it.value();
+    } else {
+        name = method.toLatin1();
+        frame.nameLength = name.size();
+        if (m_methodIds.size() < 0xffff) {
+            frame.methodId = m_methodIds.size() + 1;
+            m_methodIds.insert(method, frame.methodId);
+        }
+    }
 
-    return m_socket->bytesToWrite();
+    char header[IpcProtocol::HeaderSize];
+    IpcProtocol::writeHeader(frame, header);
+    device->write(header, IpcProtocol::HeaderSize);
+    if (!name.isEmpty())
+        device->write(name);
+    device->write(content);
+    return IpcProtocol::HeaderSize + name.size() + content.size();
 }
 
 /*!
@@ -407,8 +948,19 @@ qint64 IpcClient::sendPackage(const QString &method, const QByteArray &data)
  * Emitted when an error \a socketError occurred while sending a Package identified by \a uuid.
  */
 
+/*!
+ * \fn IpcClient::superseded(const QUuid& uuid)
+ * Emitted when the queued Package identified by \a uuid was replaced by a newer
+ * one with the same key and will not be sent.
+ */
+
 /*!
  * \fn IpcClient::received(const QString& method, const QByteArray& content)
  *
  * Called when an RPC call was received. Provides the \a method and the \a content.
  */
+
+/*!
+ * \fn IpcClient::bytesWritten(qint64 bytes)
+ * Emitted when \a bytes of the queued packages were written to the network.
+ */
@@ -36,19 +36,59 @@
 #include <QUuid>
 #include <QQueue>
 #include "ipcconnection.h"
+#include "ipctransport.h"
+
+#include <functional>
 
 class Package;
+class IpcSharedMemory;
 class IpcClient : public QObject
 {
     Q_OBJECT
 public:
+    enum Lane
+    {
+        ControlLane,
+        InteractiveLane,
+        BulkLane,
+        LaneCount
+    };
+
+    typedef std::function<QByteArray(const QByteArray &, int)> Compressor;
+
     explicit IpcClient(QObject *parent = 0);
     IpcClient(QTcpSocket* socket, QObject *parent = 0);
+    IpcClient(IpcTransport* transport, QObject *parent = 0);
+    ~IpcClient();
+
+    IpcTransport *transport() const;
 
     QAbstractSocket::SocketState state() const;
 
     void connectToServer(const QString& hostName, int port);
-    QUuid send(const QString& method, const QByteArray& data);
+    QUuid send(const QString& method, const QByteArray& data, const QString &key = QString(),
+               Lane lane = BulkLane);
+    QUuid send(const QString& method, const std::function<QByteArray()> &producer,
+               const QString &key = QString(), Lane lane = BulkLane);
+
+    qint64 highWaterMark() const;
+    void setHighWaterMark(qint64 bytes);
+    qint64 bytesToWrite() const;
+    int pendingCount() const;
+
+    int compressionLevel() const;
+    void setCompressionLevel(int level);
+    int compressionThreshold() const;
+    void setCompressionThreshold(int bytes);
+    void setCompressor(const Compressor &compressor);
+
+    int protocolVersion() const;
+    void setProtocolVersion(int version);
+
+    bool isLocalTransportEnabled() const;
+    void setLocalTransportEnabled(bool enabled);
+    int sharedMemorySize() const;
+    void setSharedMemorySize(int bytes);
 
     bool waitForConnected(int msecs = 30000);
     bool waitForDisconnected(int msecs = 30000);
@@ -63,25 +103,49 @@ Q_SIGNALS:
 
     void sentSuccessfully(const QUuid& uuid);
     void sendingError(const QUuid& uuid, QAbstractSocket::SocketError socketError);
+    void superseded(const QUuid& uuid);
 
     void received(const QString& method, const QByteArray& content);
+    void bytesWritten(qint64 bytes);
 
 public Q_SLOTS:
     void disconnectFromServer();
 
 private Q_SLOTS:
+    void onConnected();
     void processQueue();
     void onBytesWritten(qint64 written);
     void onError(QAbstractSocket::SocketError socketError);
+    void confirmSharedMemory(const QString &key, bool ok);
+    void onSharedMemoryAttached(const QString &key, bool ok);
 
 private:
-    qint64 sendPackage(const QString& method, const QByteArray& data);
-
-    QTcpSocket *m_socket;
-    QQueue<Package*> m_queue;
-    Package* m_current;
-    qint64 m_written;
+    QUuid enqueue(Package *pkg);
+    int nextLane() const;
+    void sendHello();
+    bool usesSharedMemory(const Package *pkg) const;
+    void createSharedMemory();
+    void write(Package *pkg);
+    void fail(Package *pkg, QAbstractSocket::SocketError socketError);
+    qint64 sendPackage(const Package *pkg);
+
+    IpcTransport *m_transport;
+    QQueue<Package*> m_lanes[LaneCount];
+    QQueue<Package*> m_sending;
+    qint64 m_sentOffset;
+    qint64 m_writtenOffset;
+    qint64 m_highWaterMark;
+    int m_compressionLevel;
+    int m_compressionThreshold;
+    Compressor m_compressor;
+    int m_protocolVersion;
+    QHash<QString, quint16> m_methodIds;
+    quint32 m_sequence;
     QUuid m_lastSuccess;
+    int m_sharedMemorySize;
+    IpcSharedMemory *m_sharedMemory;
+    bool m_sharedMemoryAttached;
+    bool m_sharedMemoryFailed;
 
     IpcConnection* m_connection;
 };
@@ -31,6 +31,8 @@
 ****************************************************************************/
 
 #include "ipcconnection.h"
+#include "ipctransport.h"
+#include "ipcsharedmemory.h"
 
 #ifdef QMLLIVE_IPC_DEBUG
 #define DEBUG qDebug()
@@ -38,27 +40,138 @@
 #define DEBUG if (0) qDebug()
 #endif
 
+namespace {
+const char *const ZlibEncoding = "zlib";
+// Large content is passed in an IpcSharedMemory ring, local peers only
+const char *const SharedMemoryEncoding = "shm";
+}
+
 /**
  * \class IpcConnection
  * \brief Handles a single connection from the IpcServer or IpcClient
  * \inmodule ipc
+ *
+ * Both ends of a connection start by sending an "ipcHello()" call listing
+ * the content encodings they accept. The connection handles it itself and
+ * records the encodings on the IpcTransport, where the IpcClient writing to
+ * the same transport picks them up with IpcTransport::peerEncodings(). Peers
+ * which never send it only receive plain content.
+ *
+ * The hello also announces the highest frame version this side reads, see
+ * IpcProtocol. Both text and binary frames are accepted at any time.
+ *
+ * Peers on the same machine also accept content passed in shared memory.
+ * The sending side announces its IpcSharedMemory ring with an
+ * "ipcSharedMemory()" call. The receiving side answers with an
+ * "ipcSharedMemoryAttached()" call telling whether it could attach, e.g. it
+ * can not with a separate IPC namespace. Only then frames reference the
+ * ring, until then and after a failure content is sent inline.
+ *
+ * Compressed content is decoded off the calling thread. Calls are still
+ * delivered in the order they were received.
  */
 
 /**
- * \brief Constructs a IpcConnection with \a socket and a \a parent
+ * \brief Constructs a IpcConnection reading from \a transport with a \a parent
  */
-IpcConnection::IpcConnection(QTcpSocket *socket, QObject *parent)
+IpcConnection::IpcConnection(IpcTransport *transport, QObject *parent)
     : QObject(parent)
-    , m_socket(socket)
+    , m_transport(transport)
+    , m_sharedMemory(0)
     , m_headerComplete(false)
-    , m_maxContentSize(1024*1024*10)
+    , m_binaryFrame(false)
+    , m_sequence(0)
+    , m_maxContentSize(DefaultMaxContentSize)
+    , m_decoder(new QFutureWatcher<QByteArray>(this))
 {
     DEBUG << "IpcConnection()";
 
-    connect(m_socket, &QAbstractSocket::disconnected, this, &IpcConnection::close);
-    auto QAbstractSocket__error = &QAbstractSocket::error;
-    connect(m_socket, QAbstractSocket__error, this, &IpcConnection::closeWithError);
-    connect(m_socket, &QAbstractSocket::readyRead, this, &IpcConnection::readData);
+    connect(m_transport, &IpcTransport::disconnected, this, &IpcConnection::close);
+    connect(m_transport, &IpcTransport::errorOccurred, this, &IpcConnection::closeWithError);
+    connect(m_transport, &IpcTransport::readyRead, this, &IpcConnection::readData);
+    connect(m_decoder, &QFutureWatcherBase::finished, this, &IpcConnection::onDecoded);
+}
+
+/**
+ * \brief Destroys the connection, detaching from the peer's shared memory
+ */
+IpcConnection::~IpcConnection()
+{
+    delete m_sharedMemory;
+}
+
+/**
+ * \brief Returns the content of the "ipcHello()" call announcing what this
+ * side accepts, shared memory only if the peer is \a local
+ */
+QByteArray IpcConnection::helloContent(bool local)
+{
+    QStringList encodings;
+    encodings << QLatin1String(ZlibEncoding);
+    if (local)
+        encodings << QLatin1String(SharedMemoryEncoding);
+
+    QVariantMap hello;
+    hello.insert(QStringLiteral("version"), int(IpcProtocol::CurrentVersion));
+    hello.insert(QStringLiteral("acceptEncoding"), encodings);
+
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out << hello;
+    return bytes;
+}
+
+void IpcConnection::handleHello(const QByteArray &content)
+{
+    QVariantMap hello;
+    QDataStream in(content);
+    in >> hello;
+
+    QStringList encodings;
+    foreach (const QString &encoding, hello.value(QStringLiteral("acceptEncoding")).toStringList()) {
+        if (encoding == QLatin1String(ZlibEncoding) || encoding == QLatin1String(SharedMemoryEncoding))
+            encodings.append(encoding);
+    }
+
+    const int version = hello.value(QStringLiteral("version")).toInt();
+
+    DEBUG << "IpcConnection: peer accepts" << encodings << "frame version" << version;
+    m_transport->setPeer(encodings, version);
+}
+
+void IpcConnection::handleSharedMemory(const QByteArray &content)
+{
+    QString key;
+    QDataStream in(content);
+    in >> key;
+
+    if (!m_sharedMemory)
+        m_sharedMemory = new IpcSharedMemory;
+    const bool ok = m_sharedMemory->attach(key);
+    if (!ok)
+        qWarning() << "unable to attach to shared memory of peer:" << m_sharedMemory->errorString();
+    m_transport->setSharedMemoryAttached(key, ok);
+}
+
+void IpcConnection::handleSharedMemoryAttached(const QByteArray &content)
+{
+    QString key;
+    bool ok = false;
+    QDataStream in(content);
+    in >> key >> ok;
+    m_transport->setPeerSharedMemoryAttached(key, ok && in.status() == QDataStream::Ok);
+}
+
+// Returns the content the reference points to, a null QByteArray on errors
+QByteArray IpcConnection::readShared(const QByteArray &reference)
+{
+    quint64 position;
+    quint32 length;
+    if (!m_sharedMemory || !IpcProtocol::readSharedMemoryReference(reference, &position, &length)
+            || length > m_maxContentSize) {
+        return QByteArray();
+    }
+    return m_sharedMemory->read(position, length);
 }
 
 /**
@@ -67,6 +180,13 @@ IpcConnection::IpcConnection(QTcpSocket *socket, QObject *parent)
 void IpcConnection::close()
 {
     DEBUG << "IpcConnection::close()";
+    // A reconnecting peer starts over with its method ids and sequence
+    reset();
+    m_binaryFrame = false;
+    m_methods.clear();
+    m_sequence = 0;
+    delete m_sharedMemory;
+    m_sharedMemory = 0;
     emit connectionClosed();
 }
 
@@ -75,8 +195,8 @@ void IpcConnection::close()
  */
 void IpcConnection::closeWithError()
 {
-    DEBUG << "IpcConnection::closeWithError: " << m_socket->errorString();
-    emit error(m_socket->errorString());
+    DEBUG << "IpcConnection::closeWithError: " << m_transport->errorString();
+    emit error(m_transport->errorString());
     close();
 }
 
@@ -85,60 +205,225 @@ void IpcConnection::closeWithError()
  */
 void IpcConnection::readData()
 {
-    while (m_socket->bytesAvailable()) {
-        if (!m_headerComplete) {
+    forever {
+        const bool complete = (m_binaryFrame || startsBinaryFrame())
+                ? readBinaryFrame() : readTextFrame();
+        if (!complete)
+            return;
+    }
+}
 
-            //Not enough bytesAvailable() try again later.
-            if (!m_socket->canReadLine())
-                return;
+bool IpcConnection::startsBinaryFrame() const
+{
+    char first;
+    return !m_headerComplete && m_headers.isEmpty()
+            && m_transport->device()->peek(&first, 1) == 1 && IpcProtocol::isBinaryFrame(first);
+}
 
-            while (m_socket->canReadLine()) {
-                QString line = m_socket->readLine().trimmed();
-                DEBUG << "\treceived header: " << line;
-                if (line.isEmpty()) {
-                    DEBUG << "\theader complete";
-                    if (m_headers.contains("Method") || m_headers.contains("Content-Length")) {
-                        m_headerComplete = true;
-                    } else { // we can't recover
-                        qWarning() << "\tincomplete header";
-                        reset();
-                    }
-                    break;
-                }
-                QStringList parts = line.split(":");
-                if (parts.count() != 2) {
-                    qWarning() << "invalid header line: " << line;
-                    break;
+/**
+ * \brief Reads a version 1 frame, returns false if more data is needed
+ */
+bool IpcConnection::readTextFrame()
+{
+    QIODevice *device = m_transport->device();
+
+    if (!m_headerComplete) {
+
+        //Not enough bytesAvailable() try again later.
+        if (!device->canReadLine())
+            return false;
+
+        while (device->canReadLine()) {
+            QString line = device->readLine().trimmed();
+            DEBUG << "\treceived header: " << line;
+            if (line.isEmpty()) {
+                DEBUG << "\theader complete";
+                if (m_headers.contains("Method") || m_headers.contains("Content-Length")) {
+                    m_headerComplete = true;
+                } else { // we can't recover
+                    qWarning() << "\tincomplete header";
+                    reset();
                 }
-                m_headers.insert(parts.at(0).trimmed(), parts.at(1).trimmed());
+                break;
             }
-        }
-        if (m_headerComplete) {
-            int bufferSize = m_headers.value("Content-Length").toInt();
-            if (bufferSize > m_maxContentSize) {
-                qWarning() << "content to large to be received. max size: " << m_maxContentSize;
-                reset();
-                return;
+            QStringList parts = line.split(":");
+            if (parts.count() != 2) {
+                qWarning() << "invalid header line: " << line;
+                break;
             }
+            m_headers.insert(parts.at(0).trimmed(), parts.at(1).trimmed());
+        }
+        if (!m_headerComplete)
+            return true;
+    }
+
+    int bufferSize = m_headers.value("Content-Length").toInt();
+    if (bufferSize > m_maxContentSize) {
+        qWarning() << "content to large to be received. max size: " << m_maxContentSize;
+        reset();
+        return false;
+    }
 
-            DEBUG << "receive content (bytes): " << bufferSize;
-            if (m_socket->bytesAvailable() < bufferSize) {
-                DEBUG << "content wait for more data";
+    DEBUG << "receive content (bytes): " << bufferSize;
+    if (device->bytesAvailable() < bufferSize) {
+        DEBUG << "content wait for more data";
+        return false;
+    }
+
+    QByteArray content;
+    content.resize(bufferSize);
+    if (device->read(content.data(), bufferSize) != bufferSize) {
+        qWarning() << "error reading content from stream";
+    }
+    QString method = m_headers.value("Method");
+    QString encoding = m_headers.value("Content-Encoding");
+    reset();
+
+    if (!encoding.isEmpty() && encoding != QLatin1String(ZlibEncoding)) {
+        qWarning() << "unsupported content encoding: " << encoding;
+        return true;
+    }
+    receive(method, content, !encoding.isEmpty());
+    return true;
+}
+
+/**
+ * \brief Reads a version 2 frame, returns false if more data is needed
+ *
+ * The stream can not be resynchronized after an invalid or oversized frame,
+ * the connection is aborted then.
+ */
+bool IpcConnection::readBinaryFrame()
+{
+    QIODevice *device = m_transport->device();
+
+    if (!m_binaryFrame) {
+        if (device->bytesAvailable() < IpcProtocol::HeaderSize)
+            return false;
+
+        char header[IpcProtocol::HeaderSize];
+        device->read(header, IpcProtocol::HeaderSize);
+        if (!IpcProtocol::readHeader(header, &m_frame)) {
+            qWarning() << "invalid frame header, closing connection";
+            m_transport->abort();
+            return false;
+        }
+        if (m_frame.length > m_maxContentSize) {
+            qWarning() << "content to large to be received. max size: " << m_maxContentSize;
+            m_transport->abort();
+            return false;
+        }
+        m_binaryFrame = true;
+    }
+
+    if (device->bytesAvailable() < m_frame.nameLength + qint64(m_frame.length))
+        return false;
+    m_binaryFrame = false;
+
+    QString method;
+    if (m_frame.nameLength > 0) {
+        method = QString::fromLatin1(device->read(m_frame.nameLength));
+        if (m_frame.methodId != 0)
+            m_methods.insert(m_frame.methodId, method);
+    } else {
+        method = m_methods.value(m_frame.methodId);
+    }
+    QByteArray content = device->read(m_frame.length);
+
+    if (m_sequence != 0 && m_frame.sequence != m_sequence + 1)
+        qWarning() << "frame sequence" << m_frame.sequence << "does not follow" << m_sequence;
+    m_sequence = m_frame.sequence;
+
+    if (method.isEmpty()) {
+        qWarning() << "unknown method id: " << m_frame.methodId;
+        return true;
+    }
+    if (m_frame.flags & IpcProtocol::SharedMemoryFlag) {
+        content = readShared(content);
+        if (content.isNull()) {
+            qWarning() << "invalid shared memory reference in" << method;
+            return true;
+        }
+    }
+    receive(method, content, m_frame.flags & IpcProtocol::CompressedFlag);
+    return true;
+}
+
+/**
+ * \brief Queues the call of \a method with \a content for delivery,
+ * decoding \a compressed content first
+ */
+void IpcConnection::receive(const QString &method, const QByteArray &content, bool compressed)
+{
+    if (method == QLatin1String("ipcHello()")) {
+        handleHello(content);
+        return;
+    }
+    if (method == QLatin1String("ipcSharedMemory()")) {
+        handleSharedMemory(content);
+        return;
+    }
+    if (method == QLatin1String("ipcSharedMemoryAttached()")) {
+        handleSharedMemoryAttached(content);
+        return;
+    }
+
+    Incoming incoming;
+    incoming.method = method;
+    incoming.decoding = compressed;
+    if (compressed)
+        incoming.decoded = QtConcurrent::run(&IpcConnection::decode, content, m_maxContentSize);
+    else
+        incoming.content = content;
+    m_incoming.enqueue(incoming);
+    deliver();
+}
+
+/**
+ * \brief Emits the received calls in order, as far as they are decoded
+ */
+void IpcConnection::deliver()
+{
+    while (!m_incoming.isEmpty()) {
+        Incoming &head = m_incoming.head();
+        if (head.decoding) {
+            if (!head.decoded.isFinished()) {
+                m_decoder->setFuture(head.decoded);
                 return;
-            } else {
-                QByteArray content;
-                content.resize(bufferSize);
-                if (m_socket->read(content.data(), bufferSize) != bufferSize) {
-                    qWarning() << "error reading content from stream";
-                }
-                QString method = m_headers.value("Method");
-                reset();
-                emit received(method, content);
+            }
+            head.content = head.decoded.result();
+            if (head.content.isNull()) {
+                qWarning() << "error decoding content of" << head.method;
+                m_incoming.dequeue();
+                continue;
             }
         }
+
+        const Incoming incoming = m_incoming.dequeue();
+        emit received(incoming.method, incoming.content);
     }
 }
 
+void IpcConnection::onDecoded()
+{
+    deliver();
+}
+
+QByteArray IpcConnection::decode(const QByteArray &content, qint64 maxSize)
+{
+    // qCompress() prefixes the expected size in big endian
+    if (content.size() < 4)
+        return QByteArray();
+    const quint32 size = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(content.constData()));
+    if (size > maxSize)
+        return QByteArray();
+
+    QByteArray data = qUncompress(content);
+    if (data.isNull() && size == 0)
+        data = QByteArray("");
+    return data;
+}
+
 /**
  * \brief Max bytes we are able to receive. Defaults to 10Mbytes.
  * Returns the max content size
@@ -154,7 +439,10 @@ void IpcConnection::reset()
     m_headers.clear();
 }
 
-QTcpSocket *IpcConnection::socket() const
+/**
+ * \brief Returns the transport read from
+ */
+IpcTransport *IpcConnection::transport() const
 {
-    return m_socket;
+    return m_transport;
 }
@@ -34,29 +34,66 @@
 
 #include <QtCore>
 #include <QtNetwork>
+#include <QtConcurrent>
+
+#include "ipcprotocol.h"
+
+class IpcTransport;
+class IpcSharedMemory;
 
 class IpcConnection : public QObject
 {
     Q_OBJECT
 public:
-    explicit IpcConnection(QTcpSocket* socket, QObject *parent = 0);
-    QTcpSocket* socket() const;
+    static const qint64 DefaultMaxContentSize = 10 * 1024 * 1024;
+
+    explicit IpcConnection(IpcTransport *transport, QObject *parent = 0);
+    ~IpcConnection();
+    IpcTransport *transport() const;
+
+    static QByteArray helloContent(bool local);
 private:
+    struct Incoming
+    {
+        QString method;
+        QByteArray content;
+        QFuture<QByteArray> decoded;
+        bool decoding;
+    };
+
     void setMaxContentSize(qint64 size);
     qint64 maxContentSize() const;
     void reset();
+    bool startsBinaryFrame() const;
+    bool readTextFrame();
+    bool readBinaryFrame();
+    void receive(const QString &method, const QByteArray &content, bool compressed);
+    void handleHello(const QByteArray &content);
+    void handleSharedMemory(const QByteArray &content);
+    void handleSharedMemoryAttached(const QByteArray &content);
+    QByteArray readShared(const QByteArray &reference);
+    void deliver();
+    static QByteArray decode(const QByteArray &content, qint64 maxSize);
 private Q_SLOTS:
     void close();
     void closeWithError();
     void readData();
+    void onDecoded();
 Q_SIGNALS:
     void connectionClosed();
     void error(const QString& message);
     void received(const QString& method, const QByteArray& content);
 private:
-    QTcpSocket *m_socket;
+    IpcTransport *m_transport;
+    IpcSharedMemory *m_sharedMemory;
     QHash<QString,QString> m_headers;
     bool m_headerComplete;
+    bool m_binaryFrame;
+    IpcProtocol::FrameHeader m_frame;
+    QHash<quint16, QString> m_methods;
+    quint32 m_sequence;
     qint64 m_maxContentSize;
+    QQueue<Incoming> m_incoming;
+    QFutureWatcher<QByteArray> *m_decoder;
 };
 
@@ -0,0 +1,116 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "ipcmethod.h"
+
+/*!
+ * \class IpcMethod
+ * \brief Declares a remote call with its argument types
+ * \inmodule ipc
+ *
+ * Each call is declared once with a numeric id and its normalized
+ * signature, which is what goes over the wire. pack() and unpack() encode
+ * the arguments with QDataStream, so both ends agree on them at compile
+ * time.
+ *
+ * \code
+ *  const IpcMethod<QString> echo(EchoId, "echo(QString)");
+ *  client->send(echo.signature(), echo.pack(QStringLiteral("Hello")));
+ * \endcode
+ *
+ * Calls whose content is not encoded with QDataStream take an
+ * IpcRawContent argument, which is passed through as is.
+ */
+
+/*!
+ * \fn QByteArray IpcMethod::pack(const Args &... args) const
+ * Returns the content of a call with the arguments \a args
+ */
+
+/*!
+ * \fn bool IpcMethod::unpack(const QByteArray &content, Args &... args) const
+ * Reads the arguments of a call from \a content into \a args, returns false
+ * if \a content is too short
+ */
+
+/*!
+ * \class IpcDispatcher
+ * \brief Dispatches received calls to handlers registered per IpcMethod
+ * \inmodule ipc
+ *
+ * The signature of a received call is looked up once to get its method id,
+ * the handlers are stored in a table indexed by it.
+ *
+ * \code
+ *  dispatcher.on(echo, [](const QString &message) { qDebug() << message; });
+ *  ...
+ *  dispatcher.dispatch(dispatcher.methodId(method), content);
+ * \endcode
+ */
+
+/*!
+ * \fn void IpcDispatcher::on(const IpcMethod<Args...> &method, Handler handler)
+ * Calls \a handler with the unpacked arguments whenever \a method is
+ * dispatched. An earlier handler of \a method is replaced.
+ */
+
+/*!
+ * Returns the id of the method registered with \a signature, -1 if there is
+ * none
+ */
+int IpcDispatcher::methodId(const QString &signature) const
+{
+    return m_ids.value(signature, -1);
+}
+
+/*!
+ * Calls the handler of the method with \a id with the arguments unpacked
+ * from \a content
+ *
+ * Returns false if no handler is registered or \a content does not hold the
+ * arguments.
+ */
+bool IpcDispatcher::dispatch(int id, const QByteArray &content) const
+{
+    if (id < 0 || id >= m_invokers.size() || !m_invokers.at(id))
+        return false;
+    return m_invokers.at(id)(content);
+}
+
+void IpcDispatcher::insert(int id, const QString &signature, const Invoker &invoker)
+{
+    Q_ASSERT(id >= 0);
+    if (id >= m_invokers.size())
+        m_invokers.resize(id + 1);
+    m_invokers[id] = invoker;
+    m_ids.insert(signature, id);
+}
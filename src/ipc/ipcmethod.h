@@ -0,0 +1,140 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore>
+
+#include <functional>
+#include <tuple>
+#include <type_traits>
+
+namespace IpcMethodPrivate {
+template <int... I> struct Indexes {};
+template <int N, int... I> struct MakeIndexes : MakeIndexes<N - 1, N - 1, I...> {};
+template <int... I> struct MakeIndexes<0, I...> { typedef Indexes<I...> Type; };
+}
+
+// Content passed through as is, for calls not using QDataStream encoding
+struct IpcRawContent
+{
+    QByteArray data;
+};
+
+inline QDataStream &operator<<(QDataStream &out, const IpcRawContent &content)
+{
+    out.writeRawData(content.data.constData(), content.data.size());
+    return out;
+}
+
+inline QDataStream &operator>>(QDataStream &in, IpcRawContent &content)
+{
+    content.data = in.device()->readAll();
+    return in;
+}
+
+template <typename... Args>
+class IpcMethod
+{
+public:
+    Q_DECL_CONSTEXPR IpcMethod(int id, const char *signature)
+        : m_id(id)
+        , m_signature(signature)
+    {
+    }
+
+    Q_DECL_CONSTEXPR int id() const { return m_id; }
+    Q_DECL_CONSTEXPR const char *signature() const { return m_signature; }
+
+    QByteArray pack(const Args &... args) const
+    {
+        QByteArray bytes;
+        QDataStream out(&bytes, QIODevice::WriteOnly);
+        int unused[] = { 0, ((out << args), 0)... };
+        Q_UNUSED(unused);
+        Q_UNUSED(out);
+        return bytes;
+    }
+
+    bool unpack(const QByteArray &content, Args &... args) const
+    {
+        QDataStream in(content);
+        int unused[] = { 0, ((in >> args), 0)... };
+        Q_UNUSED(unused);
+        return in.status() == QDataStream::Ok;
+    }
+
+private:
+    int m_id;
+    const char *m_signature;
+};
+
+class IpcDispatcher
+{
+public:
+    template <typename Handler, typename... Args>
+    void on(const IpcMethod<Args...> &method, Handler handler)
+    {
+        typedef typename IpcMethodPrivate::MakeIndexes<sizeof...(Args)>::Type Indexes;
+        insert(method.id(), QLatin1String(method.signature()), [method, handler](const QByteArray &content) {
+            std::tuple<typename std::decay<Args>::type...> args;
+            if (!unpack(method, content, args, Indexes()))
+                return false;
+            call(handler, args, Indexes());
+            return true;
+        });
+    }
+
+    int methodId(const QString &signature) const;
+    bool dispatch(int id, const QByteArray &content) const;
+
+private:
+    typedef std::function<bool(const QByteArray &)> Invoker;
+
+    void insert(int id, const QString &signature, const Invoker &invoker);
+
+    template <typename Tuple, typename... Args, int... I>
+    static bool unpack(const IpcMethod<Args...> &method, const QByteArray &content, Tuple &args,
+                       IpcMethodPrivate::Indexes<I...>)
+    {
+        return method.unpack(content, std::get<I>(args)...);
+    }
+
+    template <typename Handler, typename Tuple, int... I>
+    static void call(const Handler &handler, const Tuple &args, IpcMethodPrivate::Indexes<I...>)
+    {
+        handler(std::get<I>(args)...);
+    }
+
+    QHash<QString, int> m_ids;
+    QVector<Invoker> m_invokers;
+};
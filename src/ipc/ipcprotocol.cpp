@@ -0,0 +1,166 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "ipcprotocol.h"
+
+namespace {
+// The leading zero byte tells binary frames from text headers
+const quint16 FrameMagic = 0x0051;
+}
+
+/*!
+ * \class IpcProtocol
+ * \internal
+ * \brief Encodes the frames exchanged between IpcClient and IpcConnection
+ * \inmodule ipc
+ *
+ * Version 1 frames are text headers, one "Name:value" line each, ended by
+ * an empty line and followed by the content:
+ *
+ * \code
+ *  Method:echo(QString)
+ *  Content-Length:16
+ *
+ * \endcode
+ *
+ * Version 2 frames start with a fixed header of HeaderSize bytes, all
+ * numbers in big endian:
+ *
+ * \table
+ * \header \li Bytes \li Field
+ * \row \li 2 \li magic, 0x0051
+ * \row \li 1 \li version
+ * \row \li 1 \li flags, see Flag
+ * \row \li 2 \li method id
+ * \row \li 2 \li length of the method name following the header
+ * \row \li 4 \li length of the content following the method name
+ * \row \li 4 \li sequence number, counting from 1 per connection
+ * \endtable
+ *
+ * With SharedMemoryFlag set, the content is a reference into the
+ * IpcSharedMemory ring the sender announced with an "ipcSharedMemory()"
+ * call: the position of the actual content as 8 bytes and its length as 4
+ * bytes. Only peers accepting the "shm" encoding receive such frames.
+ *
+ * Method ids are assigned by the sender per connection. The first frame
+ * using an id carries the method name, later frames only the id.
+ *
+ * Peers announce the highest version they read in their "ipcHello()" call,
+ * until it arrives text frames are sent. Both versions are read at any time.
+ */
+
+/*!
+ * Returns true if a frame starting with \a firstByte is a binary frame
+ */
+bool IpcProtocol::isBinaryFrame(char firstByte)
+{
+    return firstByte == char(FrameMagic >> 8);
+}
+
+/*!
+ * Writes \a header to \a data, which has to hold HeaderSize bytes
+ */
+void IpcProtocol::writeHeader(const FrameHeader &header, char *data)
+{
+    uchar *out = reinterpret_cast<uchar *>(data);
+    qToBigEndian<quint16>(FrameMagic, out);
+    out[2] = header.version;
+    out[3] = header.flags;
+    qToBigEndian<quint16>(header.methodId, out + 4);
+    qToBigEndian<quint16>(header.nameLength, out + 6);
+    qToBigEndian<quint32>(header.length, out + 8);
+    qToBigEndian<quint32>(header.sequence, out + 12);
+}
+
+/*!
+ * Reads the header of HeaderSize bytes at \a data into \a header
+ *
+ * Returns false if \a data does not hold a frame header of a known version.
+ */
+bool IpcProtocol::readHeader(const char *data, FrameHeader *header)
+{
+    const uchar *in = reinterpret_cast<const uchar *>(data);
+    if (qFromBigEndian<quint16>(in) != FrameMagic || in[2] != BinaryVersion)
+        return false;
+
+    header->version = in[2];
+    header->flags = in[3];
+    header->methodId = qFromBigEndian<quint16>(in + 4);
+    header->nameLength = qFromBigEndian<quint16>(in + 6);
+    header->length = qFromBigEndian<quint32>(in + 8);
+    header->sequence = qFromBigEndian<quint32>(in + 12);
+    return true;
+}
+
+/*!
+ * Returns the content of a frame referencing \a length bytes at
+ * \a position of the shared memory ring
+ */
+QByteArray IpcProtocol::sharedMemoryReference(quint64 position, quint32 length)
+{
+    QByteArray content(SharedMemoryReferenceSize, Qt::Uninitialized);
+    uchar *out = reinterpret_cast<uchar *>(content.data());
+    qToBigEndian<quint64>(position, out);
+    qToBigEndian<quint32>(length, out + 8);
+    return content;
+}
+
+/*!
+ * Reads the shared memory reference in \a content into \a position and
+ * \a length
+ *
+ * Returns false if \a content is not a reference.
+ */
+bool IpcProtocol::readSharedMemoryReference(const QByteArray &content, quint64 *position, quint32 *length)
+{
+    if (content.size() != SharedMemoryReferenceSize)
+        return false;
+
+    const uchar *in = reinterpret_cast<const uchar *>(content.constData());
+    *position = qFromBigEndian<quint64>(in);
+    *length = qFromBigEndian<quint32>(in + 8);
+    return true;
+}
+
+/*!
+ * Returns the version 1 header for \a method with content of \a length
+ * bytes, \a compressed with zlib
+ */
+QByteArray IpcProtocol::textHeader(const QString &method, bool compressed, int length)
+{
+    QByteArray header = QString("Method:%1\n").arg(method).toLatin1();
+    if (compressed)
+        header += QString("Content-Encoding:zlib\n").toLatin1();
+    header += QString("Content-Length:%1\n").arg(length).toLatin1();
+    header += QString("\n").toLatin1();
+    return header;
+}
@@ -0,0 +1,74 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore>
+
+class IpcProtocol
+{
+public:
+    enum Version
+    {
+        TextVersion = 1,
+        BinaryVersion = 2,
+        CurrentVersion = BinaryVersion
+    };
+
+    enum Flag
+    {
+        NoFlags = 0x0,
+        CompressedFlag = 0x1,
+        SharedMemoryFlag = 0x2
+    };
+
+    struct FrameHeader
+    {
+        quint8 version = BinaryVersion;
+        quint8 flags = NoFlags;
+        quint16 methodId = 0;
+        quint16 nameLength = 0;
+        quint32 length = 0;
+        quint32 sequence = 0;
+    };
+
+    enum { HeaderSize = 16, SharedMemoryReferenceSize = 12 };
+
+    static bool isBinaryFrame(char firstByte);
+    static void writeHeader(const FrameHeader &header, char *data);
+    static bool readHeader(const char *data, FrameHeader *header);
+
+    static QByteArray sharedMemoryReference(quint64 position, quint32 length);
+    static bool readSharedMemoryReference(const QByteArray &content, quint64 *position, quint32 *length);
+
+    static QByteArray textHeader(const QString &method, bool compressed, int length);
+};
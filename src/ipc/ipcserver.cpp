@@ -32,6 +32,7 @@
 
 #include "ipcserver.h"
 #include "ipcconnection.h"
+#include "ipctransport.h"
 
 #ifdef QMLLIVE_IPC_DEBUG
 #define DEBUG qDebug()
@@ -64,6 +65,10 @@
  *   }
  * }
  * \endcode
+ *
+ * Next to the TCP port the server listens on a local socket, see
+ * IpcTransport::localServerName(). Clients on the same machine connect to
+ * it, which saves the TCP/IP stack on both ends.
  */
 
 /*!
@@ -72,8 +77,10 @@
 IpcServer::IpcServer(QObject *parent)
     : QObject(parent)
     , m_server(new QTcpServer(this))
+    , m_localServer(new QLocalServer(this))
 {
     connect(m_server, &QTcpServer::newConnection, this, &IpcServer::newConnection);
+    connect(m_localServer, &QLocalServer::newConnection, this, &IpcServer::newLocalConnection);
 }
 
 /*!
@@ -82,7 +89,14 @@ IpcServer::IpcServer(QObject *parent)
 void IpcServer::listen(int port)
 {
     DEBUG << "IpcServer::listen: " << port;
-    m_server->listen(QHostAddress::Any, port);
+    if (!m_server->listen(QHostAddress::Any, port))
+        return;
+
+    // The port is ours, so a local server of that name is a stale leftover
+    const QString name = IpcTransport::localServerName(port);
+    QLocalServer::removeServer(name);
+    if (!m_localServer->listen(name))
+        qWarning() << "Unable to listen on local socket" << name << ":" << m_localServer->errorString();
 }
 
 /*!
@@ -95,19 +109,45 @@ void IpcServer::newConnection()
         QTcpSocket *socket = m_server->nextPendingConnection();
         emit clientConnected(socket->peerAddress());
         emit clientConnected(socket);
-        IpcConnection *connection = new IpcConnection(socket, this);
-        connect(connection, &IpcConnection::connectionClosed, this, &IpcServer::onConnectionClosed);
-        connect(connection, &IpcConnection::received, this, &IpcServer::received);
+        addConnection(IpcTransport::forSocket(socket));
+    }
+}
+
+/*!
+ * \brief Creates a IpcConnection on incoming local connection
+ */
+void IpcServer::newLocalConnection()
+{
+    DEBUG << "IpcServer::newLocalConnection";
+    if (m_localServer->hasPendingConnections()) {
+        QLocalSocket *socket = m_localServer->nextPendingConnection();
+        emit clientConnected(QHostAddress(QHostAddress::LocalHost));
+        addConnection(IpcTransport::forSocket(socket));
     }
 }
 
+void IpcServer::addConnection(IpcTransport *transport)
+{
+    emit clientConnected(transport);
+    IpcConnection *connection = new IpcConnection(transport, this);
+    connect(connection, &IpcConnection::connectionClosed, this, &IpcServer::onConnectionClosed);
+    connect(connection, &IpcConnection::received, this, &IpcServer::received);
+    connect(connection, &IpcConnection::received, this,
+            [this, transport](const QString &method, const QByteArray &content) {
+        emit receivedFrom(transport, method, content);
+    });
+}
+
 
 void IpcServer::onConnectionClosed()
 {
     IpcConnection *connection = qobject_cast<IpcConnection*>(sender());
 
-    emit clientDisconnected(connection->socket()->peerAddress());
-    emit clientDisconnected(connection->socket());
+    IpcTransport *transport = connection->transport();
+    emit clientDisconnected(transport->peerAddress());
+    if (transport->tcpSocket())
+        emit clientDisconnected(transport->tcpSocket());
+    emit clientDisconnected(transport);
 
     if (connection->parent() == this)
         delete connection;
@@ -119,6 +159,7 @@ void IpcServer::onConnectionClosed()
 void IpcServer::setMaxConnections(int num)
 {
     m_server->setMaxPendingConnections(num);
+    m_localServer->setMaxPendingConnections(num);
 }
 
 
@@ -129,6 +170,14 @@ void IpcServer::setMaxConnections(int num)
  * A IPC call requesting \a method and using \a content a the parameters for the method
  */
 
+/*!
+ * \fn void IpcServer::receivedFrom(IpcTransport *transport, const QString& method, const QByteArray& content)
+ * \brief signals a IPC call has arrived from the client connected by \a transport
+ *
+ * Emitted after received() with the same \a method and \a content, for
+ * servers keeping state per client.
+ */
+
 /*!
  * \fn void IpcServer::clientConnected(const QHostAddress& address)
  *
@@ -139,12 +188,30 @@ void IpcServer::setMaxConnections(int num)
  * \fn void IpcServer::clientConnected(QTcpSocket *socket)
  *
  * * Called when a new client connection is established, providing the \a socket
+ *
+ * Only emitted for TCP connections.
+ */
+
+/*!
+ * \fn void IpcServer::clientConnected(IpcTransport *transport)
+ *
+ * Called when a new client connection is established, providing the
+ * \a transport. Emitted for TCP and local connections.
  */
 
 /*!
  * \fn void IpcServer::clientDisconnected(QTcpSocket *socket)
  *
  * * Called when an existing client connection is dropped, providing the \a socket
+ *
+ * Only emitted for TCP connections.
+ */
+
+/*!
+ * \fn void IpcServer::clientDisconnected(IpcTransport *transport)
+ *
+ * Called when an existing client connection is dropped, providing the
+ * \a transport
  */
 
 /*!
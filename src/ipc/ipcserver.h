@@ -35,6 +35,8 @@
 #include <QtCore>
 #include <QtNetwork>
 
+class IpcTransport;
+
 class IpcServer : public QObject
 {
     Q_OBJECT
@@ -44,17 +46,25 @@ public:
     void setMaxConnections(int num);
 private Q_SLOTS:
     void newConnection();
+    void newLocalConnection();
 Q_SIGNALS:
     void received(const QString& method, const QByteArray& content);
+    void receivedFrom(IpcTransport* transport, const QString& method, const QByteArray& content);
     void clientConnected(const QHostAddress& address);
     void clientConnected(QTcpSocket* socket);
+    void clientConnected(IpcTransport* transport);
     void clientDisconnected(QTcpSocket* socket);
+    void clientDisconnected(IpcTransport* transport);
     void clientDisconnected(const QHostAddress& address);
 
 private Q_SLOTS:
     void onConnectionClosed();
 
+private:
+    void addConnection(IpcTransport *transport);
+
 private:
     QTcpServer *m_server;
+    QLocalServer *m_localServer;
 };
 
@@ -0,0 +1,171 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "ipcsharedmemory.h"
+
+/*!
+ * \class IpcSharedMemory
+ * \internal
+ * \brief Ring buffer in shared memory carrying large content to a local peer
+ * \inmodule ipc
+ *
+ * Content written to a local socket is copied into the kernel and out of it
+ * again, in pieces. An IpcClient talking to a peer on the same machine
+ * writes large content into a ring it shares with the peer instead, and only
+ * sends a reference to it, see IpcProtocol::SharedMemoryFlag. The
+ * IpcConnection reading the frame copies the content out of the ring once.
+ *
+ * The ring is written by one IpcClient and read by one IpcConnection, in
+ * the order of the frames. Positions count all bytes ever written, the
+ * reader stores up to which position it has read in front of the ring, so
+ * the writer knows which space is free. Content never wraps around the end
+ * of the ring, the space left there is skipped.
+ *
+ * write() fails if the ring is full, the content is sent inline then.
+ */
+
+IpcSharedMemory::IpcSharedMemory()
+    : m_written(0)
+{
+}
+
+/*!
+ * Creates a ring of \a size bytes under a new unique key
+ *
+ * Returns false if the system does not provide the memory.
+ */
+bool IpcSharedMemory::create(int size)
+{
+    if (size <= HeaderSize)
+        return false;
+
+    m_memory.setKey(QStringLiteral("qmllive-ipc-%1").arg(QUuid::createUuid().toString()));
+    if (!m_memory.create(size))
+        return false;
+
+    header()->released = 0;
+    m_written = 0;
+    return true;
+}
+
+/*!
+ * Attaches to the ring created under \a key by the peer
+ */
+bool IpcSharedMemory::attach(const QString &key)
+{
+    if (m_memory.isAttached())
+        m_memory.detach();
+
+    m_memory.setKey(key);
+    return m_memory.attach() && m_memory.size() > HeaderSize;
+}
+
+/*!
+ * Returns the key the peer attaches to
+ */
+QString IpcSharedMemory::key() const
+{
+    return m_memory.key();
+}
+
+/*!
+ * Returns a description of the last error
+ */
+QString IpcSharedMemory::errorString() const
+{
+    return m_memory.errorString();
+}
+
+/*!
+ * Copies \a data into the ring and stores its \a position
+ *
+ * Returns false if there is not enough free space.
+ */
+bool IpcSharedMemory::write(const QByteArray &data, quint64 *position)
+{
+    const quint64 length = data.size();
+    if (!m_memory.isAttached() || length > capacity())
+        return false;
+
+    quint64 start = m_written;
+    const quint64 offset = start % capacity();
+    if (offset + length > capacity())
+        start += capacity() - offset;
+
+    if (!m_memory.lock())
+        return false;
+    const quint64 released = header()->released;
+    m_memory.unlock();
+
+    if (start + length - released > capacity())
+        return false;
+
+    memcpy(ring() + start % capacity(), data.constData(), length);
+    m_written = start + length;
+    *position = start;
+    return true;
+}
+
+/*!
+ * Returns a copy of the \a length bytes at \a position and releases the
+ * space up to their end
+ *
+ * Returns a null QByteArray if the content is not inside the ring.
+ */
+QByteArray IpcSharedMemory::read(quint64 position, quint32 length)
+{
+    if (!m_memory.isAttached() || position % capacity() + length > capacity())
+        return QByteArray();
+
+    const QByteArray data(ring() + position % capacity(), length);
+
+    if (m_memory.lock()) {
+        header()->released = position + length;
+        m_memory.unlock();
+    }
+    return data;
+}
+
+IpcSharedMemory::Header *IpcSharedMemory::header()
+{
+    return static_cast<Header *>(m_memory.data());
+}
+
+char *IpcSharedMemory::ring()
+{
+    return static_cast<char *>(m_memory.data()) + HeaderSize;
+}
+
+quint64 IpcSharedMemory::capacity() const
+{
+    return m_memory.size() - HeaderSize;
+}
@@ -0,0 +1,66 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore>
+
+class IpcSharedMemory
+{
+public:
+    IpcSharedMemory();
+
+    bool create(int size);
+    bool attach(const QString &key);
+    QString key() const;
+    QString errorString() const;
+
+    bool write(const QByteArray &data, quint64 *position);
+    QByteArray read(quint64 position, quint32 length);
+
+private:
+    struct Header
+    {
+        quint64 released;
+    };
+
+    enum { HeaderSize = 16 };
+
+    Header *header();
+    char *ring();
+    quint64 capacity() const;
+
+    QSharedMemory m_memory;
+    quint64 m_written;
+
+    Q_DISABLE_COPY(IpcSharedMemory)
+};
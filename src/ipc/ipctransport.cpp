@@ -0,0 +1,497 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "ipctransport.h"
+
+#ifdef QMLLIVE_IPC_DEBUG
+#define DEBUG qDebug()
+#else
+#define DEBUG if (0) qDebug()
+#endif
+
+/*!
+ * \class IpcTransport
+ * \brief Stream connecting an IpcClient or IpcConnection to its peer
+ * \inmodule ipc
+ *
+ * A transport is either a TCP socket or a local socket, a Unix domain socket
+ * or a named pipe depending on the platform. IpcClient, IpcConnection and
+ * IpcServer only use the transport, so the same frames are exchanged over
+ * both.
+ *
+ * connectToHost() picks the local socket when \e hostName names this
+ * machine and local transports are enabled. It connects to the server
+ * named localServerName() of the port, which IpcServer listens on next to
+ * the TCP port. If there is none, e.g. because the runtime is an older
+ * version or runs in a container, it falls back to TCP silently.
+ *
+ * Local socket states and errors are reported with their QAbstractSocket
+ * equivalents, which share their values.
+ *
+ * Peers connected to an IpcServer use the transport created for their
+ * socket, see forSocket().
+ */
+
+/*!
+ * \enum IpcTransport::Kind
+ *
+ * This enum type tells which socket carries the stream:
+ *
+ * \value TcpTransport
+ *        A QTcpSocket.
+ * \value LocalTransport
+ *        A QLocalSocket, the peer runs on the same machine.
+ */
+
+/*!
+ * \brief Constructs an unconnected transport with parent \a parent
+ */
+IpcTransport::IpcTransport(QObject *parent)
+    : QObject(parent)
+    , m_tcp(new QTcpSocket(this))
+    , m_local(0)
+    , m_device(m_tcp)
+    , m_localEnabled(true)
+    , m_fallbackPort(-1)
+    , m_peerVersion(0)
+{
+    watch(m_tcp);
+}
+
+IpcTransport::IpcTransport(QTcpSocket *socket, QLocalSocket *localSocket, QObject *parent)
+    : QObject(parent)
+    , m_tcp(socket)
+    , m_local(localSocket)
+    , m_device(socket ? static_cast<QIODevice *>(socket) : localSocket)
+    , m_localEnabled(false)
+    , m_fallbackPort(-1)
+    , m_peerVersion(0)
+{
+    if (m_tcp)
+        watch(m_tcp);
+    if (m_local)
+        watch(m_local);
+}
+
+/*!
+ * \brief Returns the transport of \a socket, creating it as a child of the
+ * socket the first time
+ *
+ * All users of a socket share the same transport, so e.g. what the peer
+ * announced is known to both the IpcConnection reading and the IpcClient
+ * writing it.
+ */
+IpcTransport *IpcTransport::forSocket(QTcpSocket *socket)
+{
+    IpcTransport *transport = socket->findChild<IpcTransport *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!transport)
+        transport = new IpcTransport(socket, 0, socket);
+    return transport;
+}
+
+/*!
+ * \overload
+ */
+IpcTransport *IpcTransport::forSocket(QLocalSocket *socket)
+{
+    IpcTransport *transport = socket->findChild<IpcTransport *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!transport)
+        transport = new IpcTransport(0, socket, socket);
+    return transport;
+}
+
+void IpcTransport::watch(QTcpSocket *socket)
+{
+    connect(socket, &QAbstractSocket::connected, this, [this, socket]() {
+        if (m_device == socket)
+            emit connected();
+    });
+    connect(socket, &QAbstractSocket::disconnected, this, [this, socket]() {
+        if (m_device == socket)
+            emit disconnected();
+    });
+    connect(socket, &QAbstractSocket::errorOccurred, this, [this, socket](QAbstractSocket::SocketError socketError) {
+        if (m_device == socket)
+            emit errorOccurred(socketError);
+    });
+    connect(socket, &QIODevice::readyRead, this, [this, socket]() {
+        if (m_device == socket)
+            emit readyRead();
+    });
+    connect(socket, &QIODevice::bytesWritten, this, [this, socket](qint64 bytes) {
+        if (m_device == socket)
+            emit bytesWritten(bytes);
+    });
+}
+
+void IpcTransport::watch(QLocalSocket *socket)
+{
+    connect(socket, &QLocalSocket::connected, this, [this, socket]() {
+        if (m_device != socket)
+            return;
+        m_fallbackPort = -1;
+        emit connected();
+    });
+    connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+        if (m_device == socket)
+            emit disconnected();
+    });
+    connect(socket, &QLocalSocket::errorOccurred, this, [this, socket](QLocalSocket::LocalSocketError socketError) {
+        if (m_device == socket)
+            onLocalError(socketError);
+    });
+    connect(socket, &QIODevice::readyRead, this, [this, socket]() {
+        if (m_device == socket)
+            emit readyRead();
+    });
+    connect(socket, &QIODevice::bytesWritten, this, [this, socket](qint64 bytes) {
+        if (m_device == socket)
+            emit bytesWritten(bytes);
+    });
+}
+
+void IpcTransport::onLocalError(QLocalSocket::LocalSocketError socketError)
+{
+    if (m_fallbackPort >= 0) {
+        DEBUG << "IpcTransport: no local server," << m_local->errorString() << ", using TCP";
+        const int port = m_fallbackPort;
+        m_fallbackPort = -1;
+        connectTcp(m_fallbackHost, port);
+        return;
+    }
+
+    emit errorOccurred(QAbstractSocket::SocketError(socketError));
+}
+
+/*!
+ * \brief Returns which socket carries the stream
+ */
+IpcTransport::Kind IpcTransport::kind() const
+{
+    return m_device == m_local ? LocalTransport : TcpTransport;
+}
+
+/*!
+ * \brief Returns the device frames are read from and written to
+ *
+ * The device may change with connectToHost().
+ */
+QIODevice *IpcTransport::device() const
+{
+    return m_device;
+}
+
+/*!
+ * \brief Returns the TCP socket of a TcpTransport, 0 otherwise
+ */
+QTcpSocket *IpcTransport::tcpSocket() const
+{
+    return m_device == m_tcp ? m_tcp : 0;
+}
+
+/*!
+ * \brief Returns the state of the socket in use
+ */
+QAbstractSocket::SocketState IpcTransport::state() const
+{
+    if (m_device == m_local)
+        return QAbstractSocket::SocketState(m_local->state());
+    return m_tcp->state();
+}
+
+/*!
+ * \brief Returns the address of the peer, the local host for local sockets
+ */
+QHostAddress IpcTransport::peerAddress() const
+{
+    if (m_device == m_local)
+        return QHostAddress(QHostAddress::LocalHost);
+    return m_tcp->peerAddress();
+}
+
+/*!
+ * \brief Returns a description of the last error of the socket in use
+ */
+QString IpcTransport::errorString() const
+{
+    return m_device->errorString();
+}
+
+/*!
+ * \brief Returns whether connectToHost() uses a local socket for hosts on
+ * this machine, true by default
+ */
+bool IpcTransport::isLocalTransportEnabled() const
+{
+    return m_localEnabled;
+}
+
+/*!
+ * \brief Sets whether connectToHost() uses a local socket for hosts on this
+ * machine to \a enabled
+ */
+void IpcTransport::setLocalTransportEnabled(bool enabled)
+{
+    m_localEnabled = enabled;
+}
+
+/*!
+ * \brief Returns the content encodings the peer accepts, as announced by its
+ * "ipcHello()" call
+ */
+QStringList IpcTransport::peerEncodings() const
+{
+    return m_peerEncodings;
+}
+
+/*!
+ * \brief Returns the highest frame version the peer reads, 0 if it did not
+ * announce any
+ */
+int IpcTransport::peerVersion() const
+{
+    return m_peerVersion;
+}
+
+/*!
+ * \brief Records that the peer accepts \a encodings and reads frames up to
+ * \a version
+ *
+ * The IpcConnection reading the transport calls this, so the IpcClient
+ * writing it knows what it may send.
+ */
+void IpcTransport::setPeer(const QStringList &encodings, int version)
+{
+    m_peerEncodings = encodings;
+    m_peerVersion = version;
+}
+
+/*!
+ * \brief Forgets what the peer accepts, e.g. before connecting again
+ */
+void IpcTransport::resetPeer()
+{
+    m_peerEncodings.clear();
+    m_peerVersion = 0;
+}
+
+/*!
+ * \brief Records whether this side attached to the shared memory ring
+ * \a key of the peer, \a ok tells if it succeeded
+ *
+ * The IpcConnection reading the transport calls this. The IpcClient writing
+ * it confirms the attach to the peer.
+ */
+void IpcTransport::setSharedMemoryAttached(const QString &key, bool ok)
+{
+    emit sharedMemoryAttached(key, ok);
+}
+
+/*!
+ * \brief Records whether the peer attached to the shared memory ring \a key
+ * of this side, \a ok tells if it succeeded
+ *
+ * The IpcConnection reading the transport calls this when the peer
+ * confirmed the attach. The IpcClient writing it only uses the ring after.
+ */
+void IpcTransport::setPeerSharedMemoryAttached(const QString &key, bool ok)
+{
+    emit peerSharedMemoryAttached(key, ok);
+}
+
+/*!
+ * \brief Connects to the IpcServer listening on \a port of \a hostName
+ *
+ * Servers on this machine are connected with a local socket if possible.
+ */
+void IpcTransport::connectToHost(const QString &hostName, int port)
+{
+    m_fallbackPort = -1;
+
+    if (!m_localEnabled || !isLocalHost(hostName)) {
+        connectTcp(hostName, port);
+        return;
+    }
+
+    if (!m_local) {
+        m_local = new QLocalSocket(this);
+        watch(m_local);
+    }
+    m_device = m_local;
+    m_fallbackHost = hostName;
+    m_fallbackPort = port;
+    DEBUG << "IpcTransport: connecting to" << localServerName(port);
+    m_local->connectToServer(localServerName(port));
+}
+
+void IpcTransport::connectTcp(const QString &hostName, int port)
+{
+    if (!m_tcp) {
+        m_tcp = new QTcpSocket(this);
+        watch(m_tcp);
+    }
+    m_device = m_tcp;
+    m_tcp->connectToHost(hostName, port);
+}
+
+/*!
+ * \brief Closes the connection after all data was written
+ */
+void IpcTransport::disconnectFromHost()
+{
+    if (m_device == m_local)
+        m_local->disconnectFromServer();
+    else
+        m_tcp->disconnectFromHost();
+}
+
+/*!
+ * \brief Closes the connection right away, discarding data not yet written
+ */
+void IpcTransport::abort()
+{
+    if (m_device == m_local)
+        m_local->abort();
+    else
+        m_tcp->abort();
+}
+
+/*!
+ * \brief Waits up to \a msecs milliseconds for the connection, including
+ * a fallback to TCP. Returns true once connected.
+ */
+bool IpcTransport::waitForConnected(int msecs)
+{
+    QElapsedTimer stopWatch;
+    stopWatch.start();
+
+    if (m_device == m_local) {
+        if (m_local->waitForConnected(msecs))
+            return true;
+        if (m_device == m_local)
+            return false;
+    }
+
+    const int remaining = msecs < 0 ? -1 : qMax<int>(0, msecs - stopWatch.elapsed());
+    return m_tcp->waitForConnected(remaining);
+}
+
+/*!
+ * \brief Waits up to \a msecs milliseconds for the connection to be closed
+ */
+bool IpcTransport::waitForDisconnected(int msecs)
+{
+    if (m_device == m_local)
+        return m_local->waitForDisconnected(msecs);
+    return m_tcp->waitForDisconnected(msecs);
+}
+
+/*!
+ * \brief Waits up to \a msecs milliseconds until data was written
+ */
+bool IpcTransport::waitForBytesWritten(int msecs)
+{
+    return m_device->waitForBytesWritten(msecs);
+}
+
+/*!
+ * \brief Returns the name of the local server listening next to TCP \a port
+ */
+QString IpcTransport::localServerName(int port)
+{
+    return QStringLiteral("qmllive-%1").arg(port);
+}
+
+/*!
+ * \brief Returns true if \a hostName names this machine
+ */
+bool IpcTransport::isLocalHost(const QString &hostName)
+{
+    if (hostName.compare(QLatin1String("localhost"), Qt::CaseInsensitive) == 0
+            || hostName.compare(QHostInfo::localHostName(), Qt::CaseInsensitive) == 0) {
+        return true;
+    }
+
+    const QHostAddress address(hostName);
+    if (address.isNull())
+        return false;
+    return address.isLoopback() || QNetworkInterface::allAddresses().contains(address);
+}
+
+/*!
+ * \fn void IpcTransport::connected()
+ *
+ * Emitted once the connection is established.
+ */
+
+/*!
+ * \fn void IpcTransport::disconnected()
+ *
+ * Emitted once the connection is closed.
+ */
+
+/*!
+ * \fn void IpcTransport::errorOccurred(QAbstractSocket::SocketError socketError)
+ *
+ * Emitted when the error \a socketError occurred. A failing local connection
+ * attempt falling back to TCP is not reported.
+ */
+
+/*!
+ * \fn void IpcTransport::readyRead()
+ *
+ * Emitted when data can be read from device().
+ */
+
+/*!
+ * \fn void IpcTransport::bytesWritten(qint64 bytes)
+ *
+ * Emitted when \a bytes were written by device().
+ */
+
+/*!
+ * \fn void IpcTransport::sharedMemoryAttached(const QString &key, bool ok)
+ *
+ * Emitted when this side tried to attach to the shared memory ring \a key of
+ * the peer, \a ok tells if it succeeded.
+ *
+ * \sa setSharedMemoryAttached()
+ */
+
+/*!
+ * \fn void IpcTransport::peerSharedMemoryAttached(const QString &key, bool ok)
+ *
+ * Emitted when the peer reported it tried to attach to the shared memory
+ * ring \a key of this side, \a ok tells if it succeeded.
+ *
+ * \sa setPeerSharedMemoryAttached()
+ */
@@ -0,0 +1,106 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore>
+#include <QtNetwork>
+
+class IpcTransport : public QObject
+{
+    Q_OBJECT
+public:
+    enum Kind
+    {
+        TcpTransport,
+        LocalTransport
+    };
+
+    explicit IpcTransport(QObject *parent = 0);
+    static IpcTransport *forSocket(QTcpSocket *socket);
+    static IpcTransport *forSocket(QLocalSocket *socket);
+
+    Kind kind() const;
+    QIODevice *device() const;
+    QTcpSocket *tcpSocket() const;
+    QAbstractSocket::SocketState state() const;
+    QHostAddress peerAddress() const;
+    QString errorString() const;
+
+    bool isLocalTransportEnabled() const;
+    void setLocalTransportEnabled(bool enabled);
+
+    QStringList peerEncodings() const;
+    int peerVersion() const;
+    void setPeer(const QStringList &encodings, int version);
+    void resetPeer();
+
+    void setSharedMemoryAttached(const QString &key, bool ok);
+    void setPeerSharedMemoryAttached(const QString &key, bool ok);
+
+    void connectToHost(const QString &hostName, int port);
+    void disconnectFromHost();
+    void abort();
+
+    bool waitForConnected(int msecs = 30000);
+    bool waitForDisconnected(int msecs = 30000);
+    bool waitForBytesWritten(int msecs = 30000);
+
+    static QString localServerName(int port);
+    static bool isLocalHost(const QString &hostName);
+
+Q_SIGNALS:
+    void connected();
+    void disconnected();
+    void errorOccurred(QAbstractSocket::SocketError socketError);
+    void readyRead();
+    void bytesWritten(qint64 bytes);
+    void sharedMemoryAttached(const QString &key, bool ok);
+    void peerSharedMemoryAttached(const QString &key, bool ok);
+
+private:
+    IpcTransport(QTcpSocket *socket, QLocalSocket *localSocket, QObject *parent);
+    void watch(QTcpSocket *socket);
+    void watch(QLocalSocket *socket);
+    void connectTcp(const QString &hostName, int port);
+    void onLocalError(QLocalSocket::LocalSocketError socketError);
+
+private:
+    QTcpSocket *m_tcp;
+    QLocalSocket *m_local;
+    QIODevice *m_device;
+    bool m_localEnabled;
+    QString m_fallbackHost;
+    int m_fallbackPort;
+    QStringList m_peerEncodings;
+    int m_peerVersion;
+};
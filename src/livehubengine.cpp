@@ -32,6 +32,37 @@
 
 #include "livehubengine.h"
 #include "watcher.h"
+#include "ignorematcher.h"
+#include "documentframecache.h"
+
+#include <QtConcurrent>
+
+namespace {
+
+// Changes younger than this may not have been reported by the watcher yet
+const qint64 BaselineMargin = 2000; // ms
+
+// Hashes files for the initial workspace state, skipping files modified
+// after the threshold. Their change may still be on its way and must not be
+// mistaken for the known state.
+struct BaselineHasher
+{
+    typedef QPair<QString, ContentHash> result_type;
+
+    explicit BaselineHasher(qint64 threshold) : threshold(threshold) {}
+
+    result_type operator()(const QString &path) const
+    {
+        const ContentHash hash = ContentHash::fromFile(path);
+        if (QFileInfo(path).lastModified().toMSecsSinceEpoch() >= threshold)
+            return result_type(path, ContentHash());
+        return result_type(path, hash);
+    }
+
+    qint64 threshold;
+};
+
+} // namespace
 
 #ifdef QMLLIVE_DEBUG
 #define DEBUG qDebug()
@@ -46,6 +77,17 @@
  *
  * The live hub watches over a workspace and notifies a live node about changed files. A
  * node can run on the same device or even on a remote device using a RemotePublisher.
+ *
+ * Files and directories matching the ignoreRules() are neither watched nor
+ * published.
+ *
+ * The hub remembers a snapshot of the modification time, size and inode of
+ * the entries of every workspace directory, so a changed directory is not
+ * published completely but only the files actually added, modified or removed.
+ * It also remembers a ContentHash of every file. Files which were touched
+ * without changing their contents are not published again, see
+ * changeStatistics(). Snapshots and hashes are taken on the global thread
+ * pool.
  */
 
 /*!
@@ -67,16 +109,49 @@ LiveHubEngine::LiveHubEngine(QObject *parent)
     : QObject(parent)
     , m_watcher(new Watcher(this))
     , m_filePublishingActive(false)
+    , m_subtreeWatcher(new QFutureWatcher<ScannedTree>(this))
+    , m_snapshotWatcher(new QFutureWatcher<ScannedTree>(this))
+    , m_publishWatcher(new QFutureWatcher<QStringList>(this))
+    , m_baselineThreshold(0)
+    , m_hashWatcher(new QFutureWatcher<HashedFile>(this))
+    , m_workspaceHashWatcher(new QFutureWatcher<HashedFile>(this))
+    , m_activationPending(false)
+    , m_documentsChanged(false)
+    , m_publishedChanges(0)
+    , m_suppressedChanges(0)
 {
     connect(m_watcher, &Watcher::directoriesChanged, this, &LiveHubEngine::directoriesChanged);
+    connect(m_watcher, &Watcher::filesChanged, this, &LiveHubEngine::filesChanged);
     connect(m_watcher, &Watcher::errorChanged, this, &LiveHubEngine::watcherErrorChanged);
+    connect(m_watcher, &Watcher::scanProgress, this, &LiveHubEngine::watchingProgress);
+    connect(m_watcher, &Watcher::ready, this, &LiveHubEngine::watchingReady);
+    connect(m_watcher, &Watcher::ready, this, &LiveHubEngine::hashWorkspace);
+    connect(m_hashWatcher, &QFutureWatcherBase::finished, this, &LiveHubEngine::onHashesReady);
+    connect(m_subtreeWatcher, &QFutureWatcherBase::finished, this, &LiveHubEngine::onSubtreesReady);
+    connect(m_snapshotWatcher, &QFutureWatcherBase::finished, this, &LiveHubEngine::onWorkspaceSnapshotsReady);
+    connect(m_workspaceHashWatcher, &QFutureWatcherBase::finished, this, &LiveHubEngine::onWorkspaceHashesReady);
+    connect(m_publishWatcher, &QFutureWatcherBase::finished, this, &LiveHubEngine::onPublishFilesReady);
+
+    m_watcher->setIgnoreMatcher(IgnoreMatcher(IgnoreMatcher::defaultRules()));
 }
 
 /*!
  * Sets the workspace folder to watch over to \a path
+ *
+ * The workspace is scanned for directories to watch in background. Changes
+ * may be missed until watchingReady() is emitted.
  */
 void LiveHubEngine::setWorkspace(const QString &path)
 {
+    m_subtreeWatcher->cancel();
+    m_snapshotWatcher->cancel();
+    m_workspaceHashWatcher->cancel();
+    m_publishWatcher->cancel();
+    m_snapshots.clear();
+    m_subtrees.clear();
+    m_hashes.clear();
+    m_hashCandidates.clear();
+    m_hashedMeanwhile.clear();
     m_watcher->setDirectory(path);
 
     emit workspaceChanged(path);
@@ -108,6 +183,16 @@ LiveDocument LiveHubEngine::activePath() const
     return m_activePath;
 }
 
+/*!
+ * Returns true when all directories of the workspace are watched for changes
+ *
+ * \sa watchingReady()
+ */
+bool LiveHubEngine::isWatchingReady() const
+{
+    return m_watcher->isReady();
+}
+
 /*!
  * Returns true if error() is not NoError
  */
@@ -124,6 +209,76 @@ LiveHubEngine::Error LiveHubEngine::error()
     return m_error;
 }
 
+/*!
+ * Returns the rules deciding which files and directories are ignored
+ *
+ * \sa setIgnoreRules()
+ */
+QStringList LiveHubEngine::ignoreRules() const
+{
+    return m_watcher->ignoreMatcher().rules();
+}
+
+/*!
+ * Sets the rules deciding which files and directories are neither watched
+ * nor published to \a rules
+ *
+ * The rules use the \c .gitignore syntax, e.g. \c build/, \c *.swp or
+ * \c !keep.qml. By default version control directories, editor swap files
+ * and QML caches are ignored. Changed rules take effect with the next
+ * setWorkspace() call.
+ */
+void LiveHubEngine::setIgnoreRules(const QStringList &rules)
+{
+    m_watcher->setIgnoreMatcher(IgnoreMatcher(rules));
+}
+
+/*!
+ * Controls how file system events are coalesced before changes are published.
+ *
+ * Changes are published once no further event arrived for \a quietPeriod
+ * milliseconds, but never later than \a maximumLatency milliseconds after the
+ * first event.
+ */
+void LiveHubEngine::setChangeLatency(int quietPeriod, int maximumLatency)
+{
+    m_watcher->setQuietPeriod(quietPeriod);
+    m_watcher->setMaximumLatency(maximumLatency);
+}
+
+/*!
+ * Returns counters about coalesced file system events: the number of
+ * \c bursts published, the \c events coalesced into them, the
+ * \c largestBurst and the \c averageDelay and \c maximumDelay in
+ * milliseconds added before publishing.
+ *
+ * \c publishedChanges counts the changed files published and
+ * \c suppressedChanges the files which were touched but whose contents did
+ * not change.
+ *
+ * When the watch limit was reached, \c polledDirectories tells how many
+ * directories are polled instead, \c pollCost the average nanoseconds spent
+ * per poll and \c pollCycle the milliseconds a full round took.
+ */
+QVariantMap LiveHubEngine::changeStatistics() const
+{
+    const Watcher::Statistics statistics = m_watcher->statistics();
+
+    QVariantMap map;
+    map.insert(QStringLiteral("bursts"), statistics.bursts);
+    map.insert(QStringLiteral("events"), statistics.events);
+    map.insert(QStringLiteral("largestBurst"), statistics.largestBurst);
+    map.insert(QStringLiteral("averageDelay"),
+               statistics.bursts ? statistics.totalDelay / statistics.bursts : 0);
+    map.insert(QStringLiteral("maximumDelay"), statistics.maximumDelay);
+    map.insert(QStringLiteral("publishedChanges"), m_publishedChanges);
+    map.insert(QStringLiteral("suppressedChanges"), m_suppressedChanges);
+    map.insert(QStringLiteral("polledDirectories"), statistics.polledDirectories);
+    map.insert(QStringLiteral("pollCost"), statistics.pollCost);
+    map.insert(QStringLiteral("pollCycle"), statistics.pollCycle);
+    return map;
+}
+
 /*!
  * Returns the maximum number of watched directories
  */
@@ -142,17 +297,355 @@ void LiveHubEngine::setMaximumWatches(int maximumWatches)
 
 /*!
  * Handles watcher changes signals.
+ *
+ * Each changed directory is compared with the snapshot taken before, only
+ * files which were added, modified or removed are considered. Changed files
+ * are hashed on the thread pool first, only those whose contents changed are
+ * published by onHashesReady().
  */
 void LiveHubEngine::directoriesChanged(const QStringList &changes)
 {
     DEBUG << "LiveHubEngine::workspaceChanged: " << changes;
-    if (m_filePublishingActive) {
-        foreach (const QString& change, changes) {
-            publishDirectory(change, true);
+    if (!m_filePublishingActive) {
+        emit activateDocument(m_activePath);
+        return;
+    }
+
+    foreach (const QString& change, changes) {
+        journalDirectory(change);
+    }
+
+    m_activationPending = true;
+    scanSubtrees();
+    hashChanges();
+}
+
+/*!
+ * Handles watcher signals about individual \a changed and \a removed files.
+ *
+ * These are followed by a directoriesChanged() call concluding the change set.
+ */
+void LiveHubEngine::filesChanged(const QStringList &changed, const QStringList &removed)
+{
+    DEBUG << "LiveHubEngine::filesChanged: " << changed << "removed: " << removed;
+    if (!m_filePublishingActive)
+        return;
+
+    foreach (const QString &path, removed) {
+        DocumentFrameCache::invalidate(path);
+        const int slash = path.lastIndexOf(QLatin1Char('/'));
+        const QString name = path.mid(slash + 1);
+        // Skip short lived files which were never published, e.g. temporary
+        // files of editors saving atomically
+        bool known = m_hashes.contains(path);
+        auto snapshot = m_snapshots.find(path.left(slash));
+        if (snapshot != m_snapshots.end()) {
+            known = known || snapshot->contains(name);
+            snapshot->removeEntry(name);
+        } else {
+            // Not journaled yet, better be safe
+            known = true;
         }
+        if (known)
+            removeFile(path);
     }
 
-    emit activateDocument(m_activePath);
+    foreach (const QString &path, changed) {
+        DocumentFrameCache::invalidate(path);
+        if (!QFileInfo(path).isFile())
+            continue;
+        m_hashCandidates.insert(path);
+    }
+}
+
+/*!
+ * Compares the directory \a path with its last snapshot and collects the
+ * added and modified files for hashing. Removed files and directories are
+ * reported with fileRemoved().
+ *
+ * Directories without a snapshot, e.g. new ones, are taken completely,
+ * including their sub directories, on the thread pool by scanSubtrees().
+ */
+void LiveHubEngine::journalDirectory(const QString &path)
+{
+    if (isIgnored(path, true))
+        return;
+
+    // A new tree may be large, e.g. when unpacked or moved in
+    if (!m_snapshots.contains(path)) {
+        m_subtrees.insert(path);
+        return;
+    }
+
+    const DirectorySnapshot snapshot = DirectorySnapshot::take(path);
+    if (!snapshot.exists()) {
+        removeTree(path);
+        return;
+    }
+
+    const QString prefix = path + QLatin1Char('/');
+    auto known = m_snapshots.find(path);
+    const DirectorySnapshot::Changes changes = known->diff(snapshot);
+    *known = snapshot;
+
+    foreach (const QString &file, changes.changedFiles) {
+        DocumentFrameCache::invalidate(file);
+        if (!isIgnored(file, false))
+            m_hashCandidates.insert(file);
+    }
+    foreach (const QString &file, changes.removedFiles)
+        removeFile(file);
+    foreach (const QString &dir, changes.removedDirectories)
+        removeTree(dir);
+    foreach (const QString &dir, changes.createdDirectories) {
+        const QString name = dir.mid(prefix.length());
+        if (!snapshot.entry(name).isLink)
+            journalDirectory(dir);
+    }
+}
+
+/*!
+ * Forgets the file \a path and reports its removal
+ */
+void LiveHubEngine::removeFile(const QString &path)
+{
+    if (isIgnored(path, false))
+        return;
+
+    m_hashes.remove(path);
+    m_hashCandidates.remove(path);
+    DocumentFrameCache::invalidate(path);
+    m_documentsChanged = true;
+    emit fileRemoved(LiveDocument::resolve(m_watcher->directory(), path));
+}
+
+/*!
+ * Forgets the removed directory \a path and everything below it, reporting
+ * the removal of every file known in there
+ */
+void LiveHubEngine::removeTree(const QString &path)
+{
+    const QString prefix = path + QLatin1Char('/');
+    QSet<QString> files;
+    for (auto it = m_snapshots.begin(); it != m_snapshots.end();) {
+        if (it.key() != path && !it.key().startsWith(prefix)) {
+            ++it;
+            continue;
+        }
+        const QString dirPrefix = it.key() + QLatin1Char('/');
+        foreach (const QString &name, it->fileNames())
+            files.insert(dirPrefix + name);
+        it = m_snapshots.erase(it);
+    }
+    for (auto it = m_hashes.constBegin(); it != m_hashes.constEnd(); ++it) {
+        if (it.key().startsWith(prefix))
+            files.insert(it.key());
+    }
+
+    foreach (const QString &file, files)
+        removeFile(file);
+}
+
+/*!
+ * Starts taking the snapshots of the directories journaled without a
+ * snapshot, unless a scan is in progress already. In that case they are
+ * picked up once it finished.
+ */
+void LiveHubEngine::scanSubtrees()
+{
+    if (m_subtreeWatcher->isRunning() || m_subtrees.isEmpty())
+        return;
+
+    const QStringList paths = m_subtrees.values();
+    m_subtrees.clear();
+    m_subtreeWatcher->setFuture(QtConcurrent::mapped(paths, TreeScanner(m_watcher->directory(),
+                                                                        m_watcher->ignoreMatcher())));
+}
+
+/*!
+ * Remembers the snapshots of the new directories and collects their files
+ * for hashing
+ */
+void LiveHubEngine::onSubtreesReady()
+{
+    const QString prefix = m_watcher->directory() + QLatin1Char('/');
+    if (!m_subtreeWatcher->isCanceled()) {
+        const QList<ScannedTree> trees = m_subtreeWatcher->future().results();
+        foreach (const ScannedTree &tree, trees) {
+            const DirectorySnapshot &root = tree.first().snapshot;
+            // Results of a previous workspace
+            if (!root.path().startsWith(prefix))
+                continue;
+            if (!root.exists()) {
+                removeTree(root.path());
+                continue;
+            }
+
+            foreach (const ScannedDirectory &directory, tree) {
+                // Journaled meanwhile or gone before it was scanned
+                if (!directory.snapshot.exists() || m_snapshots.contains(directory.snapshot.path()))
+                    continue;
+                m_snapshots.insert(directory.snapshot.path(), directory.snapshot);
+                foreach (const QString &file, directory.files)
+                    m_hashCandidates.insert(file);
+            }
+        }
+    }
+
+    // Continue with directories collected meanwhile
+    scanSubtrees();
+    hashChanges();
+}
+
+/*!
+ * Starts hashing the files collected as changed, unless hashing is in
+ * progress already. In that case they are picked up once it finished.
+ */
+void LiveHubEngine::hashChanges()
+{
+    if (m_hashWatcher->isRunning())
+        return;
+
+    if (m_hashCandidates.isEmpty()) {
+        // New directories are still being scanned
+        if (!m_subtreeWatcher->isRunning())
+            finishChanges();
+        return;
+    }
+
+    const QStringList paths = m_hashCandidates.values();
+    m_hashCandidates.clear();
+    // The workspace hashes may have been read before these changes
+    if (m_workspaceHashWatcher->isRunning()) {
+        foreach (const QString &path, paths)
+            m_hashedMeanwhile.insert(path);
+    }
+    m_hashWatcher->setFuture(QtConcurrent::mapped(paths, &LiveHubEngine::hashFile));
+}
+
+/*!
+ * Publishes the files whose contents changed, touched files which did not
+ * change are suppressed
+ */
+void LiveHubEngine::onHashesReady()
+{
+    const QString prefix = m_watcher->directory() + QLatin1Char('/');
+    if (!m_hashWatcher->isCanceled()) {
+        const QList<HashedFile> results = m_hashWatcher->future().results();
+        foreach (const HashedFile &file, results) {
+            // Results of a previous workspace
+            if (!file.first.startsWith(prefix))
+                continue;
+
+            if (file.second.isNull()) {
+                // Gone or unreadable meanwhile, the removal is reported by the watcher
+                m_hashes.remove(file.first);
+                continue;
+            }
+
+            auto known = m_hashes.find(file.first);
+            if (known != m_hashes.end() && *known == file.second) {
+                ++m_suppressedChanges;
+                continue;
+            }
+
+            m_hashes.insert(file.first, file.second);
+            ++m_publishedChanges;
+            m_documentsChanged = true;
+            emit fileChanged(LiveDocument::resolve(m_watcher->directory(), file.first));
+        }
+    }
+
+    // Continue with changes collected meanwhile
+    hashChanges();
+}
+
+/*!
+ * Activates the active document once all changes are published, unless
+ * nothing changed at all
+ */
+void LiveHubEngine::finishChanges()
+{
+    if (m_activationPending && m_documentsChanged)
+        emit activateDocument(m_activePath);
+    m_activationPending = false;
+    m_documentsChanged = false;
+}
+
+/*!
+ * Takes snapshots of all directories and hashes all files of the workspace
+ * in background, so changes can be told apart from just touching a file
+ */
+void LiveHubEngine::hashWorkspace()
+{
+    if (!m_filePublishingActive)
+        return;
+
+    m_snapshotWatcher->cancel();
+    m_workspaceHashWatcher->cancel();
+    m_hashedMeanwhile.clear();
+    // Changes shortly before may still be on their way through the watcher
+    m_baselineThreshold = QDateTime::currentMSecsSinceEpoch() - BaselineMargin;
+    const QString root = m_watcher->directory();
+    m_snapshotWatcher->setFuture(QtConcurrent::run(TreeScanner(root, m_watcher->ignoreMatcher()), root));
+}
+
+void LiveHubEngine::onWorkspaceSnapshotsReady()
+{
+    if (m_snapshotWatcher->isCanceled())
+        return;
+
+    const QString root = m_watcher->directory();
+    const qint64 threshold = m_baselineThreshold * 1000000;
+    QStringList files;
+    const ScannedTree tree = m_snapshotWatcher->result();
+    foreach (const ScannedDirectory &directory, tree) {
+        const DirectorySnapshot &snapshot = directory.snapshot;
+        if (!snapshot.exists() || !snapshot.path().startsWith(root))
+            continue;
+        // Already journaled by a change meanwhile
+        if (m_snapshots.contains(snapshot.path()))
+            continue;
+
+        bool recent = false;
+        foreach (const QString &name, snapshot.fileNames()) {
+            if (snapshot.entry(name).mtime >= threshold)
+                recent = true;
+        }
+        const int prefixLength = snapshot.path().length() + 1;
+        foreach (const QString &file, directory.files) {
+            if (snapshot.entry(file.mid(prefixLength)).mtime < threshold)
+                files.append(file);
+        }
+        // A recent change may not have been reported yet, it must not be
+        // mistaken for the known state
+        if (!recent)
+            m_snapshots.insert(snapshot.path(), snapshot);
+    }
+
+    m_workspaceHashWatcher->setFuture(QtConcurrent::mapped(files, BaselineHasher(m_baselineThreshold)));
+}
+
+void LiveHubEngine::onWorkspaceHashesReady()
+{
+    if (m_workspaceHashWatcher->isCanceled())
+        return;
+
+    const QString prefix = m_watcher->directory() + QLatin1Char('/');
+    const QList<HashedFile> results = m_workspaceHashWatcher->future().results();
+    foreach (const HashedFile &file, results) {
+        if (file.second.isNull() || !file.first.startsWith(prefix))
+            continue;
+        if (m_hashedMeanwhile.contains(file.first) || m_hashes.contains(file.first))
+            continue;
+        m_hashes.insert(file.first, file.second);
+    }
+    m_hashedMeanwhile.clear();
+}
+
+LiveHubEngine::HashedFile LiveHubEngine::hashFile(const QString &path)
+{
+    return HashedFile(path, ContentHash::fromFile(path));
 }
 
 /*!
@@ -182,33 +675,110 @@ void LiveHubEngine::watcherErrorChanged()
 
 /*!
  * Publish the whole workspace to a connected node.
+ *
+ * The workspace is listed on the thread pool, beginPublishWorkspace(), the
+ * publishFile() signals and endPublishWorkspace() follow once the listing is
+ * complete. Requests while a listing is pending are served by that listing.
  */
 void LiveHubEngine::publishWorkspace()
 {
     if (!m_filePublishingActive) { return; }
+    if (m_publishWatcher->isRunning())
+        return;
+    m_publishWatcher->setFuture(workspaceFiles());
+}
+
+void LiveHubEngine::onPublishFilesReady()
+{
+    if (m_publishWatcher->isCanceled())
+        return;
+
+    const QStringList files = m_publishWatcher->result();
     emit beginPublishWorkspace();
-    QDirIterator iter(m_watcher->directory(), QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
-    publishDirectory(m_watcher->directory(), false);
-    while (iter.hasNext()) {
-        publishDirectory(iter.next(), false);
-    }
+    foreach (const QString &path, files)
+        emit publishFile(LiveDocument::resolve(m_watcher->directory(), path));
     emit endPublishWorkspace();
 }
 
 /*!
- * Publish the directory \a dirPath to a connected node.
+ * Lists the absolute paths of all files in the workspace which are not
+ * ignored
+ *
+ * The workspace is walked on the thread pool, the returned future provides
+ * the list once complete.
  */
-void LiveHubEngine::publishDirectory(const QString& dirPath, bool fileChange)
+QFuture<QStringList> LiveHubEngine::workspaceFiles() const
 {
-    if (!m_filePublishingActive) { return; }
-    QDirIterator iter(dirPath, QDir::Files);
-    while (iter.hasNext()) {
-        LiveDocument document = LiveDocument::resolve(m_watcher->directory(), iter.next());
-        if (fileChange)
-            emit fileChanged(document);
-        else
-            emit publishFile(document);
+    const QString root = m_watcher->directory();
+    return QtConcurrent::run(&LiveHubEngine::listFiles, TreeScanner(root, m_watcher->ignoreMatcher()));
+}
+
+/*!
+ * Returns the last published content hash of the file at absolute \a path
+ *
+ * The hash is null when the file has not been hashed yet, e.g. before the
+ * workspace baseline is complete.
+ */
+ContentHash LiveHubEngine::contentHash(const QString &path) const
+{
+    return m_hashes.value(path);
+}
+
+LiveHubEngine::TreeScanner::TreeScanner(const QString &root, const IgnoreMatcher &ignore)
+    : root(root)
+    , ignore(ignore)
+{
+}
+
+// Takes snapshots of the directory at path and all directories below it
+// which are not ignored, collecting the files which are not ignored. Runs on
+// the thread pool, the first snapshot is always the one of path.
+LiveHubEngine::ScannedTree LiveHubEngine::TreeScanner::operator()(const QString &path) const
+{
+    ScannedTree tree;
+    QStack<QString> pending;
+    pending.push(path);
+    while (!pending.isEmpty()) {
+        ScannedDirectory directory;
+        directory.snapshot = DirectorySnapshot::take(pending.pop());
+        const DirectorySnapshot &snapshot = directory.snapshot;
+        const QString prefix = snapshot.path() + QLatin1Char('/');
+        foreach (const QString &name, snapshot.fileNames()) {
+            if (!isIgnored(ignore, root, prefix + name, false))
+                directory.files.append(prefix + name);
+        }
+        foreach (const QString &name, snapshot.directoryNames()) {
+            if (!snapshot.entry(name).isLink && !isIgnored(ignore, root, prefix + name, true))
+                pending.push(prefix + name);
+        }
+        tree.append(directory);
     }
+    return tree;
+}
+
+// Collects the files of the whole tree below the root of scanner. Runs on the
+// thread pool.
+QStringList LiveHubEngine::listFiles(const TreeScanner &scanner)
+{
+    QStringList files;
+    foreach (const ScannedDirectory &directory, scanner(scanner.root))
+        files.append(directory.files);
+    return files;
+}
+
+/*!
+ * Returns true if \a path is excluded by the ignoreRules()
+ */
+bool LiveHubEngine::isIgnored(const QString &path, bool isDir) const
+{
+    return isIgnored(m_watcher->ignoreMatcher(), m_watcher->directory(), path, isDir);
+}
+
+bool LiveHubEngine::isIgnored(const IgnoreMatcher &ignore, const QString &root, const QString &path, bool isDir)
+{
+    if (ignore.isEmpty() || path.length() <= root.length() || !path.startsWith(root))
+        return false;
+    return ignore.matches(path.mid(root.length() + 1), isDir);
 }
 
 /*!
@@ -222,15 +792,15 @@ void LiveHubEngine::setFilePublishingActive(bool on)
 /*!
  * \fn void LiveHubEngine::beginPublishWorkspace()
  *
- * This signal is emitted at the beginning of \l publishWorkspace() call before
- * any \l publishFile signal is emitted.
+ * This signal is emitted when the workspace listed by \l publishWorkspace()
+ * is about to be published, before any \l publishFile signal is emitted.
  */
 
 /*!
  * \fn void LiveHubEngine::endPublishWorkspace()
  *
- * This signal is emitted at the end of \l publishWorkspace() call after
- * all \l publishFile signals were emitted.
+ * This signal is emitted at the end of publishing the workspace listed by
+ * \l publishWorkspace() after all \l publishFile signals were emitted.
  */
 
 /*!
@@ -244,7 +814,15 @@ void LiveHubEngine::setFilePublishingActive(bool on)
  * \fn void LiveHubEngine::fileChanged(const LiveDocument& document)
  *
  * This signal is emitted during publishing a directory to inform a connected
- * node that \a document has changed on the hub.
+ * node that \a document has changed on the hub. Files which were touched
+ * without changing their contents are not reported.
+ */
+
+/*!
+ * \fn void LiveHubEngine::fileRemoved(const LiveDocument& document)
+ *
+ * This signal is emitted to inform a connected node that \a document was
+ * removed from the workspace on the hub.
  */
 
 /*!
@@ -257,6 +835,18 @@ void LiveHubEngine::setFilePublishingActive(bool on)
  * The signal is emitted when the workspace identified by \a workspace has changed
  */
 
+/*!
+ * \fn void LiveHubEngine::watchingProgress(int directories)
+ * The signal is emitted while the workspace is scanned, \a directories is the
+ * number of directories watched so far
+ */
+
+/*!
+ * \fn void LiveHubEngine::watchingReady()
+ * The signal is emitted when the workspace scan started by setWorkspace()
+ * finished and all directories are watched for changes
+ */
+
 /*!
  * \fn void LiveHubEngine::errorChanged()
  * The signal is emitted when the error state desctibed by error() changed
@@ -35,6 +35,9 @@
 #include <QtCore>
 
 #include "livedocument.h"
+#include "contenthash.h"
+#include "directorysnapshot.h"
+#include "ignorematcher.h"
 #include "qmllive_global.h"
 
 class Watcher;
@@ -56,9 +59,20 @@ public:
 
     LiveDocument activePath() const;
 
+    bool isWatchingReady() const;
+
     bool hasError();
     Error error();
 
+    QStringList ignoreRules() const;
+    void setIgnoreRules(const QStringList &rules);
+
+    void setChangeLatency(int quietPeriod, int maximumLatency);
+    QVariantMap changeStatistics() const;
+
+    QFuture<QStringList> workspaceFiles() const;
+    ContentHash contentHash(const QString &path) const;
+
     static int maximumWatches();
     static void setMaximumWatches(int maximumWatches);
 public Q_SLOTS:
@@ -70,18 +84,73 @@ Q_SIGNALS:
     void endPublishWorkspace();
     void publishFile(const LiveDocument& document);
     void fileChanged(const LiveDocument& document);
+    void fileRemoved(const LiveDocument& document);
     void activateDocument(const LiveDocument& document);
     void workspaceChanged(const QString& workspace);
+    void watchingProgress(int directories);
+    void watchingReady();
     void errorChanged();
 private Q_SLOTS:
     void directoriesChanged(const QStringList& changes);
+    void filesChanged(const QStringList &changed, const QStringList &removed);
     void watcherErrorChanged();
+    void hashWorkspace();
+    void onHashesReady();
+    void onWorkspaceSnapshotsReady();
+    void onWorkspaceHashesReady();
+    void onSubtreesReady();
+    void onPublishFilesReady();
 private:
-    void publishDirectory(const QString& dirPath, bool fileChange);
+    typedef QPair<QString, ContentHash> HashedFile;
+
+    struct ScannedDirectory
+    {
+        DirectorySnapshot snapshot;
+        QStringList files;
+    };
+    typedef QList<ScannedDirectory> ScannedTree;
+
+    struct TreeScanner
+    {
+        typedef ScannedTree result_type;
+
+        TreeScanner(const QString &root, const IgnoreMatcher &ignore);
+        ScannedTree operator()(const QString &path) const;
+
+        QString root;
+        IgnoreMatcher ignore;
+    };
+
+    static QStringList listFiles(const TreeScanner &scanner);
+
+    bool isIgnored(const QString &path, bool isDir) const;
+    static bool isIgnored(const IgnoreMatcher &ignore, const QString &root, const QString &path, bool isDir);
+    void journalDirectory(const QString &path);
+    void removeFile(const QString &path);
+    void removeTree(const QString &path);
+    void scanSubtrees();
+    void hashChanges();
+    void finishChanges();
+    static HashedFile hashFile(const QString &path);
 private:
     Watcher *m_watcher;
     bool m_filePublishingActive;
     LiveDocument m_activePath;
+    QHash<QString, DirectorySnapshot> m_snapshots;
+    QSet<QString> m_subtrees;
+    QFutureWatcher<ScannedTree> *m_subtreeWatcher;
+    QFutureWatcher<ScannedTree> *m_snapshotWatcher;
+    QFutureWatcher<QStringList> *m_publishWatcher;
+    qint64 m_baselineThreshold;
+    QHash<QString, ContentHash> m_hashes;
+    QSet<QString> m_hashCandidates;
+    QFutureWatcher<HashedFile> *m_hashWatcher;
+    QFutureWatcher<HashedFile> *m_workspaceHashWatcher;
+    QSet<QString> m_hashedMeanwhile;
+    bool m_activationPending;
+    bool m_documentsChanged;
+    int m_publishedChanges;
+    int m_suppressedChanges;
     Error m_error = NoError;
 };
 
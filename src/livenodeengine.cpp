@@ -130,6 +130,13 @@ public:
         return overlayingPath;
     }
 
+    bool isReserved(const LiveDocument &document)
+    {
+        QReadLocker locker(&m_lock);
+
+        return m_mappings.contains(QUrl::fromLocalFile(document.absoluteFilePathIn(m_base)));
+    }
+
     // From QQmlAbstractUrlInterceptor
     QUrl intercept(const QUrl &url, DataType type) Q_DECL_OVERRIDE
     {
@@ -158,6 +165,7 @@ LiveNodeEngine::LiveNodeEngine(QObject *parent)
     , m_xOffset(0)
     , m_yOffset(0)
     , m_rotation(0)
+    , m_transformPending(false)
     , m_delayReload(new QTimer(this))
     , m_pluginFactory(new ContentPluginFactory(this))
     , m_activePlugin(0)
@@ -172,6 +180,9 @@ LiveNodeEngine::LiveNodeEngine(QObject *parent)
  */
 LiveNodeEngine::~LiveNodeEngine()
 {
+    // Uncommitted updates are discarded
+    foreach (const PendingUpdate &update, m_pendingUpdates)
+        delete update.file;
     destroyOverlay();
 }
 
@@ -225,13 +236,13 @@ void LiveNodeEngine::setFallbackView(QQuickView *fallbackView)
 
 /*!
  * Sets the x-offset \a offset of window
+ *
+ * The offset is applied with the next frame, see scheduleTransform().
  */
 void LiveNodeEngine::setXOffset(int offset)
 {
-    if (m_activeWindow)
-        m_activeWindow->contentItem()->setX(offset);
-
     m_xOffset = offset;
+    scheduleTransform();
 }
 
 /*!
@@ -247,10 +258,8 @@ int LiveNodeEngine::xOffset() const
  */
 void LiveNodeEngine::setYOffset(int offset)
 {
-    if (m_activeWindow)
-        m_activeWindow->contentItem()->setY(offset);
-
     m_yOffset = offset;
+    scheduleTransform();
 }
 
 /*!
@@ -266,14 +275,8 @@ int LiveNodeEngine::yOffset() const
  */
 void LiveNodeEngine::setRotation(int rotation)
 {
-    if (m_activeWindow) {
-        m_activeWindow->contentItem()->setRotation(0);
-        const QPointF center(m_activeWindow->width() / 2, m_activeWindow->height() / 2);
-        m_activeWindow->contentItem()->setTransformOriginPoint(center);
-        m_activeWindow->contentItem()->setRotation(rotation);
-    }
-
     m_rotation = rotation;
+    scheduleTransform();
 }
 
 /*!
@@ -321,6 +324,10 @@ void LiveNodeEngine::usePreloadedDocument(const LiveDocument &document, QObject
                                              this, &LiveNodeEngine::onSizeChanged);
         m_activeWindowConnections << connect(m_activeWindow.data(), &QWindow::heightChanged,
                                              this, &LiveNodeEngine::onSizeChanged);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 3, 0)
+        m_activeWindowConnections << connect(m_activeWindow.data(), &QQuickWindow::afterAnimating,
+                                             this, &LiveNodeEngine::applyTransform);
+#endif
         onSizeChanged();
     }
 
@@ -386,6 +393,16 @@ void LiveNodeEngine::delayReload()
     m_delayReload->start();
 }
 
+/*!
+ * Returns whether a reload started by delayReload() is still to come.
+ *
+ * documentLoaded() is emitted when it finished.
+ */
+bool LiveNodeEngine::isReloadPending() const
+{
+    return m_delayReload->isActive();
+}
+
 /*!
  * Checks if the QtQuick Controls module exists for the content adapters
  */
@@ -513,6 +530,10 @@ void LiveNodeEngine::reloadDocument()
                                              this, &LiveNodeEngine::onSizeChanged);
         m_activeWindowConnections << connect(m_activeWindow.data(), &QWindow::heightChanged,
                                              this, &LiveNodeEngine::onSizeChanged);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 3, 0)
+        m_activeWindowConnections << connect(m_activeWindow.data(), &QQuickWindow::afterAnimating,
+                                             this, &LiveNodeEngine::applyTransform);
+#endif
         onSizeChanged();
     }
 
@@ -540,24 +561,170 @@ void LiveNodeEngine::updateDocument(const LiveDocument &document, const QByteArr
         return;
     }
 
-    QString filePath = (m_workspaceOptions & UpdatesAsOverlay)
-        ? m_overlayUrlInterceptor->reserve(document)
-        : document.absoluteFilePathIn(m_workspace);
+    discardUpdate(document);
 
-    QString dirPath = QFileInfo(filePath).absoluteDir().absolutePath();
-    QDir().mkpath(dirPath);
-    QFile file(filePath);
+    QSaveFile file(updateFilePath(document));
     if (!file.open(QIODevice::WriteOnly)) {
         qWarning() << "Unable to save file: " << file.errorString();
         return;
     }
     file.write(content);
-    file.close();
+    if (!file.commit()) {
+        qWarning() << "Unable to save file: " << file.errorString();
+        return;
+    }
+
+    finishUpdate(document);
+}
+
+/*!
+ * Starts updating the given workspace \a document with content of \a size
+ * bytes, delivered in chunks by updateDocumentChunk()
+ *
+ * The content is written to a temporary file which replaces the document
+ * atomically with endUpdateDocument(). A previous incomplete update of the
+ * same document is discarded.
+ */
+void LiveNodeEngine::beginUpdateDocument(const LiveDocument &document, qint64 size)
+{
+    if (!(m_workspaceOptions & AllowUpdates)) {
+        return;
+    }
+
+    discardUpdate(document);
+
+    QSaveFile *file = new QSaveFile(updateFilePath(document));
+    if (!file->open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to save file: " << file->errorString();
+        delete file;
+        return;
+    }
+
+    PendingUpdate update;
+    update.file = file;
+    update.size = size;
+    m_pendingUpdates.insert(document.relativeFilePath(), update);
+}
+
+/*!
+ * Writes \a data at \a offset of the \a document being updated
+ *
+ * Chunks have to arrive in order. A missing chunk discards the update.
+ */
+void LiveNodeEngine::updateDocumentChunk(const LiveDocument &document, qint64 offset, const QByteArray &data)
+{
+    auto it = m_pendingUpdates.find(document.relativeFilePath());
+    if (it == m_pendingUpdates.end())
+        return;
+
+    if (it->file->pos() != offset || it->file->pos() + data.size() > it->size) {
+        qWarning() << "Unexpected chunk of" << document << "at" << offset << ", discarding update";
+        discardUpdate(document);
+        return;
+    }
+
+    if (it->file->write(data) != data.size()) {
+        qWarning() << "Unable to save file: " << it->file->errorString();
+        discardUpdate(document);
+    }
+}
+
+/*!
+ * Replaces the \a document with the content written since
+ * beginUpdateDocument(), if it was received completely
+ */
+void LiveNodeEngine::endUpdateDocument(const LiveDocument &document)
+{
+    if (!m_pendingUpdates.contains(document.relativeFilePath()))
+        return;
+
+    const PendingUpdate update = m_pendingUpdates.take(document.relativeFilePath());
+    QScopedPointer<QSaveFile> file(update.file);
+    if (file->pos() != update.size) {
+        qWarning() << "Incomplete update of" << document << ", discarding it";
+        return;
+    }
+    if (!file->commit()) {
+        qWarning() << "Unable to save file: " << file->errorString();
+        return;
+    }
+
+    finishUpdate(document);
+}
+
+/*!
+ * Removes the given workspace \a document when updates are enabled.
+ *
+ * With UpdatesAsOverlay the workspace itself is left untouched. The document
+ * is hidden by mapping it to the overlay, where it does not exist anymore.
+ */
+void LiveNodeEngine::removeDocument(const LiveDocument &document)
+{
+    if (!(m_workspaceOptions & AllowUpdates)) {
+        return;
+    }
+
+    discardUpdate(document);
+
+    QString filePath = (m_workspaceOptions & UpdatesAsOverlay)
+        ? m_overlayUrlInterceptor->reserve(document)
+        : document.absoluteFilePathIn(m_workspace);
+
+    if (QFileInfo::exists(filePath) && !QFile::remove(filePath)) {
+        qWarning() << "Unable to remove file: " << filePath;
+        return;
+    }
 
     if (!m_activeFile.isNull())
         delayReload();
 }
 
+/*!
+ * Returns the files holding the current content of all workspace documents,
+ * keyed by the relative document path
+ *
+ * With UpdatesAsOverlay the overlay takes precedence over the workspace and
+ * documents removed with removeDocument() are left out.
+ */
+QHash<QString, QString> LiveNodeEngine::documentFiles() const
+{
+    QHash<QString, QString> files;
+
+    QDirIterator it(m_workspace.absolutePath(), QDir::Files | QDir::NoDotAndDotDot,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        const LiveDocument document(m_workspace.relativeFilePath(path));
+        if (m_overlayUrlInterceptor && m_overlayUrlInterceptor->isReserved(document))
+            continue;
+        files.insert(document.relativeFilePath(), path);
+    }
+
+    if (m_overlayUrlInterceptor) {
+        const QDir overlay = m_overlayUrlInterceptor->overlay();
+        QDirIterator it(overlay.absolutePath(), QDir::Files | QDir::NoDotAndDotDot,
+                        QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            const QString path = it.next();
+            files.insert(overlay.relativeFilePath(path), path);
+        }
+    }
+
+    return files;
+}
+
+/*!
+ * Returns the file holding the current content of \a document
+ *
+ * With UpdatesAsOverlay this is the overlaying file once the document was
+ * updated or removed.
+ */
+QString LiveNodeEngine::documentFile(const LiveDocument &document) const
+{
+    if (m_overlayUrlInterceptor && m_overlayUrlInterceptor->isReserved(document))
+        return document.absoluteFilePathIn(m_overlayUrlInterceptor->overlay());
+    return document.absoluteFilePathIn(m_workspace);
+}
 
 /*!
  * Allows to adapt a \a url to display not native QML documents (e.g. images).
@@ -617,6 +784,41 @@ void LiveNodeEngine::setWorkspace(const QString &path, WorkspaceOptions options)
     emit workspaceChanged(workspace());
 }
 
+/*!
+ * Returns the file updates of \a document are written to, creating its
+ * directory if needed
+ *
+ * With UpdatesAsOverlay the document is only mapped to the overlay by
+ * finishUpdate(), so a failed or incomplete update leaves the workspace
+ * original visible.
+ */
+QString LiveNodeEngine::updateFilePath(const LiveDocument &document)
+{
+    QString filePath = (m_workspaceOptions & UpdatesAsOverlay)
+        ? document.absoluteFilePathIn(m_overlayUrlInterceptor->overlay())
+        : document.absoluteFilePathIn(m_workspace);
+
+    QString dirPath = QFileInfo(filePath).absoluteDir().absolutePath();
+    QDir().mkpath(dirPath);
+    return filePath;
+}
+
+// Called once the update of the document was written completely
+void LiveNodeEngine::finishUpdate(const LiveDocument &document)
+{
+    if (m_workspaceOptions & UpdatesAsOverlay)
+        m_overlayUrlInterceptor->reserve(document);
+
+    if (!m_activeFile.isNull())
+        delayReload();
+}
+
+void LiveNodeEngine::discardUpdate(const LiveDocument &document)
+{
+    if (m_pendingUpdates.contains(document.relativeFilePath()))
+        delete m_pendingUpdates.take(document.relativeFilePath()).file;
+}
+
 void LiveNodeEngine::initOverlay()
 {
     Q_ASSERT(m_workspaceOptions & UpdatesAsOverlay);
@@ -722,7 +924,58 @@ void LiveNodeEngine::onSizeChanged()
         m_runtime->setScreenHeight(m_activeWindow->height());
     }
 
-    setRotation(m_rotation);
+    applyRotation();
+}
+
+/*!
+ * Requests a frame of the active window to apply offsets and rotation
+ *
+ * Offsets and rotation are state values a hub may update many times per
+ * second while a spinbox is dragged. Only the latest values are applied, at
+ * most once per frame, from the window's afterAnimating() signal.
+ */
+void LiveNodeEngine::scheduleTransform()
+{
+    if (!m_activeWindow || m_transformPending)
+        return;
+
+    m_transformPending = true;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 3, 0)
+    m_activeWindow->update();
+#else
+    applyTransform();
+#endif
+}
+
+/*!
+ * Applies the offsets and rotation scheduled with scheduleTransform()
+ */
+void LiveNodeEngine::applyTransform()
+{
+    if (!m_transformPending)
+        return;
+
+    m_transformPending = false;
+
+    if (!m_activeWindow)
+        return;
+
+    m_activeWindow->contentItem()->setX(m_xOffset);
+    m_activeWindow->contentItem()->setY(m_yOffset);
+    applyRotation();
+}
+
+/*!
+ * Rotates the content of the active window around its center
+ */
+void LiveNodeEngine::applyRotation()
+{
+    Q_ASSERT(m_activeWindow != 0);
+
+    m_activeWindow->contentItem()->setRotation(0);
+    const QPointF center(m_activeWindow->width() / 2, m_activeWindow->height() / 2);
+    m_activeWindow->contentItem()->setTransformOriginPoint(center);
+    m_activeWindow->contentItem()->setRotation(m_rotation);
 }
 
 /*!
@@ -77,6 +77,8 @@ public:
 
     QString workspace() const;
     void setWorkspace(const QString &path, WorkspaceOptions options = NoWorkspaceOption);
+    QHash<QString, QString> documentFiles() const;
+    QString documentFile(const LiveDocument &document) const;
 
     void setPluginPath(const QString& path);
     QString pluginPath() const;
@@ -84,6 +86,7 @@ public:
     LiveDocument activeDocument() const;
     ContentAdapterInterface *activePlugin() const;
     QQuickWindow *activeWindow() const;
+    bool isReloadPending() const;
 
     void usePreloadedDocument(const LiveDocument &document, QObject *object, QQuickWindow *window,
                               const QList<QQmlError> &errors);
@@ -98,6 +101,10 @@ public Q_SLOTS:
     void delayReload();
     virtual void reloadDocument();
     void updateDocument(const LiveDocument &document, const QByteArray &content);
+    void beginUpdateDocument(const LiveDocument &document, qint64 size);
+    void updateDocumentChunk(const LiveDocument &document, qint64 offset, const QByteArray &data);
+    void endUpdateDocument(const LiveDocument &document);
+    void removeDocument(const LiveDocument &document);
 
 Q_SIGNALS:
     void activeDocumentChanged(const LiveDocument& document);
@@ -116,18 +123,25 @@ protected:
 
 private Q_SLOTS:
     void onSizeChanged();
+    void applyTransform();
 
 private:
     void checkQmlFeatures();
     QUrl errorScreenUrl() const;
     QUrl queryDocumentViewer(const QUrl& url);
+    QString updateFilePath(const LiveDocument &document);
+    void finishUpdate(const LiveDocument &document);
+    void discardUpdate(const LiveDocument &document);
     void initOverlay();
     void destroyOverlay();
+    void scheduleTransform();
+    void applyRotation();
 
 private:
     int m_xOffset;
     int m_yOffset;
     int m_rotation;
+    bool m_transformPending;
 
     QPointer<QQmlEngine> m_qmlEngine;
     QPointer<QQuickView> m_fallbackView;
@@ -139,6 +153,13 @@ private:
     QPointer<OverlayUrlInterceptor> m_overlayUrlInterceptor;
     QTimer *m_delayReload;
 
+    struct PendingUpdate
+    {
+        QSaveFile *file;
+        qint64 size;
+    };
+    QHash<QString, PendingUpdate> m_pendingUpdates;
+
     ContentPluginFactory* m_pluginFactory;
     ContentAdapterInterface* m_activePlugin;
 
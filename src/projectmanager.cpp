@@ -31,6 +31,7 @@
 ****************************************************************************/
 
 #include "projectmanager.h"
+#include "ignorematcher.h"
 
 #include <QFile>
 #include <QDebug>
@@ -41,12 +42,14 @@
 const QLatin1String MainKey("main");
 const QLatin1String WorkspaceKey("workspace");
 const QLatin1String ImportsKey("imports");
+const QLatin1String IgnoreKey("ignore");
 const QLatin1String QMLLiveExtension(".qmllive");
 
 ProjectManager::ProjectManager(QObject *parent)
     : QObject(parent)
     , m_mainDocument("main.qml")
     , m_workspace("")
+    , m_ignoreRules(IgnoreMatcher::defaultRules())
     , m_projectName("")
     , m_projectLocation("")
 {
@@ -87,6 +90,12 @@ bool ProjectManager::read(const QString &path)
         for (QJsonValue value : imports)
             m_imports.append(value.toString());
     }
+    if (root.contains(IgnoreKey) && root.value(IgnoreKey).isArray()) {
+        m_ignoreRules.clear();
+        QJsonArray ignoreRules = root.value(IgnoreKey).toArray();
+        for (QJsonValue value : ignoreRules)
+            m_ignoreRules.append(value.toString());
+    }
     return true;
 }
 
@@ -106,6 +115,10 @@ void ProjectManager::write(const QString &path)
     for (const QString &import : m_imports)
         imports.append(QJsonValue(import));
     root.insert(ImportsKey, imports);
+    QJsonArray ignoreRules;
+    for (const QString &rule : m_ignoreRules)
+        ignoreRules.append(QJsonValue(rule));
+    root.insert(IgnoreKey, ignoreRules);
     QJsonDocument document(root);
     file.write(document.toJson());
 }
@@ -133,6 +146,11 @@ QStringList ProjectManager::imports() const
     return m_imports;
 }
 
+QStringList ProjectManager::ignoreRules() const
+{
+    return m_ignoreRules;
+}
+
 QString ProjectManager::projectLocation() const
 {
     return m_projectLocation;
@@ -143,6 +161,7 @@ void ProjectManager::reset()
     m_mainDocument = QString("main.qml");
     m_workspace = QString("");
     m_imports.clear();
+    m_ignoreRules = IgnoreMatcher::defaultRules();
 }
 
 void ProjectManager::setProjectName(const QString &projectName)
@@ -161,4 +180,8 @@ void ProjectManager::setImports(const QStringList &imports)
 {
     m_imports = imports;
 }
+void ProjectManager::setIgnoreRules(const QStringList &ignoreRules)
+{
+    m_ignoreRules = ignoreRules;
+}
 
@@ -48,12 +48,14 @@ public:
     QString mainDocument() const;
     QString workspace() const;
     QStringList imports() const;
+    QStringList ignoreRules() const;
     QString projectLocation() const;
 
     void setProjectName(const QString &projectName);
     void setMainDocument(const QString &mainDocument);
     void setWorkspace(const QString &workspace);
     void setImports(const QStringList &imports);
+    void setIgnoreRules(const QStringList &ignoreRules);
 private:
     void reset();
 
@@ -61,6 +63,7 @@ private:
     QString m_mainDocument;
     QString m_workspace;
     QStringList m_imports;
+    QStringList m_ignoreRules;
     QString m_projectName;
     QString m_projectLocation;
 };
@@ -0,0 +1,103 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "remoteprotocol.h"
+
+/*!
+ * \class RemoteProtocol
+ * \internal
+ * \brief Declares the calls exchanged between RemotePublisher and RemoteReceiver
+ *
+ * The signatures are part of the wire format and must not change, new
+ * calls get new signatures. Older peers ignore calls they do not know.
+ *
+ * pinOk carries "1" or "0" and needsPublishWorkspace a ContentManifest in
+ * its own format, both predate the QDataStream encoding of the others and
+ * are passed as IpcRawContent.
+ *
+ * requestAcknowledge carries a sequence number, which the node answers with
+ * acknowledge once everything sent before has been applied. Besides the
+ * sequence number it reports in milliseconds when the changes were applied
+ * and when the view was reloaded with them, or -1 if no reload was needed.
+ * Both are measured from the first call received after the previous
+ * acknowledgement, the clocks of hub and node are not compared.
+ *
+ * ready tells the hub that the node accepts calls, after the PIN was
+ * accepted if one is needed.
+ */
+
+const IpcMethod<QString> RemoteProtocol::checkPin(CheckPinId, "checkPin(QString)");
+const IpcMethod<int> RemoteProtocol::setXOffset(SetXOffsetId, "setXOffset(int)");
+const IpcMethod<int> RemoteProtocol::setYOffset(SetYOffsetId, "setYOffset(int)");
+const IpcMethod<int> RemoteProtocol::setRotation(SetRotationId, "setRotation(int)");
+const IpcMethod<> RemoteProtocol::beginBulkSend(BeginBulkSendId, "beginBulkSend()");
+const IpcMethod<> RemoteProtocol::endBulkSend(EndBulkSendId, "endBulkSend()");
+const IpcMethod<QString, QByteArray> RemoteProtocol::sendDocument(
+        SendDocumentId, "sendDocument(QString,QByteArray)");
+const IpcMethod<RemoteProtocol::DocumentList> RemoteProtocol::sendDocuments(
+        SendDocumentsId, "sendDocuments(QList<QPair<QString,QByteArray>>)");
+const IpcMethod<QString, qint64> RemoteProtocol::beginDocument(
+        BeginDocumentId, "beginDocument(QString,qint64)");
+const IpcMethod<QString, qint64, QByteArray> RemoteProtocol::sendDocumentChunk(
+        SendDocumentChunkId, "sendDocumentChunk(QString,qint64,QByteArray)");
+const IpcMethod<QString> RemoteProtocol::endDocument(EndDocumentId, "endDocument(QString)");
+const IpcMethod<QString> RemoteProtocol::requestDocumentSignature(
+        RequestDocumentSignatureId, "requestDocumentSignature(QString)");
+const IpcMethod<QString, QByteArray> RemoteProtocol::sendDocumentDelta(
+        SendDocumentDeltaId, "sendDocumentDelta(QString,QByteArray)");
+const IpcMethod<QString> RemoteProtocol::removeDocument(RemoveDocumentId, "removeDocument(QString)");
+const IpcMethod<QString> RemoteProtocol::activateDocument(ActivateDocumentId, "activateDocument(QString)");
+const IpcMethod<> RemoteProtocol::ping(PingId, "ping()");
+const IpcMethod<quint32> RemoteProtocol::requestAcknowledge(
+        RequestAcknowledgeId, "requestAcknowledge(quint32)");
+
+const IpcMethod<> RemoteProtocol::needsPinAuthentication(NeedsPinAuthenticationId, "needsPinAuthentication()");
+const IpcMethod<IpcRawContent> RemoteProtocol::pinOk(PinOkId, "pinOK(bool)");
+const IpcMethod<> RemoteProtocol::supportsDocumentDelta(SupportsDocumentDeltaId, "supportsDocumentDelta()");
+const IpcMethod<> RemoteProtocol::supportsChunkedDocument(SupportsChunkedDocumentId, "supportsChunkedDocument()");
+const IpcMethod<> RemoteProtocol::supportsDocumentBatch(SupportsDocumentBatchId, "supportsDocumentBatch()");
+const IpcMethod<QString, QByteArray> RemoteProtocol::documentSignature(
+        DocumentSignatureId, "documentSignature(QString,QByteArray)");
+const IpcMethod<QString> RemoteProtocol::documentDeltaFailed(
+        DocumentDeltaFailedId, "documentDeltaFailed(QString)");
+const IpcMethod<IpcRawContent> RemoteProtocol::needsPublishWorkspace(
+        NeedsPublishWorkspaceId, "needsPublishWorkspace()");
+const IpcMethod<int, QString, QUrl, int, int> RemoteProtocol::qmlLog(
+        QmlLogId, "qmlLog(QtMsgType, QString, QUrl, int, int)");
+const IpcMethod<> RemoteProtocol::clearLog(ClearLogId, "clearLog()");
+const IpcMethod<QString> RemoteProtocol::activeDocumentChanged(
+        ActiveDocumentChangedId, "activeDocumentChanged(QString)");
+const IpcMethod<> RemoteProtocol::pong(PongId, "pong()");
+const IpcMethod<> RemoteProtocol::supportsAcknowledge(SupportsAcknowledgeId, "supportsAcknowledge()");
+const IpcMethod<quint32, qint64, qint64> RemoteProtocol::acknowledge(
+        AcknowledgeId, "acknowledge(quint32,qint64,qint64)");
+const IpcMethod<> RemoteProtocol::ready(ReadyId, "ready()");
@@ -0,0 +1,120 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore>
+
+#include "ipc/ipcmethod.h"
+
+class RemoteProtocol
+{
+public:
+    enum MethodId
+    {
+        // Hub to node
+        CheckPinId,
+        SetXOffsetId,
+        SetYOffsetId,
+        SetRotationId,
+        BeginBulkSendId,
+        EndBulkSendId,
+        SendDocumentId,
+        SendDocumentsId,
+        BeginDocumentId,
+        SendDocumentChunkId,
+        EndDocumentId,
+        RequestDocumentSignatureId,
+        SendDocumentDeltaId,
+        RemoveDocumentId,
+        ActivateDocumentId,
+        PingId,
+        RequestAcknowledgeId,
+
+        // Node to hub
+        NeedsPinAuthenticationId,
+        PinOkId,
+        SupportsDocumentDeltaId,
+        SupportsChunkedDocumentId,
+        SupportsDocumentBatchId,
+        DocumentSignatureId,
+        DocumentDeltaFailedId,
+        NeedsPublishWorkspaceId,
+        QmlLogId,
+        ClearLogId,
+        ActiveDocumentChangedId,
+        PongId,
+        SupportsAcknowledgeId,
+        AcknowledgeId,
+        ReadyId,
+
+        MethodCount
+    };
+
+    typedef QList<QPair<QString, QByteArray> > DocumentList;
+
+    // Hub to node
+    static const IpcMethod<QString> checkPin;
+    static const IpcMethod<int> setXOffset;
+    static const IpcMethod<int> setYOffset;
+    static const IpcMethod<int> setRotation;
+    static const IpcMethod<> beginBulkSend;
+    static const IpcMethod<> endBulkSend;
+    static const IpcMethod<QString, QByteArray> sendDocument;
+    static const IpcMethod<DocumentList> sendDocuments;
+    static const IpcMethod<QString, qint64> beginDocument;
+    static const IpcMethod<QString, qint64, QByteArray> sendDocumentChunk;
+    static const IpcMethod<QString> endDocument;
+    static const IpcMethod<QString> requestDocumentSignature;
+    static const IpcMethod<QString, QByteArray> sendDocumentDelta;
+    static const IpcMethod<QString> removeDocument;
+    static const IpcMethod<QString> activateDocument;
+    static const IpcMethod<> ping;
+    static const IpcMethod<quint32> requestAcknowledge;
+
+    // Node to hub
+    static const IpcMethod<> needsPinAuthentication;
+    static const IpcMethod<IpcRawContent> pinOk;
+    static const IpcMethod<> supportsDocumentDelta;
+    static const IpcMethod<> supportsChunkedDocument;
+    static const IpcMethod<> supportsDocumentBatch;
+    static const IpcMethod<QString, QByteArray> documentSignature;
+    static const IpcMethod<QString> documentDeltaFailed;
+    static const IpcMethod<IpcRawContent> needsPublishWorkspace;
+    static const IpcMethod<int, QString, QUrl, int, int> qmlLog;
+    static const IpcMethod<> clearLog;
+    static const IpcMethod<QString> activeDocumentChanged;
+    static const IpcMethod<> pong;
+    static const IpcMethod<> supportsAcknowledge;
+    static const IpcMethod<quint32, qint64, qint64> acknowledge;
+    static const IpcMethod<> ready;
+};
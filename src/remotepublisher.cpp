@@ -32,8 +32,13 @@
 
 #include "remotepublisher.h"
 #include "ipc/ipcclient.h"
+#include "ipc/ipcconnection.h"
 #include "livedocument.h"
 #include "livehubengine.h"
+#include "workspacesync.h"
+#include "deltasync.h"
+#include "documentframecache.h"
+#include "remoteprotocol.h"
 
 #ifdef QMLLIVE_DEBUG
 #define DEBUG qDebug()
@@ -41,6 +46,21 @@
 #define DEBUG if (0) qDebug()
 #endif
 
+namespace {
+// Smaller documents are always sent whole, a signature round trip is not
+// worth it for them
+const qint64 DeltaThreshold = 64 * 1024;
+// A delta is sent in one frame, the node does not take larger ones
+const qint64 DeltaLimit = IpcConnection::DefaultMaxContentSize;
+// A package being written is not interrupted. Documents larger than a chunk
+// are streamed, so control messages and interactive changes pass them soon,
+// neither side has to hold them in memory and they are not limited by the
+// maximum IPC content size.
+const qint64 ChunkSize = 256 * 1024;
+// Small documents sent in bulk are packed into messages of about this size
+const qint64 BatchBudget = 256 * 1024;
+}
+
 /*!
  * \class RemotePublisher
  * \brief Publishes hub changes to a remote node.
@@ -49,6 +69,53 @@
  * To see the progress which commands were really sent successfully to to the server
  * you have to connect the signals from the LiveHubEngine yourself and monitor the QUuids you
  * got and wait for sendingError() or sentSuccessfully() signals
+ *
+ * Documents are read only when the connection is ready to take more data, so
+ * publishing a large workspace does not load it into memory at once. The
+ * overall progress is reported in bytes with sendProgress().
+ *
+ * Nodes announcing support for it receive larger documents as deltas. The
+ * publisher asks the node for the block signature of the version it has and
+ * sends only the ranges which changed, see DeltaSync. Messages sent while a
+ * signature is awaited are held back, so the node receives everything in
+ * the order it was sent. Documents the node does not have, and documents
+ * whose delta would exceed the maximum frame size, are streamed in chunks if
+ * they are large enough.
+ *
+ * Documents and activations which are still queued when a newer version is
+ * sent are replaced by it, see superseded().
+ *
+ * Documents larger than ChunkSize are streamed in chunks to nodes supporting
+ * it. Each chunk is read from a memory mapping of the file when the
+ * connection is ready for it, so memory use does not depend on the file size.
+ *
+ * Between beginBulkSend() and endBulkSend() small documents are packed into
+ * "sendDocuments" messages, so publishing many tiny files does not pay the
+ * overhead of one message per file. Every document still gets its own uuid.
+ *
+ * Offsets and rotation only describe the latest state of the node. At most
+ * one of each is on its way at a time, newer values wait and replace each
+ * other until it was sent, see setXOffset().
+ *
+ * Settings, activations and changes made one by one are sent in more urgent
+ * IPC lanes than bulk sends, so they are not stuck behind a whole workspace
+ * being published, see IpcClient::Lane. Documents larger than a chunk are
+ * streamed, which gives the more urgent lanes a gap often. Deltas are still
+ * sent in a single message.
+ * Activations depend on the documents sent before them, they are sent in the
+ * interactive lane and held back like documents. Only offsets, rotation,
+ * pings and the PIN bypass both.
+ *
+ * sentSuccessfully() only tells that a message was handed to the operating
+ * system. Nodes supporting it acknowledge sent and removed documents and
+ * activations once they applied them and reloaded the view, see
+ * acknowledged(). Each acknowledgement also yields a latency measurement,
+ * see latencyMeasured(). A delta the node fails to apply is sent again as
+ * a whole document, and acknowledged once that was applied.
+ *
+ * Documents changed or removed while a node is offline are journaled, once
+ * it has been connected. When it is back, only the latest state of the
+ * journaled documents is sent, see replayJournal().
  */
 
 /*!
@@ -58,17 +125,57 @@ RemotePublisher::RemotePublisher(QObject *parent)
     : QObject(parent)
     , m_ipc(new IpcClient(this))
     , m_hub(0)
+    , m_deltaSupported(false)
+    , m_chunkedSupported(false)
+    , m_batchSupported(false)
+    , m_bulkSend(false)
+    , m_batchSize(0)
+    , m_acknowledgeSupported(false)
+    , m_acknowledgeSequence(0)
+    , m_journaling(false)
+    , m_bytesSent(0)
+    , m_bytesTotal(0)
+    , m_dispatcher(new IpcDispatcher)
 {
-    connect(m_ipc, &IpcClient::sentSuccessfully, this, &RemotePublisher::sentSuccessfully);
-    connect(m_ipc, &IpcClient::sendingError, this, &RemotePublisher::sendingError);
+    registerCalls();
+    m_ipc->setCompressor(&DocumentFrameCache::compress);
+
     connect(m_ipc, &IpcClient::connectionError, this, &RemotePublisher::connectionError);
     connect(m_ipc, &IpcClient::connected, this, &RemotePublisher::connected);
+    connect(m_ipc, &IpcClient::disconnected, this, &RemotePublisher::onDisconnected);
     connect(m_ipc, &IpcClient::disconnected, this, &RemotePublisher::disconnected);
 
     connect(m_ipc, &IpcClient::received, this, &RemotePublisher::handleCall);
 
     connect(m_ipc, &IpcClient::sentSuccessfully, this, &RemotePublisher::onSentSuccessfully);
     connect(m_ipc, &IpcClient::sendingError, this, &RemotePublisher::onSendingError);
+    connect(m_ipc, &IpcClient::superseded, this, &RemotePublisher::onSuperseded);
+
+    connect(this, &RemotePublisher::needsWorkspaceUpdate, this, &RemotePublisher::updateWorkspace);
+}
+
+/*!
+ * Destructor
+ */
+RemotePublisher::~RemotePublisher()
+{
+    delete m_dispatcher;
+}
+
+// Sends the call in lane after any messages held back
+template <typename... Args>
+QUuid RemotePublisher::post(int lane, const IpcMethod<Args...> &method,
+                            const typename std::common_type<Args>::type &... args)
+{
+    return post(lane, method.signature(), method.pack(args...));
+}
+
+// Sends the state call, coalescing it with newer values while one is out
+template <typename... Args>
+QUuid RemotePublisher::postState(const IpcMethod<Args...> &method,
+                                 const typename std::common_type<Args>::type &... args)
+{
+    return postState(QString::fromLatin1(method.signature()), method.pack(args...));
 }
 
 /*!
@@ -81,8 +188,21 @@ QAbstractSocket::SocketState RemotePublisher::state() const
     return m_ipc->state();
 }
 
+/*!
+ * Returns true if the node will acknowledge the package \a uuid and did not
+ * do so yet
+ *
+ * \sa acknowledged()
+ */
+bool RemotePublisher::isAwaitingAcknowledgement(const QUuid &uuid) const
+{
+    return m_unacknowledged.contains(uuid);
+}
+
 /*!
  * Register the \a hub to be used with this publisher
+ *
+ * \sa setHub()
  */
 void RemotePublisher::registerHub(LiveHubEngine *hub)
 {
@@ -92,18 +212,72 @@ void RemotePublisher::registerHub(LiveHubEngine *hub)
     m_hub = hub;
     connect(hub, &LiveHubEngine::activateDocument, this, &RemotePublisher::activateDocument);
     connect(hub, &LiveHubEngine::fileChanged, this, &RemotePublisher::sendDocument);
+    connect(hub, &LiveHubEngine::fileRemoved, this, &RemotePublisher::removeDocument);
     connect(hub, &LiveHubEngine::publishFile, this, &RemotePublisher::sendDocument);
     connect(this, &RemotePublisher::needsPublishWorkspace, hub, &LiveHubEngine::publishWorkspace);
     connect(hub, &LiveHubEngine::beginPublishWorkspace, this, &RemotePublisher::beginBulkSend);
     connect(hub, &LiveHubEngine::endPublishWorkspace, this, &RemotePublisher::endBulkSend);
 }
 
+/*!
+ * Sets the \a hub whose workspace is compared with the node's manifest,
+ * without forwarding its changes as registerHub() does
+ *
+ * Use this when the hub signals are handled by the caller.
+ *
+ * \sa needsWorkspaceUpdate()
+ */
+void RemotePublisher::setHub(LiveHubEngine *hub)
+{
+    m_hub = hub;
+}
+
+/*!
+ * Publishes the documents of the hub which are missing or outdated according
+ * to the node's \a manifest
+ */
+void RemotePublisher::updateWorkspace(const ContentManifest &manifest)
+{
+    if (!m_hub || state() != QAbstractSocket::ConnectedState)
+        return;
+
+    delete m_workspaceSync;
+    m_workspaceSync = new WorkspaceSync(m_hub, manifest, this);
+    connect(m_workspaceSync, &WorkspaceSync::finished, this, &RemotePublisher::onWorkspaceCompared);
+    m_workspaceSync->start();
+}
+
+void RemotePublisher::onWorkspaceCompared()
+{
+    WorkspaceSync *sync = m_workspaceSync;
+    if (!sync)
+        return;
+
+    sync->deleteLater();
+
+    if (state() != QAbstractSocket::ConnectedState)
+        return;
+
+    DEBUG << "Updating workspace:" << sync->outdatedDocuments().count() << "outdated,"
+          << sync->upToDateCount() << "up to date";
+
+    QList<QUuid> uuids;
+    beginBulkSend();
+    foreach (const LiveDocument &document, sync->outdatedDocuments())
+        uuids.append(sendDocument(document));
+    endBulkSend();
+
+    emit updatingWorkspace(uuids);
+}
+
 /*!
  * Sets the current workspace to \a path. Documents location will be adjusted based on
  * this workspace path.
  */
 void RemotePublisher::setWorkspace(const QString &path)
 {
+    if (QDir(path) != m_workspace)
+        m_journal.clear();
     m_workspace = QDir(path);
 }
 
@@ -139,10 +313,13 @@ void RemotePublisher::disconnectFromServer()
 QUuid RemotePublisher::activateDocument(const LiveDocument &document)
 {
     DEBUG << "RemotePublisher::activateDocument" << document;
-    QByteArray bytes;
-    QDataStream out(&bytes, QIODevice::WriteOnly);
-    out << document.relativeFilePath();
-    return m_ipc->send("activateDocument(QString)", bytes);
+    m_activeDocument = document.relativeFilePath();
+    // Sent after the documents already posted, the node should not load an
+    // outdated version
+    return awaitAcknowledgement(post(IpcClient::InteractiveLane, RemoteProtocol::activateDocument.signature(),
+                                     RemoteProtocol::activateDocument.pack(document.relativeFilePath()),
+                                     QStringLiteral("activateDocument")),
+                                IpcClient::InteractiveLane);
 }
 
 /*!
@@ -151,7 +328,9 @@ QUuid RemotePublisher::activateDocument(const LiveDocument &document)
 QUuid RemotePublisher::beginBulkSend()
 {
     DEBUG << "RemotePublisher::beginBulkSend";
-    return m_ipc->send("beginBulkSend()", QByteArray());
+    const QUuid uuid = post(IpcClient::BulkLane, RemoteProtocol::beginBulkSend);
+    m_bulkSend = true;
+    return uuid;
 }
 
 /*!
@@ -160,7 +339,10 @@ QUuid RemotePublisher::beginBulkSend()
 QUuid RemotePublisher::endBulkSend()
 {
     DEBUG << "RemotePublisher::endBulkSend";
-    return m_ipc->send("endBulkSend()", QByteArray());
+    m_bulkSend = false;
+    const QUuid uuid = post(IpcClient::BulkLane, RemoteProtocol::endBulkSend);
+    requestAcknowledgement();
+    return uuid;
 }
 
 /*!
@@ -170,31 +352,67 @@ QUuid RemotePublisher::endBulkSend()
 QUuid RemotePublisher::sendDocument(const LiveDocument& document)
 {
     DEBUG << "RemotePublisher::sendDocument" << document;
+    if (m_journaling && state() != QAbstractSocket::ConnectedState) {
+        m_journal.insert(document.relativeFilePath());
+        return QUuid();
+    }
+
+    return awaitAcknowledgement(postDocument(document, true), contentLane());
+}
+
+// Sends the document the way suiting its size, as a delta if allowed
+QUuid RemotePublisher::postDocument(const LiveDocument &document, bool allowDelta)
+{
+    // A delta is tried first, it is streamed instead if the node has no copy
+    const QFileInfo info(document.absoluteFilePathIn(m_workspace));
+    if (allowDelta && m_deltaSupported && info.size() >= DeltaThreshold && info.size() <= DeltaLimit
+            && !isHeld(document.relativeFilePath())) {
+        return sendDocumentDelta(document);
+    }
+    if (m_chunkedSupported && info.size() >= ChunkSize)
+        return sendDocumentChunked(document);
     return sendWholeDocument(document);
 }
 
+/*!
+ * Sends "removeDocument(QString)" via IPC to remove \a document on the node.
+ *
+ * Nodes not knowing this call ignore it.
+ */
+QUuid RemotePublisher::removeDocument(const LiveDocument& document)
+{
+    DEBUG << "RemotePublisher::removeDocument" << document;
+    if (m_journaling && state() != QAbstractSocket::ConnectedState) {
+        m_journal.insert(document.relativeFilePath());
+        return QUuid();
+    }
+
+    return awaitAcknowledgement(post(contentLane(), RemoteProtocol::removeDocument.signature(),
+                                     RemoteProtocol::removeDocument.pack(document.relativeFilePath()),
+                                     documentKey(document.relativeFilePath())),
+                                contentLane());
+}
+
 /*!
  Send checkPin with \a pin argument and returns the package uuid.
  */
 QUuid RemotePublisher::checkPin(const QString &pin)
 {
     DEBUG << "RemotePublisher::checkPin" << pin;
-    QByteArray bytes;
-    QDataStream out(&bytes, QIODevice::WriteOnly);
-    out << pin;
-    return m_ipc->send("checkPin(QString)", bytes);
+    return post(IpcClient::ControlLane, RemoteProtocol::checkPin, pin);
 }
 
 /*!
   Sends the \e setXOffset with \a offset as argument via IPC
+
+  While a previous offset is still being sent, the new one waits for it and
+  supersedes any other offset waiting, see superseded(). The same applies to
+  setYOffset() and setRotation().
  */
 
 QUuid RemotePublisher::setXOffset(int offset)
 {
-    QByteArray bytes;
-    QDataStream out(&bytes, QIODevice::WriteOnly);
-    out << offset;
-    return m_ipc->send("setXOffset(int)", bytes);
+    return postState(RemoteProtocol::setXOffset, offset);
 }
 
 /*!
@@ -203,10 +421,7 @@ QUuid RemotePublisher::setXOffset(int offset)
 
 QUuid RemotePublisher::setYOffset(int offset)
 {
-    QByteArray bytes;
-    QDataStream out(&bytes, QIODevice::WriteOnly);
-    out << offset;
-    return m_ipc->send("setYOffset(int)", bytes);
+    return postState(RemoteProtocol::setYOffset, offset);
 }
 
 /*!
@@ -214,10 +429,7 @@ QUuid RemotePublisher::setYOffset(int offset)
  */
 QUuid RemotePublisher::setRotation(int rotation)
 {
-    QByteArray bytes;
-    QDataStream out(&bytes, QIODevice::WriteOnly);
-    out << rotation;
-    return m_ipc->send("setRotation(int)", bytes);
+    return postState(RemoteProtocol::setRotation, rotation);
 }
 
 /*!
@@ -226,42 +438,620 @@ QUuid RemotePublisher::setRotation(int rotation)
 QUuid RemotePublisher::sendWholeDocument(const LiveDocument& document)
 {
     DEBUG << "RemotePublisher::sendWholeDocument" << document;
-    QFile file(document.absoluteFilePathIn(m_workspace));
-    if (!file.open(QIODevice::ReadOnly)) {
+    const QString path = document.absoluteFilePathIn(m_workspace);
+    const QFileInfo info(path);
+    if (!info.isFile() || !info.isReadable()) {
+        qWarning() << "ERROR: can't open file: " << document;
+        return QUuid();
+    }
+
+    // The active document is shown, it does not wait for the rest
+    const bool active = document.relativeFilePath() == m_activeDocument;
+    if (m_bulkSend && m_batchSupported && info.size() < DeltaThreshold && !active)
+        return batchDocument(path, document.relativeFilePath(), info.size());
+
+    // Read when the connection is ready for it, not when queued
+    QUuid uuid = post(active ? IpcClient::InteractiveLane : contentLane(),
+                      RemoteProtocol::sendDocument.signature(),
+                      wholeDocument(path, document.relativeFilePath()),
+                      documentKey(document.relativeFilePath()));
+
+    m_documentBytes.insert(uuid, info.size());
+    m_bytesTotal += info.size();
+    emit sendProgress(m_bytesSent, m_bytesTotal);
+    return uuid;
+}
+
+/*!
+ * Sends the documents changed or removed while the node was offline, in one
+ * bulk send
+ *
+ * Each document is sent once in its current state, or removed if it does
+ * not exist anymore. This is called when the node is ready to receive calls
+ * again.
+ */
+void RemotePublisher::replayJournal()
+{
+    if (m_journal.isEmpty() || state() != QAbstractSocket::ConnectedState)
+        return;
+
+    QStringList documents = m_journal.values();
+    m_journal.clear();
+    documents.sort();
+
+    DEBUG << "Replaying" << documents.count() << "documents changed while offline";
+
+    beginBulkSend();
+    foreach (const QString &path, documents) {
+        const LiveDocument document(path);
+        if (document.isFileIn(m_workspace))
+            sendDocument(document);
+        else
+            removeDocument(document);
+    }
+    endBulkSend();
+}
+
+/*!
+ * Sends \a document as a delta against the version the node has
+ *
+ * The node's block signature is requested first. Until it is received, this
+ * and all later messages are held back. A version of the document still
+ * queued is superseded by the request.
+ */
+QUuid RemotePublisher::sendDocumentDelta(const LiveDocument &document)
+{
+    DEBUG << "RemotePublisher::sendDocumentDelta" << document;
+    const QString path = document.absoluteFilePathIn(m_workspace);
+    const qint64 size = QFileInfo(path).size();
+
+    flushBatch();
+
+    // The request overtakes queued documents, a queued version of this one
+    // is superseded by it, so the node signs the version the delta is for
+    m_signatureRequests.insert(m_ipc->send(RemoteProtocol::requestDocumentSignature.signature(),
+                                           RemoteProtocol::requestDocumentSignature.pack(
+                                               document.relativeFilePath()),
+                                           documentKey(document.relativeFilePath()),
+                                           IpcClient::ControlLane),
+                               document.relativeFilePath());
+
+    Outgoing outgoing;
+    outgoing.uuid = QUuid::createUuid();
+    outgoing.lane = contentLane();
+    outgoing.awaiting = document.relativeFilePath();
+    m_held.enqueue(outgoing);
+    m_deltas.insert(document.relativeFilePath(), outgoing.uuid);
+
+    m_documentBytes.insert(outgoing.uuid, size);
+    m_bytesTotal += size;
+    emit sendProgress(m_bytesSent, m_bytesTotal);
+    return outgoing.uuid;
+}
+
+/*!
+ * Adds the \a document at \a path with \a size bytes to the batch of
+ * documents sent together, sending the batch once it exceeds BatchBudget
+ */
+QUuid RemotePublisher::batchDocument(const QString &path, const QString &document, qint64 size)
+{
+    BatchEntry entry;
+    entry.uuid = QUuid::createUuid();
+    entry.path = path;
+    entry.document = document;
+    m_batch.append(entry);
+    m_batchSize += size;
+
+    m_documentBytes.insert(entry.uuid, size);
+    m_bytesTotal += size;
+    emit sendProgress(m_bytesSent, m_bytesTotal);
+
+    if (m_batchSize >= BatchBudget)
+        flushBatch();
+    return entry.uuid;
+}
+
+/*!
+ * Sends the batched documents as one "sendDocuments" message
+ *
+ * The content has the layout of a QList<QPair<QString,QByteArray>>, built
+ * from the same encoded documents sendDocument uses. Documents which can not
+ * be read anymore are left out.
+ */
+void RemotePublisher::flushBatch()
+{
+    if (m_batch.isEmpty())
+        return;
+
+    const QList<BatchEntry> batch = m_batch;
+    m_batch.clear();
+    m_batchSize = 0;
+
+    QList<QUuid> members;
+    foreach (const BatchEntry &entry, batch)
+        members.append(entry.uuid);
+
+    const QUuid uuid = post(IpcClient::BulkLane, RemoteProtocol::sendDocuments.signature(), [batch]() {
+        QList<QByteArray> frames;
+        foreach (const BatchEntry &entry, batch) {
+            const QByteArray frame = DocumentFrameCache::frame(entry.path, entry.document).data;
+            if (!frame.isNull())
+                frames.append(frame);
+        }
+
+        QByteArray bytes;
+        QDataStream out(&bytes, QIODevice::WriteOnly);
+        out << quint32(frames.count());
+        foreach (const QByteArray &frame, frames)
+            bytes.append(frame);
+        return bytes;
+    });
+    m_batches.insert(uuid, members);
+}
+
+/*!
+ * Adds \a uuid to the changes covered by the next acknowledgement and
+ * requests it, unless a bulk send is in progress. Returns \a uuid.
+ */
+QUuid RemotePublisher::awaitAcknowledgement(const QUuid &uuid, int lane)
+{
+    if (!m_acknowledgeSupported || uuid.isNull())
+        return uuid;
+
+    if (m_changes.uuids.isEmpty())
+        m_changes.posted.start();
+    m_changes.uuids.append(uuid);
+    // Sent after the change in the least urgent lane
+    m_changes.lane = qMax(m_changes.lane, lane);
+    m_unacknowledged.insert(uuid);
+
+    if (!m_bulkSend)
+        requestAcknowledgement();
+    return uuid;
+}
+
+/*!
+ * Removes \a uuid from the changes covered by an acknowledgement, it is not
+ * acknowledged with them. Returns false if no acknowledgement covered it.
+ */
+bool RemotePublisher::forgetAcknowledgement(const QUuid &uuid)
+{
+    if (m_changes.uuids.removeAll(uuid))
+        return true;
+    for (auto it = m_acknowledgements.begin(); it != m_acknowledgements.end(); ++it) {
+        if (it->uuids.removeAll(uuid))
+            return true;
+    }
+    return false;
+}
+
+/*!
+ * Asks the node to acknowledge the changes posted since the last request
+ */
+void RemotePublisher::requestAcknowledgement()
+{
+    if (m_changes.uuids.isEmpty())
+        return;
+
+    const quint32 sequence = ++m_acknowledgeSequence;
+    m_acknowledgeRequests.insert(post(m_changes.lane, RemoteProtocol::requestAcknowledge, sequence), sequence);
+    m_acknowledgements.insert(sequence, m_changes);
+    m_changes = Acknowledgement();
+}
+
+/*!
+ * Streams \a document in chunks of ChunkSize, framed by "beginDocument" and
+ * "endDocument"
+ *
+ * Returns the uuid of the final message, the chunks are not reported
+ * individually. Chunks are dropped when the file changes before they are
+ * sent, the node then discards the incomplete document and the change is
+ * published again anyway.
+ */
+QUuid RemotePublisher::sendDocumentChunked(const LiveDocument &document)
+{
+    DEBUG << "RemotePublisher::sendDocumentChunked" << document;
+    const QString path = document.absoluteFilePathIn(m_workspace);
+    // The active document is shown, it does not wait for the rest
+    const bool active = document.relativeFilePath() == m_activeDocument;
+    const QList<Outgoing> messages = documentChunks(path, document.relativeFilePath(),
+                                                    active ? IpcClient::InteractiveLane : contentLane(),
+                                                    QUuid::createUuid());
+    if (messages.isEmpty()) {
         qWarning() << "ERROR: can't open file: " << document;
         return QUuid();
     }
-    QByteArray data = file.readAll();
 
-    QByteArray bytes;
-    QDataStream out(&bytes, QIODevice::WriteOnly);
-    out << document.relativeFilePath();
-    out << data;
-    return m_ipc->send("sendDocument(QString,QByteArray)", bytes);
+    flushBatch();
+    foreach (const Outgoing &outgoing, messages)
+        postOutgoing(outgoing);
+
+    m_bytesTotal += QFileInfo(path).size();
+    emit sendProgress(m_bytesSent, m_bytesTotal);
+    return messages.last().uuid;
+}
+
+/*!
+ * Returns the messages streaming the \a document at \a path in \a lane,
+ * in chunks of ChunkSize framed by "beginDocument" and "endDocument"
+ *
+ * The final message is identified by \a uuid. The chunks are accounted for
+ * in the progress, but not reported individually. Returns an empty list if
+ * the file can not be read.
+ */
+QList<RemotePublisher::Outgoing> RemotePublisher::documentChunks(const QString &path, const QString &document,
+                                                                 int lane, const QUuid &uuid)
+{
+    QList<Outgoing> messages;
+    const QFileInfo info(path);
+    if (!info.isFile() || !info.isReadable())
+        return messages;
+
+    const qint64 size = info.size();
+    const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+
+    Outgoing begin;
+    begin.uuid = QUuid::createUuid();
+    begin.method = QLatin1String(RemoteProtocol::beginDocument.signature());
+    begin.data = RemoteProtocol::beginDocument.pack(document, size);
+    begin.lane = lane;
+    m_chunks.insert(begin.uuid);
+    messages.append(begin);
+
+    for (qint64 offset = 0; offset < size; offset += ChunkSize) {
+        const qint64 length = qMin(ChunkSize, size - offset);
+        Outgoing chunk;
+        chunk.uuid = QUuid::createUuid();
+        chunk.method = QLatin1String(RemoteProtocol::sendDocumentChunk.signature());
+        chunk.producer = documentChunk(path, document, mtime, size, offset, length);
+        chunk.lane = lane;
+        m_chunks.insert(chunk.uuid);
+        m_documentBytes.insert(chunk.uuid, length);
+        messages.append(chunk);
+    }
+
+    Outgoing end;
+    end.uuid = uuid;
+    end.method = QLatin1String(RemoteProtocol::endDocument.signature());
+    end.data = RemoteProtocol::endDocument.pack(document);
+    end.lane = lane;
+    messages.append(end);
+    return messages;
+}
+
+/*!
+ * Sends \a method with \a data in \a lane, after any messages held back. A
+ * queued message with the same non-empty \a key is superseded.
+ *
+ * Control messages do not depend on documents, they are never held back.
+ * Anything depending on the documents sent before, like activations, must
+ * not be sent in the control lane.
+ */
+QUuid RemotePublisher::post(int lane, const QString &method, const QByteArray &data, const QString &key)
+{
+    flushBatch();
+
+    if (m_held.isEmpty() || lane == IpcClient::ControlLane)
+        return m_ipc->send(method, data, key, IpcClient::Lane(lane));
+
+    Outgoing outgoing;
+    outgoing.uuid = QUuid::createUuid();
+    outgoing.method = method;
+    outgoing.data = data;
+    outgoing.key = key;
+    outgoing.lane = lane;
+    m_held.enqueue(outgoing);
+    return outgoing.uuid;
+}
+
+/*!
+ * Sends \a method with the content created by \a producer in \a lane,
+ * after any messages held back. A queued message with the same non-empty
+ * \a key is superseded.
+ */
+QUuid RemotePublisher::post(int lane, const QString &method, const std::function<QByteArray()> &producer,
+                            const QString &key)
+{
+    flushBatch();
+
+    if (m_held.isEmpty() || lane == IpcClient::ControlLane)
+        return m_ipc->send(method, producer, key, IpcClient::Lane(lane));
+
+    Outgoing outgoing;
+    outgoing.uuid = QUuid::createUuid();
+    outgoing.method = method;
+    outgoing.producer = producer;
+    outgoing.key = key;
+    outgoing.lane = lane;
+    m_held.enqueue(outgoing);
+    return outgoing.uuid;
+}
+
+/*!
+ * Sends the prepared \a outgoing message after any messages held back
+ */
+void RemotePublisher::postOutgoing(const Outgoing &outgoing)
+{
+    if (m_held.isEmpty())
+        sendOutgoing(outgoing);
+    else
+        m_held.enqueue(outgoing);
+}
+
+// Sends the message, it is reported with the uuid it was posted with
+void RemotePublisher::sendOutgoing(const Outgoing &outgoing)
+{
+    const QUuid uuid = outgoing.producer
+            ? m_ipc->send(outgoing.method, outgoing.producer, outgoing.key, IpcClient::Lane(outgoing.lane))
+            : m_ipc->send(outgoing.method, outgoing.data, outgoing.key, IpcClient::Lane(outgoing.lane));
+    m_aliases.insert(uuid, outgoing.uuid);
+}
+
+/*!
+ * Sends the state \a method with \a data in the control lane
+ *
+ * If a previous \a method is still being sent, the call waits for it. A
+ * call already waiting is superseded, so the node only receives the latest
+ * value once the connection keeps up again.
+ */
+QUuid RemotePublisher::postState(const QString &method, const QByteArray &data)
+{
+    if (!m_statesInFlight.contains(method)) {
+        const QUuid uuid = m_ipc->send(method, data, QString(), IpcClient::ControlLane);
+        m_statesInFlight.insert(method, uuid);
+        return uuid;
+    }
+
+    PendingState pending;
+    pending.uuid = QUuid::createUuid();
+    pending.data = data;
+
+    auto it = m_pendingStates.find(method);
+    if (it != m_pendingStates.end()) {
+        const QUuid superseded = it->uuid;
+        *it = pending;
+        emit this->superseded(superseded);
+    } else {
+        m_pendingStates.insert(method, pending);
+    }
+    return pending.uuid;
+}
+
+/*!
+ * Sends the state call waiting for the one with \a uuid, which is done
+ */
+void RemotePublisher::sendPendingState(const QUuid &uuid)
+{
+    const QString method = m_statesInFlight.key(uuid);
+    if (method.isEmpty())
+        return;
+
+    m_statesInFlight.remove(method);
+    if (!m_pendingStates.contains(method))
+        return;
+
+    const PendingState pending = m_pendingStates.take(method);
+    const QUuid sent = m_ipc->send(method, pending.data, QString(), IpcClient::ControlLane);
+    m_aliases.insert(sent, pending.uuid);
+    m_statesInFlight.insert(method, sent);
+}
+
+// Changes made one by one are waited for, those sent in bulk are not
+int RemotePublisher::contentLane() const
+{
+    return m_bulkSend ? IpcClient::BulkLane : IpcClient::InteractiveLane;
+}
+
+/*!
+ * Returns true if a message for \a document waits for its signature
+ */
+bool RemotePublisher::isHeld(const QString &document) const
+{
+    foreach (const Outgoing &outgoing, m_held) {
+        if (outgoing.awaiting == document)
+            return true;
+    }
+    return false;
+}
+
+/*!
+ * Completes the held message for \a document once its \a signature is
+ * known and sends the messages which are no longer held back
+ *
+ * An empty \a signature means the node does not have the document, so it is
+ * sent whole, or streamed if it is large enough. So is a document whose
+ * delta would be too large for a single frame.
+ */
+void RemotePublisher::resolveHeld(const QString &document, const QByteArray &signature)
+{
+    for (int i = 0; i < m_held.count(); ++i) {
+        if (m_held.at(i).awaiting != document)
+            continue;
+
+        Outgoing held = m_held.at(i);
+        held.awaiting.clear();
+        const QString path = LiveDocument(document).absoluteFilePathIn(m_workspace);
+
+        QByteArray delta;
+        if (!signature.isEmpty()) {
+            const DocumentFrameCache::Frame frame = DocumentFrameCache::frame(path, document);
+            if (!frame.isNull())
+                delta = DeltaSync::delta(signature, frame.content());
+            if (!frame.isNull() && delta.isNull())
+                qWarning() << "Invalid document signature received for" << document;
+        }
+
+        if (!delta.isNull() && delta.size() <= DeltaLimit) {
+            held.method = QLatin1String(RemoteProtocol::sendDocumentDelta.signature());
+            held.data = RemoteProtocol::sendDocumentDelta.pack(document, delta);
+            m_held[i] = held;
+            break;
+        }
+
+        if (m_chunkedSupported && QFileInfo(path).size() >= ChunkSize) {
+            const QList<Outgoing> messages = documentChunks(path, document, held.lane, held.uuid);
+            if (!messages.isEmpty()) {
+                // Accounted for by the chunks now
+                m_documentBytes.remove(held.uuid);
+                m_held.removeAt(i);
+                for (int j = 0; j < messages.count(); ++j)
+                    m_held.insert(i + j, messages.at(j));
+                break;
+            }
+        }
+
+        held.method = QLatin1String(RemoteProtocol::sendDocument.signature());
+        held.producer = wholeDocument(path, document);
+        held.key = documentKey(document);
+        m_held[i] = held;
+        break;
+    }
+
+    while (!m_held.isEmpty() && m_held.head().awaiting.isEmpty())
+        sendOutgoing(m_held.dequeue());
+}
+
+// Updates and removals of a document supersede each other
+QString RemotePublisher::documentKey(const QString &document)
+{
+    return QStringLiteral("document:") + document;
+}
+
+// The encoded content is shared between all publishers sending the same file
+std::function<QByteArray()> RemotePublisher::wholeDocument(const QString &path, const QString &document)
+{
+    return [path, document]() {
+        return DocumentFrameCache::frame(path, document).data;
+    };
+}
+
+// The chunk is only valid as long as the file is the one announced
+std::function<QByteArray()> RemotePublisher::documentChunk(const QString &path, const QString &document,
+                                                           qint64 mtime, qint64 size,
+                                                           qint64 offset, qint64 length)
+{
+    return [path, document, mtime, size, offset, length]() {
+        QFile file(path);
+        const QFileInfo info(file);
+        if (info.size() != size || info.lastModified().toMSecsSinceEpoch() != mtime) {
+            DEBUG << "Document changed while sending chunks" << document;
+            return QByteArray();
+        }
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "ERROR: can't open file: " << path;
+            return QByteArray();
+        }
+        uchar *data = file.map(offset, length);
+        if (!data) {
+            qWarning() << "ERROR: can't map file: " << path << file.errorString();
+            return QByteArray();
+        }
+
+        const QByteArray bytes = RemoteProtocol::sendDocumentChunk.pack(
+                    document, offset, QByteArray::fromRawData(reinterpret_cast<const char *>(data), int(length)));
+        file.unmap(data);
+        return bytes;
+    };
+}
+
+void RemotePublisher::onDisconnected()
+{
+    m_journaling = true;
+
+    // Signatures will not arrive anymore, let held documents go out whole
+    m_deltaSupported = false;
+    m_chunkedSupported = false;
+    m_batchSupported = false;
+    m_signatureRequests.clear();
+    m_deltas.clear();
+
+    // Acknowledgements will not arrive anymore
+    m_acknowledgeSupported = false;
+    m_changes = Acknowledgement();
+    m_acknowledgements.clear();
+    m_acknowledgeRequests.clear();
+    m_unacknowledged.clear();
+
+    foreach (const Outgoing &outgoing, m_held) {
+        if (!outgoing.awaiting.isEmpty())
+            resolveHeld(outgoing.awaiting, QByteArray());
+    }
+}
+
+void RemotePublisher::onDocumentDone(const QUuid &uuid)
+{
+    if (!m_documentBytes.contains(uuid))
+        return;
+
+    m_bytesSent += m_documentBytes.take(uuid);
+    emit sendProgress(m_bytesSent, m_bytesTotal);
+
+    if (m_documentBytes.isEmpty()) {
+        m_bytesSent = 0;
+        m_bytesTotal = 0;
+    }
 }
 
 void RemotePublisher::onSentSuccessfully(const QUuid &uuid)
 {
-    QString path = m_packageHash.value(uuid);
-    m_packageHash.remove(uuid);
+    if (m_signatureRequests.remove(uuid))
+        return;
+
+    sendPendingState(uuid);
+
+    const QUuid sent = m_aliases.contains(uuid) ? m_aliases.take(uuid) : uuid;
+    if (m_acknowledgeRequests.contains(sent)) {
+        auto it = m_acknowledgements.find(m_acknowledgeRequests.take(sent));
+        if (it != m_acknowledgements.end())
+            it->requestSent = it->posted.elapsed();
+        return;
+    }
+    if (m_batches.contains(sent)) {
+        foreach (const QUuid &member, m_batches.take(sent))
+            onSentSuccessfully(member);
+        return;
+    }
+    if (!m_chunks.remove(sent))
+        emit sentSuccessfully(sent);
+    onDocumentDone(sent);
+}
 
-    QList<QUuid> keys = m_packageHash.keys(path);
-    if (keys.count() == 1) {
-        m_packageHash.remove(keys.at(0));
-        emit sentSuccessfully(keys.at(0));
+void RemotePublisher::onSuperseded(const QUuid &uuid)
+{
+    if (m_signatureRequests.contains(uuid)) {
+        resolveHeld(m_signatureRequests.take(uuid), QByteArray());
+        return;
     }
+
+    const QUuid superseded = m_aliases.contains(uuid) ? m_aliases.take(uuid) : uuid;
+    emit this->superseded(superseded);
+    onDocumentDone(superseded);
 }
 
 void RemotePublisher::onSendingError(const QUuid &uuid, QAbstractSocket::SocketError socketError)
 {
-    QString path = m_packageHash.value(uuid);
-    m_packageHash.remove(uuid);
+    if (m_signatureRequests.contains(uuid)) {
+        resolveHeld(m_signatureRequests.take(uuid), QByteArray());
+        return;
+    }
 
-    QList<QUuid> keys = m_packageHash.keys(path);
-    if (keys.count() == 1) {
-        m_packageHash.remove(keys.at(0));
-        emit sendingError(keys.at(0), socketError);
+    sendPendingState(uuid);
+
+    const QUuid failed = m_aliases.contains(uuid) ? m_aliases.take(uuid) : uuid;
+    if (m_acknowledgeRequests.contains(failed)) {
+        const Acknowledgement acknowledgement = m_acknowledgements.take(m_acknowledgeRequests.take(failed));
+        foreach (const QUuid &member, acknowledgement.uuids)
+            m_unacknowledged.remove(member);
+        return;
+    }
+    if (m_batches.contains(failed)) {
+        foreach (const QUuid &member, m_batches.take(failed))
+            onSendingError(member, socketError);
+        return;
     }
+    if (!m_chunks.remove(failed))
+        emit sendingError(failed, socketError);
+    onDocumentDone(failed);
 }
 
 
@@ -269,37 +1059,96 @@ void RemotePublisher::handleCall(const QString &method, const QByteArray &conten
 {
     DEBUG << "RemotePublisher::handleIpcCall: " << method << content;
 
-    if (method == "needsPinAuthentication()") {
+    const int id = m_dispatcher->methodId(method);
+    if (id >= 0 && !m_dispatcher->dispatch(id, content))
+        qWarning() << "Invalid arguments to remote call" << method;
+}
+
+void RemotePublisher::registerCalls()
+{
+    m_dispatcher->on(RemoteProtocol::needsPinAuthentication, [this]() {
         qDebug() << "needsPinAuthentication";
         emit needsPinAuthentication();
-    } else if (method == "pinOK(bool)") {
-        qDebug() << "pinOk" << content.toInt();
-        emit pinOk(content.toInt());
-    } else if (method == "needsPublishWorkspace()") {
-        emit needsPublishWorkspace();
-    } else if (method == "qmlLog(QtMsgType, QString, QUrl, int, int)") {
-        int msgType;
-        QString description;
-        QUrl url;
-        int line = -1;
-        int column = -1;
-
-        QDataStream in(content);
-        in >> msgType;
-        in >> description;
-        in >> url;
-        in >> line;
-        in >> column;
+    });
+    m_dispatcher->on(RemoteProtocol::pinOk, [this](const IpcRawContent &ok) {
+        qDebug() << "pinOk" << ok.data.toInt();
+        emit pinOk(ok.data.toInt());
+        // Nodes predating ready() accept calls from now on
+        if (ok.data.toInt())
+            replayJournal();
+    });
+    m_dispatcher->on(RemoteProtocol::ready, [this]() {
+        replayJournal();
+    });
+
+    m_dispatcher->on(RemoteProtocol::supportsDocumentDelta, [this]() {
+        m_deltaSupported = true;
+    });
+    m_dispatcher->on(RemoteProtocol::supportsChunkedDocument, [this]() {
+        m_chunkedSupported = true;
+    });
+    m_dispatcher->on(RemoteProtocol::supportsDocumentBatch, [this]() {
+        m_batchSupported = true;
+    });
+    m_dispatcher->on(RemoteProtocol::supportsAcknowledge, [this]() {
+        m_acknowledgeSupported = true;
+    });
 
+    m_dispatcher->on(RemoteProtocol::acknowledge, [this](quint32 sequence, qint64 applied, qint64 reloaded) {
+        if (!m_acknowledgements.contains(sequence))
+            return;
+
+        const Acknowledgement acknowledgement = m_acknowledgements.take(sequence);
+        const qint64 elapsed = acknowledgement.posted.elapsed();
+        // The node answers only after the reload, this is not network time
+        const qint64 held = reloaded >= 0 ? qMax(reloaded - applied, qint64(0)) : 0;
+        const qint64 roundTrip = acknowledgement.requestSent >= 0
+                ? qMax(elapsed - acknowledgement.requestSent - held, qint64(0)) : -1;
+        // Until the node showed the changes, without the way back
+        const qint64 applyLatency = elapsed - (roundTrip > 0 ? roundTrip / 2 : 0);
+
+        foreach (const QUuid &uuid, acknowledgement.uuids) {
+            m_unacknowledged.remove(uuid);
+            emit acknowledged(uuid);
+        }
+        emit latencyMeasured(roundTrip, applyLatency);
+    });
+
+    m_dispatcher->on(RemoteProtocol::documentSignature, [this](const QString &document, const QByteArray &signature) {
+        resolveHeld(document, signature);
+    });
+    m_dispatcher->on(RemoteProtocol::documentDeltaFailed, [this](const QString &document) {
+        qWarning() << "Node failed to apply delta, sending whole document" << document;
+        // The node answers before acknowledging the delta. It is only
+        // acknowledged together with the whole document now.
+        const QUuid failed = m_deltas.take(document);
+        const QUuid uuid = postDocument(LiveDocument(document), false);
+        if (!uuid.isNull() && forgetAcknowledgement(failed)) {
+            if (m_changes.uuids.isEmpty())
+                m_changes.posted.start();
+            m_changes.uuids.append(failed);
+        }
+        awaitAcknowledgement(uuid, contentLane());
+    });
+
+    m_dispatcher->on(RemoteProtocol::needsPublishWorkspace, [this](const IpcRawContent &content) {
+        // Nodes sending a manifest only need the documents they are missing
+        const ContentManifest manifest = ContentManifest::fromData(content.data);
+        if (manifest.isValid())
+            emit needsWorkspaceUpdate(manifest);
+        else
+            emit needsPublishWorkspace();
+    });
+
+    m_dispatcher->on(RemoteProtocol::qmlLog, [this](int msgType, const QString &description, const QUrl &url,
+                                                   int line, int column) {
         emit remoteLog(msgType, description, url, line, column);
-    } else if (method == "clearLog()") {
+    });
+    m_dispatcher->on(RemoteProtocol::clearLog, [this]() {
         emit clearLog();
-    } else if (method == "activeDocumentChanged(QString)") {
-        QString path;
-
-        QDataStream in(content);
-        in >> path;
+    });
 
+    m_dispatcher->on(RemoteProtocol::activeDocumentChanged, [this](const QString &path) {
         if (path.isEmpty() || !QDir::isRelativePath(path)) {
             qCritical() << "Invalid argument to remote call activeDocumentChanged."
                         << "Relative file path expected:" << path;
@@ -307,7 +1156,7 @@ void RemotePublisher::handleCall(const QString &method, const QByteArray &conten
         }
 
         emit activeDocumentChanged(LiveDocument(path));
-    }
+    });
 }
 
 /*!
@@ -363,6 +1212,43 @@ void RemotePublisher::handleCall(const QString &method, const QByteArray &conten
  * to indicate the client asks for (re)sending all workspace documents.
  */
 
+/*!
+ * \fn RemotePublisher::needsWorkspaceUpdate(const ContentManifest &manifest)
+ *
+ * The signal is emitted instead of needsPublishWorkspace() when the client
+ * reports the documents it already has with a \a manifest. Only documents
+ * which are missing or differ need to be sent.
+ *
+ * The documents are sent by the publisher when a hub was set, see
+ * setHub() and registerHub().
+ *
+ * \sa WorkspaceSync, updatingWorkspace()
+ */
+
+/*!
+ * \fn RemotePublisher::updatingWorkspace(const QList<QUuid> &uuids)
+ *
+ * The signal is emitted after the documents missing or outdated on the node
+ * were queued in answer to needsWorkspaceUpdate(), \a uuids identify their
+ * packages.
+ */
+
+/*!
+ * \fn RemotePublisher::superseded(const QUuid &uuid)
+ *
+ * The signal is emitted when the package \a uuid was still queued when a
+ * newer version of the same document or activation was sent. It will not be
+ * sent, neither sentSuccessfully() nor sendingError() follow for it.
+ */
+
+/*!
+ * \fn RemotePublisher::sendProgress(qint64 bytesSent, qint64 bytesTotal)
+ *
+ * The signal is emitted while documents are being sent. \a bytesSent of the
+ * \a bytesTotal bytes of document content queued since the last time all
+ * documents were sent have been sent, or failed to be.
+ */
+
 /*!
  * \fn RemotePublisher::activeDocumentChanged(const LiveDocument &document)
  *
@@ -375,6 +1261,25 @@ void RemotePublisher::handleCall(const QString &method, const QByteArray &conten
  * The signal is emitted after the package identified by \a uuid has been send
  */
 
+/*!
+ * \fn RemotePublisher::acknowledged(const QUuid &uuid)
+ *
+ * The signal is emitted when the node applied the package \a uuid and
+ * reloaded its view if needed. It follows sentSuccessfully() for packages
+ * isAwaitingAcknowledgement() returns true for.
+ */
+
+/*!
+ * \fn RemotePublisher::latencyMeasured(qint64 roundTrip, qint64 applyLatency)
+ *
+ * The signal is emitted with each acknowledgement from the node. \a roundTrip
+ * is the time in milliseconds the acknowledgement took from the hub to the
+ * node and back, without the time the node waited for its view to reload.
+ * \a applyLatency is the estimated time in milliseconds from sending the
+ * first acknowledged change until the node showed it. \a roundTrip is -1
+ * if it could not be measured.
+ */
+
 /*!
  * \fn RemotePublisher::sendingError(const QUuid &uuid, QAbstractSocket::SocketError socketError)
  *
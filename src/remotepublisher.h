@@ -35,34 +35,50 @@
 #include <QtCore>
 #include <QAbstractSocket>
 
+#include "contentmanifest.h"
 #include "qmllive_global.h"
 
+#include <functional>
+#include <type_traits>
+
 class LiveDocument;
 class LiveHubEngine;
 class IpcClient;
+class WorkspaceSync;
+class IpcDispatcher;
+template <typename... Args> class IpcMethod;
 
 class QMLLIVESHARED_EXPORT RemotePublisher : public QObject
 {
     Q_OBJECT
 public:
     explicit RemotePublisher(QObject *parent = 0);
+    ~RemotePublisher();
     void connectToServer(const QString& hostName, int port);
     QString errorToString(QAbstractSocket::SocketError error);
     QAbstractSocket::SocketState state() const;
+    bool isAwaitingAcknowledgement(const QUuid &uuid) const;
 
     void registerHub(LiveHubEngine *hub);
+    void setHub(LiveHubEngine *hub);
 Q_SIGNALS:
     void connected();
     void disconnected();
     void sentSuccessfully(const QUuid& uuid);
+    void acknowledged(const QUuid &uuid);
+    void latencyMeasured(qint64 roundTrip, qint64 applyLatency);
+    void superseded(const QUuid& uuid);
     void sendingError(const QUuid& uuid, QAbstractSocket::SocketError socketError);
     void connectionError(QAbstractSocket::SocketError error);
     void needsPinAuthentication();
     void needsPublishWorkspace();
+    void needsWorkspaceUpdate(const ContentManifest &manifest);
+    void updatingWorkspace(const QList<QUuid> &uuids);
     void activeDocumentChanged(const LiveDocument &document);
     void pinOk(bool ok);
     void remoteLog(int type, const QString &msg, const QUrl &url = QUrl(), int line = -1, int column = -1);
     void clearLog();
+    void sendProgress(qint64 bytesSent, qint64 bytesTotal);
 
 public Q_SLOTS:
     void setWorkspace(const QString &path);
@@ -71,22 +87,121 @@ public Q_SLOTS:
     QUuid beginBulkSend();
     QUuid endBulkSend();
     QUuid sendDocument(const LiveDocument& document);
+    QUuid removeDocument(const LiveDocument& document);
     QUuid checkPin(const QString& pin);
     QUuid setXOffset(int offset);
     QUuid setYOffset(int offset);
     QUuid setRotation(int rotation);
+    void replayJournal();
 
 private Q_SLOTS:
     void handleCall(const QString &method, const QByteArray &content);
     QUuid sendWholeDocument(const LiveDocument &document);
+    QUuid sendDocumentDelta(const LiveDocument &document);
+    QUuid sendDocumentChunked(const LiveDocument &document);
+    void updateWorkspace(const ContentManifest &manifest);
+    void onWorkspaceCompared();
 
     void onSentSuccessfully(const QUuid& uuid);
     void onSendingError(const QUuid& uuid, QAbstractSocket::SocketError socketError);
+    void onDocumentDone(const QUuid& uuid);
+    void onDisconnected();
+    void onSuperseded(const QUuid& uuid);
+
+private:
+    struct Outgoing
+    {
+        QUuid uuid;
+        QString method;
+        QByteArray data;
+        std::function<QByteArray()> producer;
+        QString key;
+        int lane;
+        QString awaiting;
+    };
+
+    struct Acknowledgement
+    {
+        QList<QUuid> uuids;
+        QElapsedTimer posted;
+        qint64 requestSent = -1;
+        int lane = 0;
+    };
+
+    struct PendingState
+    {
+        QUuid uuid;
+        QByteArray data;
+    };
+
+    struct BatchEntry
+    {
+        QUuid uuid;
+        QString path;
+        QString document;
+    };
+
+    void registerCalls();
+    // lane is an IpcClient::Lane
+    template <typename... Args>
+    QUuid post(int lane, const IpcMethod<Args...> &method, const typename std::common_type<Args>::type &... args);
+    QUuid post(int lane, const QString &method, const QByteArray &data, const QString &key = QString());
+    QUuid post(int lane, const QString &method, const std::function<QByteArray()> &producer,
+               const QString &key = QString());
+    template <typename... Args>
+    QUuid postState(const IpcMethod<Args...> &method, const typename std::common_type<Args>::type &... args);
+    QUuid postState(const QString &method, const QByteArray &data);
+    void sendPendingState(const QUuid &uuid);
+    void postOutgoing(const Outgoing &outgoing);
+    void sendOutgoing(const Outgoing &outgoing);
+    int contentLane() const;
+    bool isHeld(const QString &document) const;
+    QUuid batchDocument(const QString &path, const QString &document, qint64 size);
+    void flushBatch();
+    QUuid postDocument(const LiveDocument &document, bool allowDelta);
+    QUuid awaitAcknowledgement(const QUuid &uuid, int lane);
+    bool forgetAcknowledgement(const QUuid &uuid);
+    void requestAcknowledgement();
+    void resolveHeld(const QString &document, const QByteArray &signature);
+    static QString documentKey(const QString &document);
+    static std::function<QByteArray()> wholeDocument(const QString &path, const QString &document);
+    QList<Outgoing> documentChunks(const QString &path, const QString &document, int lane, const QUuid &uuid);
+    static std::function<QByteArray()> documentChunk(const QString &path, const QString &document,
+                                                     qint64 mtime, qint64 size,
+                                                     qint64 offset, qint64 length);
 
 private:
     IpcClient *m_ipc;
     LiveHubEngine *m_hub;
     QDir m_workspace;
+    QString m_activeDocument;
+    QPointer<WorkspaceSync> m_workspaceSync;
+
+    bool m_deltaSupported;
+    bool m_chunkedSupported;
+    QSet<QUuid> m_chunks;
+    bool m_batchSupported;
+    bool m_bulkSend;
+    QList<BatchEntry> m_batch;
+    qint64 m_batchSize;
+    QHash<QUuid, QList<QUuid>> m_batches;
+    bool m_acknowledgeSupported;
+    quint32 m_acknowledgeSequence;
+    Acknowledgement m_changes;
+    QHash<quint32, Acknowledgement> m_acknowledgements;
+    QHash<QUuid, quint32> m_acknowledgeRequests;
+    QSet<QUuid> m_unacknowledged;
+    bool m_journaling;
+    QSet<QString> m_journal;
+    QHash<QUuid, QString> m_signatureRequests;
+    QHash<QString, QUuid> m_deltas;
+    QQueue<Outgoing> m_held;
+    QHash<QString, QUuid> m_statesInFlight;
+    QHash<QString, PendingState> m_pendingStates;
+    QHash<QUuid, QUuid> m_aliases;
+    QHash<QUuid, qint64> m_documentBytes;
+    qint64 m_bytesSent;
+    qint64 m_bytesTotal;
 
-    QHash<QUuid, QString> m_packageHash;
+    IpcDispatcher *m_dispatcher;
 };
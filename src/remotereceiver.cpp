@@ -33,9 +33,13 @@
 #include "remotereceiver.h"
 #include "ipc/ipcserver.h"
 #include "ipc/ipcclient.h"
+#include "ipc/ipcconnection.h"
 #include "livenodeengine.h"
+#include "contentmanifest.h"
+#include "deltasync.h"
+#include "remoteprotocol.h"
 
-#include <QTcpSocket>
+#include <QtConcurrent>
 
 #ifdef QMLLIVE_DEBUG
 #define DEBUG qDebug()
@@ -51,6 +55,17 @@
  *
  * Receives commands from a remote publisher to publish workspace files and to
  * setup the active document.
+ *
+ * When the publisher asks for it, the changes received so far are
+ * acknowledged after the registered LiveNodeEngine applied them and finished
+ * the reload they caused.
+ *
+ * Several publishers may be connected at the same time. Each connection is
+ * authenticated on its own and gets the log from its start. The document
+ * changes of all connections are applied one after the other; while a
+ * publisher is in the middle of a bulk send or a chunked document, the
+ * changes of the others wait and are applied together afterwards, so they
+ * cause a single reload.
  */
 
 /*!
@@ -78,23 +93,52 @@ RemoteReceiver::RemoteReceiver(QObject *parent)
     : QObject(parent)
     , m_server(new IpcServer(this))
     , m_node(0)
-    , m_connectionAcknowledged(false)
-    , m_socket(0)
-    , m_client(0)
-    , m_bulkUpdateInProgress(false)
+    , m_applying(false)
     , m_updateDocumentsOnConnectState(UpdateNotStarted)
-    , m_logSentPosition(0)
+    , m_manifestWatcher(new QFutureWatcher<ManifestEntry>(this))
+    , m_dispatcher(new IpcDispatcher)
 {
-    void (IpcServer::*IpcServer__clientConnected_socket)(QTcpSocket*) = &IpcServer::clientConnected;
+    registerCalls();
+    connect(m_manifestWatcher, &QFutureWatcherBase::finished, this, &RemoteReceiver::onManifestReady);
+
+    void (IpcServer::*IpcServer__clientConnected_transport)(IpcTransport*) = &IpcServer::clientConnected;
     void (IpcServer::*IpcServer__clientConnected_address)(const QHostAddress &) = &IpcServer::clientConnected;
+    void (IpcServer::*IpcServer__clientDisconnected_transport)(IpcTransport*) = &IpcServer::clientDisconnected;
     void (IpcServer::*IpcServer__clientDisconnected_address)(const QHostAddress &) = &IpcServer::clientDisconnected;
 
-    connect(m_server, &IpcServer::received, this, &RemoteReceiver::handleCall);
-    connect(m_server, IpcServer__clientConnected_socket, this, &RemoteReceiver::onClientConnected);
+    connect(m_server, &IpcServer::receivedFrom, this, &RemoteReceiver::handleCall);
+    connect(m_server, IpcServer__clientConnected_transport, this, &RemoteReceiver::onClientConnected);
     connect(m_server, IpcServer__clientConnected_address, this, &RemoteReceiver::clientConnected);
+    connect(m_server, IpcServer__clientDisconnected_transport, this, &RemoteReceiver::onClientDisconnected);
     connect(m_server, IpcServer__clientDisconnected_address, this, &RemoteReceiver::clientDisconnected);
 }
 
+/*!
+ * Destructor
+ */
+RemoteReceiver::~RemoteReceiver()
+{
+    delete m_dispatcher;
+}
+
+// Sends the call, if the hub is still connected. Answers the hub waits for
+// do not queue behind the log.
+template <typename... Args>
+void RemoteReceiver::send(const ConnectionPointer &connection, const IpcMethod<Args...> &method,
+                          const typename std::common_type<Args>::type &... args)
+{
+    if (!connection->client)
+        return;
+
+    // A failed delta is reported ahead of the acknowledgement covering it
+    const bool answer = method.id() == RemoteProtocol::PongId
+            || method.id() == RemoteProtocol::DocumentSignatureId
+            || method.id() == RemoteProtocol::DocumentDeltaFailedId
+            || method.id() == RemoteProtocol::AcknowledgeId;
+    connection->client->send(method.signature(), method.pack(args...), QString(),
+                             answer ? IpcClient::ControlLane : IpcClient::BulkLane);
+}
+
 /*!
  * Listens on remote publisher connections on \a port with given \a options. If
  * \a options contains BlockingConnect the return value indicates whether PIN
@@ -168,86 +212,237 @@ void RemoteReceiver::setMaxConnections(int max)
 }
 
 /*!
- * Handle RPC calls with \a method and data as \a content
+ * Handle RPC calls with \a method and data as \a content from the hub
+ * connected by \a transport
  */
-void RemoteReceiver::handleCall(const QString &method, const QByteArray &content)
+void RemoteReceiver::handleCall(IpcTransport *transport, const QString &method, const QByteArray &content)
 {
     DEBUG << "RemoteReceiver::handleIpcCall: " << method;
 
-    if (method == "checkPin(QString)") {
-        QString pin;
-        QDataStream in(content);
-        in >> pin;
-        if (m_pin == pin && m_client) {
-            m_connectionAcknowledged = true;
-            emit pinOk(true);
-            m_client->send("pinOK(bool)", QByteArray::number(1));
-            maybeStartUpdateDocumentsOnConnect();
-        } else if (m_client) {
-            emit pinOk(false);
-            m_client->send("pinOK(bool)", QByteArray::number(0));
-            return;
-        }
-    }
+    const ConnectionPointer connection = m_connections.value(transport);
+    if (!connection)
+        return;
 
-    if (!m_connectionAcknowledged) {
+    const int id = m_dispatcher->methodId(method);
+    if (id != RemoteProtocol::CheckPinId && !connection->authenticated) {
         qWarning() << "Connecting without Pin Authentication is not allowed";
         return;
     }
 
-    if (method == "setXOffset(int)") {
-        int offset;
-        QDataStream in(content);
-        in >> offset;
+    if (id < 0) {
+        DEBUG << "\tignoring unknown call";
+        return;
+    }
+
+    // Times the changes covered by the next acknowledgement
+    if (id != RemoteProtocol::RequestAcknowledgeId && id != RemoteProtocol::PingId
+            && !connection->applyTimer.isValid()) {
+        connection->applyTimer.start();
+    }
+
+    if (!changesNode(id)) {
+        dispatch(connection, id, method, content);
+        return;
+    }
+
+    Change change;
+    change.connection = connection;
+    change.id = id;
+    change.method = method;
+    change.content = content;
+    m_changes.enqueue(change);
+    ++connection->queuedChanges;
+    applyChanges();
+}
+
+void RemoteReceiver::dispatch(const ConnectionPointer &connection, int id, const QString &method,
+                              const QByteArray &content)
+{
+    const ConnectionPointer previous = m_current;
+    m_current = connection;
+    if (!m_dispatcher->dispatch(id, content))
+        qWarning() << "Invalid arguments to remote call" << method;
+    m_current = previous;
+}
+
+// Calls touching the documents go through the apply queue, so they are
+// ordered against the changes of other hubs
+bool RemoteReceiver::changesNode(int id)
+{
+    switch (id) {
+    case RemoteProtocol::CheckPinId:
+    case RemoteProtocol::SetXOffsetId:
+    case RemoteProtocol::SetYOffsetId:
+    case RemoteProtocol::SetRotationId:
+    case RemoteProtocol::PingId:
+        return false;
+    default:
+        return true;
+    }
+}
+
+// Applies the queued changes in arrival order. While a hub holds the node
+// with an open bulk send or chunked document, the changes of other hubs
+// wait, and are released together once it lets go.
+void RemoteReceiver::applyChanges()
+{
+    if (m_applying)
+        return;
+    m_applying = true;
+
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        QSet<Connection *> deferred;
+        QQueue<Change> remaining;
+        while (!m_changes.isEmpty()) {
+            const Change change = m_changes.dequeue();
+            Connection *connection = change.connection.data();
+            if (deferred.contains(connection) || (m_holder && m_holder != change.connection)) {
+                deferred.insert(connection);
+                remaining.enqueue(change);
+                continue;
+            }
+
+            dispatch(change.connection, change.id, change.method, change.content);
+            progress = true;
+            if (--connection->queuedChanges == 0 && connection->closed)
+                closeConnection(change.connection);
+        }
+        m_changes = remaining;
+    }
+
+    m_applying = false;
+}
+
+void RemoteReceiver::updateHolder(const ConnectionPointer &connection)
+{
+    if (connection->bulkUpdateInProgress || !connection->chunkedDocuments.isEmpty()) {
+        if (!m_holder)
+            m_holder = connection;
+    } else if (m_holder == connection) {
+        m_holder.clear();
+    }
+}
+
+void RemoteReceiver::registerCalls()
+{
+    m_dispatcher->on(RemoteProtocol::checkPin, [this](const QString &pin) {
+        if (!m_current->client)
+            return;
+        if (m_pin == pin) {
+            m_current->authenticated = true;
+            emit pinOk(true);
+            send(m_current, RemoteProtocol::pinOk, IpcRawContent{QByteArray::number(1)});
+            send(m_current, RemoteProtocol::ready);
+            maybeStartUpdateDocumentsOnConnect(m_current);
+        } else {
+            emit pinOk(false);
+            send(m_current, RemoteProtocol::pinOk, IpcRawContent{QByteArray::number(0)});
+        }
+    });
+
+    m_dispatcher->on(RemoteProtocol::setXOffset, [this](int offset) {
         emit xOffsetChanged(offset);
-    } else if (method == "setYOffset(int)") {
-        int offset;
-        QDataStream in(content);
-        in >> offset;
+    });
+    m_dispatcher->on(RemoteProtocol::setYOffset, [this](int offset) {
         emit yOffsetChanged(offset);
-    } else if (method == "setRotation(int)") {
-        int rotation;
-        QDataStream in(content);
-        in >> rotation;
+    });
+    m_dispatcher->on(RemoteProtocol::setRotation, [this](int rotation) {
         emit rotationChanged(rotation);
-    } else if (method == "beginBulkSend()") {
-        if (!m_bulkUpdateInProgress) {
-            m_bulkUpdateInProgress = true;
+    });
+
+    m_dispatcher->on(RemoteProtocol::beginBulkSend, [this]() {
+        if (!m_current->bulkUpdateInProgress) {
+            m_current->bulkUpdateInProgress = true;
+            updateHolder(m_current);
             emit beginBulkUpdate();
-            if (m_updateDocumentsOnConnectState == UpdateRequested)
+            if (m_current->updatesOnConnect && m_updateDocumentsOnConnectState == UpdateRequested)
                 m_updateDocumentsOnConnectState = UpdateStarted;
         } else {
             qCritical() << "Ignoring nested 'beginBulkSend()' call";
         }
-    } else if (method == "endBulkSend()") {
-        if (m_bulkUpdateInProgress) {
-            m_bulkUpdateInProgress = false;
+    });
+    m_dispatcher->on(RemoteProtocol::endBulkSend, [this]() {
+        if (m_current->bulkUpdateInProgress) {
+            m_current->bulkUpdateInProgress = false;
+            updateHolder(m_current);
             emit endBulkUpdate();
-            if (m_updateDocumentsOnConnectState == UpdateStarted) {
+            if (m_current->updatesOnConnect && m_updateDocumentsOnConnectState == UpdateStarted) {
                 m_updateDocumentsOnConnectState = UpdateFinished;
-                finishConnectionInitialization();
+                m_current->updatesOnConnect = false;
+                finishConnectionInitialization(m_current);
                 emit updateDocumentsOnConnectFinished(true);
             }
         } else {
             qCritical() << "Ignoring unpaired 'endBulkSend()' call";
         }
-    } else if (method == "sendDocument(QString,QByteArray)") {
-        QString document;
-        QByteArray data;
-        QDataStream in(content);
-        in >> document;
-        in >> data;
+    });
+
+    m_dispatcher->on(RemoteProtocol::sendDocument, [this](const QString &document, const QByteArray &data) {
         emit updateDocument(LiveDocument(document), data);
-    } else if (method == "activateDocument(QString)") {
-        QString document;
-        QDataStream in(content);
-        in >> document;
+    });
+    m_dispatcher->on(RemoteProtocol::sendDocuments, [this](const RemoteProtocol::DocumentList &documents) {
+        DEBUG << "\treceived batch of" << documents.count() << "documents";
+        for (const auto &document : documents)
+            emit updateDocument(LiveDocument(document.first), document.second);
+    });
+
+    m_dispatcher->on(RemoteProtocol::beginDocument, [this](const QString &document, qint64 size) {
+        m_current->chunkedDocuments.insert(document);
+        updateHolder(m_current);
+        emit beginUpdateDocument(LiveDocument(document), size);
+    });
+    m_dispatcher->on(RemoteProtocol::sendDocumentChunk,
+                     [this](const QString &document, qint64 offset, const QByteArray &data) {
+        emit updateDocumentChunk(LiveDocument(document), offset, data);
+    });
+    m_dispatcher->on(RemoteProtocol::endDocument, [this](const QString &document) {
+        m_current->chunkedDocuments.remove(document);
+        updateHolder(m_current);
+        emit endUpdateDocument(LiveDocument(document));
+    });
+
+    m_dispatcher->on(RemoteProtocol::requestDocumentSignature, [this](const QString &document) {
+        // An empty signature makes the hub send the whole document
+        QByteArray signature;
+        QFile file(m_node->documentFile(LiveDocument(document)));
+        if (file.open(QIODevice::ReadOnly))
+            signature = DeltaSync::signature(file.readAll());
+        send(m_current, RemoteProtocol::documentSignature, document, signature);
+    });
+    m_dispatcher->on(RemoteProtocol::sendDocumentDelta, [this](const QString &document, const QByteArray &delta) {
+        QFile file(m_node->documentFile(LiveDocument(document)));
+        // The document could not have been sent whole if it was larger
+        const QByteArray data = file.open(QIODevice::ReadOnly)
+                ? DeltaSync::patch(file.readAll(), delta, IpcConnection::DefaultMaxContentSize) : QByteArray();
+        if (!data.isNull())
+            emit updateDocument(LiveDocument(document), data);
+        else
+            send(m_current, RemoteProtocol::documentDeltaFailed, document);
+    });
+
+    m_dispatcher->on(RemoteProtocol::removeDocument, [this](const QString &document) {
+        emit removeDocument(LiveDocument(document));
+    });
+    m_dispatcher->on(RemoteProtocol::activateDocument, [this](const QString &document) {
         qDebug() << "\tactivate document: " << document;
         emit activateDocument(LiveDocument(document));
-    } else if (method == "ping()") {
-        if (m_client)
-            m_client->send("pong()", QByteArray());
-    }
+    });
+
+    m_dispatcher->on(RemoteProtocol::ping, [this]() {
+        send(m_current, RemoteProtocol::pong);
+    });
+    m_dispatcher->on(RemoteProtocol::requestAcknowledge, [this](quint32 sequence) {
+        PendingAcknowledgement acknowledgement;
+        acknowledgement.sequence = sequence;
+        acknowledgement.applied = m_current->applyTimer.isValid() ? m_current->applyTimer.elapsed() : 0;
+        m_current->pendingAcknowledgements.append(acknowledgement);
+
+        // Changes are only visible after the reload they caused
+        if (!m_node->isReloadPending())
+            flushAcknowledgements(m_current);
+    });
 }
 
 /*!
@@ -260,8 +455,13 @@ void RemoteReceiver::registerNode(LiveNodeEngine *node)
     connect(m_node, &LiveNodeEngine::logErrors, this, &RemoteReceiver::appendToLog);
     connect(m_node, &LiveNodeEngine::clearLog, this, &RemoteReceiver::clearLog);
     connect(m_node, &LiveNodeEngine::activeDocumentChanged, this, &RemoteReceiver::onActiveDocumentChanged);
+    connect(m_node, &LiveNodeEngine::documentLoaded, this, &RemoteReceiver::onDocumentLoaded);
     connect(this, &RemoteReceiver::activateDocument, m_node, &LiveNodeEngine::loadDocument);
     connect(this, &RemoteReceiver::updateDocument, m_node, &LiveNodeEngine::updateDocument);
+    connect(this, &RemoteReceiver::beginUpdateDocument, m_node, &LiveNodeEngine::beginUpdateDocument);
+    connect(this, &RemoteReceiver::updateDocumentChunk, m_node, &LiveNodeEngine::updateDocumentChunk);
+    connect(this, &RemoteReceiver::endUpdateDocument, m_node, &LiveNodeEngine::endUpdateDocument);
+    connect(this, &RemoteReceiver::removeDocument, m_node, &LiveNodeEngine::removeDocument);
     connect(this, &RemoteReceiver::xOffsetChanged, m_node, &LiveNodeEngine::setXOffset);
     connect(this, &RemoteReceiver::yOffsetChanged, m_node, &LiveNodeEngine::setYOffset);
     connect(this, &RemoteReceiver::rotationChanged, m_node, &LiveNodeEngine::setRotation);
@@ -270,56 +470,139 @@ void RemoteReceiver::registerNode(LiveNodeEngine *node)
 /*!
  * Handles client connection and if required requests pin authentication
  */
-void RemoteReceiver::onClientConnected(QTcpSocket *socket)
+void RemoteReceiver::onClientConnected(IpcTransport *transport)
 {
-    if (m_client)
-        delete m_client;
+    ConnectionPointer connection(new Connection);
+    connection->client = new IpcClient(transport, this);
+    m_connections.insert(transport, connection);
 
-    m_client = new IpcClient(socket, this);
-
-    m_socket = socket;
+    send(connection, RemoteProtocol::supportsDocumentDelta);
+    send(connection, RemoteProtocol::supportsChunkedDocument);
+    send(connection, RemoteProtocol::supportsDocumentBatch);
+    send(connection, RemoteProtocol::supportsAcknowledge);
 
     if (!m_pin.isEmpty()) {
-        m_client->send("needsPinAuthentication()", QByteArray());
-        m_connectionAcknowledged = false;
+        send(connection, RemoteProtocol::needsPinAuthentication);
     } else {
-        m_connectionAcknowledged = true;
-        maybeStartUpdateDocumentsOnConnect();
+        connection->authenticated = true;
+        send(connection, RemoteProtocol::ready);
+        maybeStartUpdateDocumentsOnConnect(connection);
     }
 }
 
-void RemoteReceiver::onClientDisconnected(QTcpSocket *socket)
+void RemoteReceiver::onClientDisconnected(IpcTransport *transport)
 {
-    Q_ASSERT(socket == m_socket);
-    Q_UNUSED(socket);
+    const ConnectionPointer connection = m_connections.take(transport);
+    if (!connection)
+        return;
 
-    if (m_updateDocumentsOnConnectState != UpdateNotStarted) {
-        if (m_updateDocumentsOnConnectState != UpdateFinished) {
-            emit updateDocumentsOnConnectFinished(false);
-            m_updateDocumentsOnConnectState = UpdateFinished;
-        }
+    connection->closed = true;
+    connection->client->deleteLater();
+    connection->client = 0;
+
+    if (connection->updatesOnConnect) {
+        connection->updatesOnConnect = false;
+        m_updateDocumentsOnConnectState = UpdateFinished;
+        emit updateDocumentsOnConnectFinished(false);
+    }
+
+    // Changes still queued are applied before the connection is closed
+    if (connection->queuedChanges == 0) {
+        closeConnection(connection);
+        applyChanges();
     }
-    if (m_bulkUpdateInProgress)
+}
+
+void RemoteReceiver::closeConnection(const ConnectionPointer &connection)
+{
+    if (connection->bulkUpdateInProgress) {
+        connection->bulkUpdateInProgress = false;
         emit endBulkUpdate();
+    }
+
+    // The remaining chunks will not arrive, incomplete documents are discarded
+    foreach (const QString &document, connection->chunkedDocuments)
+        emit endUpdateDocument(LiveDocument(document));
+    connection->chunkedDocuments.clear();
+
+    connection->pendingAcknowledgements.clear();
+    connection->applyTimer.invalidate();
+    connection->reloaded = -1;
+
+    updateHolder(connection);
 }
-void RemoteReceiver::maybeStartUpdateDocumentsOnConnect()
+
+void RemoteReceiver::maybeStartUpdateDocumentsOnConnect(const ConnectionPointer &connection)
 {
     if (m_connectionOptions & UpdateDocumentsOnConnect
             && m_updateDocumentsOnConnectState == UpdateNotStarted) {
-        m_client->send("needsPublishWorkspace()", QByteArray());
         m_updateDocumentsOnConnectState = UpdateRequested;
+        connection->updatesOnConnect = true;
+
+        // Hash the documents we have, so the hub only needs to send the
+        // difference. Files unchanged since a previous connection reuse
+        // their cached hash.
+        QList<ManifestEntry> entries;
+        const QHash<QString, QString> files = m_node->documentFiles();
+        for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+            ManifestEntry entry = m_manifestCache.value(it.value());
+            entry.document = it.key();
+            entry.path = it.value();
+            entries.append(entry);
+        }
+        m_manifestWatcher->setFuture(QtConcurrent::mapped(entries, &RemoteReceiver::hashEntry));
     } else {
-        finishConnectionInitialization();
+        finishConnectionInitialization(connection);
     }
 }
 
-void RemoteReceiver::finishConnectionInitialization()
+void RemoteReceiver::onManifestReady()
+{
+    if (m_manifestWatcher->isCanceled())
+        return;
+
+    ContentManifest manifest;
+    manifest.setValid(true);
+    m_manifestCache.clear();
+    const QList<ManifestEntry> entries = m_manifestWatcher->future().results();
+    foreach (const ManifestEntry &entry, entries) {
+        if (entry.hash.isNull())
+            continue;
+        manifest.insert(entry.document, entry.hash);
+        m_manifestCache.insert(entry.path, entry);
+    }
+
+    if (m_updateDocumentsOnConnectState != UpdateRequested)
+        return;
+
+    // Nobody to ask if the hub disconnected while hashing
+    foreach (const ConnectionPointer &connection, m_connections) {
+        if (!connection->updatesOnConnect)
+            continue;
+        DEBUG << "Requesting workspace, manifest of" << manifest.count() << "documents";
+        send(connection, RemoteProtocol::needsPublishWorkspace, IpcRawContent{manifest.toData()});
+    }
+}
+
+RemoteReceiver::ManifestEntry RemoteReceiver::hashEntry(const ManifestEntry &entry)
+{
+    const QFileInfo info(entry.path);
+    ManifestEntry result = entry;
+    result.mtime = info.lastModified().toMSecsSinceEpoch();
+    result.size = info.size();
+    // Updates replace the files of the node atomically, so they can be mapped
+    if (entry.hash.isNull() || result.mtime != entry.mtime || result.size != entry.size)
+        result.hash = ContentHash::fromFile(entry.path, ContentHash::Mapped);
+    return result;
+}
+
+void RemoteReceiver::finishConnectionInitialization(const ConnectionPointer &connection)
 {
     if (!m_node->activeDocument().isNull())
-        onActiveDocumentChanged(m_node->activeDocument());
+        send(connection, RemoteProtocol::activeDocumentChanged, m_node->activeDocument().relativeFilePath());
 
-    m_logSentPosition = 0;
-    flushLog();
+    connection->logSentPosition = 0;
+    flushLog(connection);
 }
 
 /*!
@@ -329,16 +612,16 @@ void RemoteReceiver::appendToLog(const QList<QQmlError> &errors)
 {
     m_log.append(errors);
 
-    if (!m_client)
-        return;
-
-    flushLog();
+    foreach (const ConnectionPointer &connection, m_connections) {
+        if (connection->authenticated)
+            flushLog(connection);
+    }
 }
 
-void RemoteReceiver::flushLog()
+void RemoteReceiver::flushLog(const ConnectionPointer &connection)
 {
-    for (; m_logSentPosition < m_log.count(); ++m_logSentPosition) {
-        const QQmlError &err = m_log.at(m_logSentPosition);
+    for (; connection->logSentPosition < m_log.count(); ++connection->logSentPosition) {
+        const QQmlError &err = m_log.at(connection->logSentPosition);
         if (!err.isValid())
             continue;
 
@@ -351,30 +634,46 @@ void RemoteReceiver::flushLog()
         else if (err.description().contains(QString::fromLatin1("warning"), Qt::CaseInsensitive))
             type = QtWarningMsg;
 
-        QByteArray bytes;
-        QDataStream out(&bytes, QIODevice::WriteOnly);
-        out << type;
-        out << err.description();
-        out << err.url();
-        out << err.line();
-        out << err.column();
+        send(connection, RemoteProtocol::qmlLog, int(type), err.description(), err.url(), err.line(), err.column());
+    }
+}
+
+void RemoteReceiver::onDocumentLoaded()
+{
+    foreach (const ConnectionPointer &connection, m_connections) {
+        if (!connection->applyTimer.isValid())
+            continue;
 
-        m_client->send("qmlLog(QtMsgType, QString, QUrl, int, int)", bytes);
+        connection->reloaded = connection->applyTimer.elapsed();
+        if (!connection->pendingAcknowledgements.isEmpty() && !m_node->isReloadPending())
+            flushAcknowledgements(connection);
     }
 }
 
+// Acknowledges everything received so far on the connection, the next call
+// starts a new measurement
+void RemoteReceiver::flushAcknowledgements(const ConnectionPointer &connection)
+{
+    foreach (const PendingAcknowledgement &acknowledgement, connection->pendingAcknowledgements)
+        send(connection, RemoteProtocol::acknowledge, acknowledgement.sequence, acknowledgement.applied,
+             connection->reloaded);
+    connection->pendingAcknowledgements.clear();
+    connection->applyTimer.invalidate();
+    connection->reloaded = -1;
+}
+
 /*!
  * Called to clear remote logging output
  */
 void RemoteReceiver::clearLog()
 {
     m_log.clear();
-    m_logSentPosition = 0;
 
-    if (!m_client)
-        return;
-
-    m_client->send("clearLog()", QByteArray());
+    foreach (const ConnectionPointer &connection, m_connections) {
+        connection->logSentPosition = 0;
+        if (connection->authenticated)
+            send(connection, RemoteProtocol::clearLog);
+    }
 }
 
 /*!
@@ -382,14 +681,10 @@ void RemoteReceiver::clearLog()
  */
 void RemoteReceiver::onActiveDocumentChanged(const LiveDocument &document)
 {
-    if (!m_client)
-        return;
-
-    QByteArray bytes;
-    QDataStream out(&bytes, QIODevice::WriteOnly);
-    out << document.relativeFilePath();
-
-    m_client->send("activeDocumentChanged(QString)", bytes);
+    foreach (const ConnectionPointer &connection, m_connections) {
+        if (connection->authenticated)
+            send(connection, RemoteProtocol::activeDocumentChanged, document.relativeFilePath());
+    }
 }
 
 /*!
@@ -466,3 +761,30 @@ void RemoteReceiver::onActiveDocumentChanged(const LiveDocument &document)
  *
  * This signal is emitted to notify that a \a document has changed its \a content
  */
+
+/*!
+ * \fn void RemoteReceiver::beginUpdateDocument(const LiveDocument &document, qint64 size)
+ *
+ * This signal is emitted when the content of \a document with \a size bytes
+ * starts to arrive in chunks.
+ */
+
+/*!
+ * \fn void RemoteReceiver::updateDocumentChunk(const LiveDocument &document, qint64 offset, const QByteArray &data)
+ *
+ * This signal is emitted for each chunk \a data of the \a document content
+ * at \a offset.
+ */
+
+/*!
+ * \fn void RemoteReceiver::endUpdateDocument(const LiveDocument &document)
+ *
+ * This signal is emitted after the last chunk of \a document. The content is
+ * incomplete if the connection was lost.
+ */
+
+/*!
+ * \fn void RemoteReceiver::removeDocument(const LiveDocument &document)
+ *
+ * This signal is emitted to notify that a \a document was removed
+ */
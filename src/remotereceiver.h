@@ -37,14 +37,19 @@
 
 #include <QQmlError>
 
+#include "contenthash.h"
 #include "qmllive_global.h"
 
+#include <type_traits>
+
 class LiveDocument;
 class LiveNodeEngine;
 class IpcServer;
 class IpcClient;
+class IpcDispatcher;
+template <typename... Args> class IpcMethod;
 
-QT_FORWARD_DECLARE_CLASS(QTcpSocket);
+class IpcTransport;
 
 class QMLLIVESHARED_EXPORT RemoteReceiver : public QObject
 {
@@ -74,6 +79,7 @@ public:
 
 public:
     explicit RemoteReceiver(QObject *parent = 0);
+    ~RemoteReceiver();
     bool listen(int port, ConnectionOptions options = NoConnectionOption);
     void registerNode(LiveNodeEngine *node);
     void setPin(const QString& pin);
@@ -94,38 +100,98 @@ Q_SIGNALS:
     void endBulkUpdate();
     void updateDocumentsOnConnectFinished(bool ok);
     void updateDocument(const LiveDocument &document, const QByteArray &content);
+    void beginUpdateDocument(const LiveDocument &document, qint64 size);
+    void updateDocumentChunk(const LiveDocument &document, qint64 offset, const QByteArray &data);
+    void endUpdateDocument(const LiveDocument &document);
+    void removeDocument(const LiveDocument &document);
 
 private Q_SLOTS:
-    void handleCall(const QString& method, const QByteArray& content);
+    void handleCall(IpcTransport *transport, const QString& method, const QByteArray& content);
 
     void appendToLog(const QList<QQmlError> &errors);
     void clearLog();
     void onActiveDocumentChanged(const LiveDocument &document);
+    void onDocumentLoaded();
 
-    void onClientConnected(QTcpSocket *socket);
-    void onClientDisconnected(QTcpSocket *socket);
-    void maybeStartUpdateDocumentsOnConnect();
-    void finishConnectionInitialization();
+    void onClientConnected(IpcTransport *transport);
+    void onClientDisconnected(IpcTransport *transport);
+    void onManifestReady();
 
 private:
-    void flushLog();
+    struct ManifestEntry
+    {
+        QString document;
+        QString path;
+        qint64 mtime = -1;
+        qint64 size = -1;
+        ContentHash hash;
+    };
+
+    struct PendingAcknowledgement
+    {
+        quint32 sequence;
+        qint64 applied;
+    };
+
+    struct Connection
+    {
+        IpcClient *client = 0;
+        bool authenticated = false;
+        bool closed = false;
+        bool updatesOnConnect = false;
+        bool bulkUpdateInProgress = false;
+        QSet<QString> chunkedDocuments;
+        int logSentPosition = 0;
+        int queuedChanges = 0;
+        QElapsedTimer applyTimer;
+        qint64 reloaded = -1;
+        QList<PendingAcknowledgement> pendingAcknowledgements;
+    };
+    typedef QSharedPointer<Connection> ConnectionPointer;
+
+    struct Change
+    {
+        ConnectionPointer connection;
+        int id;
+        QString method;
+        QByteArray content;
+    };
+
+    void registerCalls();
+    template <typename... Args>
+    void send(const ConnectionPointer &connection, const IpcMethod<Args...> &method,
+              const typename std::common_type<Args>::type &... args);
+    void dispatch(const ConnectionPointer &connection, int id, const QString &method, const QByteArray &content);
+    static bool changesNode(int id);
+    void applyChanges();
+    void updateHolder(const ConnectionPointer &connection);
+    void closeConnection(const ConnectionPointer &connection);
+    void maybeStartUpdateDocumentsOnConnect(const ConnectionPointer &connection);
+    void finishConnectionInitialization(const ConnectionPointer &connection);
+    void flushLog(const ConnectionPointer &connection);
+    void flushAcknowledgements(const ConnectionPointer &connection);
+    static ManifestEntry hashEntry(const ManifestEntry &entry);
 
 private:
     IpcServer *m_server;
     LiveNodeEngine *m_node;
 
     QString m_pin;
-    bool m_connectionAcknowledged;
 
-    QTcpSocket* m_socket;
-    IpcClient* m_client;
+    QHash<IpcTransport *, ConnectionPointer> m_connections;
+    ConnectionPointer m_current;
+    ConnectionPointer m_holder;
+    QQueue<Change> m_changes;
+    bool m_applying;
 
     ConnectionOptions m_connectionOptions;
-    bool m_bulkUpdateInProgress;
     UpdateState m_updateDocumentsOnConnectState;
+    QFutureWatcher<ManifestEntry> *m_manifestWatcher;
+    QHash<QString, ManifestEntry> m_manifestCache;
 
     QList<QQmlError> m_log;
-    int m_logSentPosition;
+
+    IpcDispatcher *m_dispatcher;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(RemoteReceiver::ConnectionOptions)
@@ -1,6 +1,6 @@
 !greaterThan(QT_MAJOR_VERSION, 4):error("You need at least Qt5 to build this application")
 
-QT *= quick quick-private qml-private network
+QT *= quick quick-private qml-private network concurrent
 CONFIG *= c++11
 
 INCLUDEPATH += $${PWD}
@@ -8,6 +8,15 @@ DEFINES += NO_LIBRSYNC
 
 SOURCES += \
     $$PWD/watcher.cpp \
+    $$PWD/directoryscanner.cpp \
+    $$PWD/directorysnapshot.cpp \
+    $$PWD/directorypoller.cpp \
+    $$PWD/ignorematcher.cpp \
+    $$PWD/contenthash.cpp \
+    $$PWD/contentmanifest.cpp \
+    $$PWD/deltasync.cpp \
+    $$PWD/documentframecache.cpp \
+    $$PWD/workspacesync.cpp \
     $$PWD/livedocument.cpp \
     $$PWD/livehubengine.cpp \
     $$PWD/livenodeengine.cpp \
@@ -15,6 +24,7 @@ SOURCES += \
     $$PWD/liveruntime.cpp \
     $$PWD/remotepublisher.cpp \
     $$PWD/remotereceiver.cpp \
+    $$PWD/remoteprotocol.cpp \
     $$PWD/imageadapter.cpp \
     $$PWD/contentpluginfactory.cpp \
     $$PWD/logger.cpp \
@@ -35,12 +45,22 @@ public_headers += \
     $$PWD/remotereceiver.h \
     $$PWD/contentadapterinterface.h \
     $$PWD/remotelogger.h \
-    $$PWD/projectmanager.h
+    $$PWD/projectmanager.h \
+    $$PWD/contenthash.h \
+    $$PWD/contentmanifest.h \
+    $$PWD/workspacesync.h
 
 HEADERS += \
     $$public_headers \
     $$PWD/qmllive_version.h \
     $$PWD/watcher.h \
+    $$PWD/directoryscanner.h \
+    $$PWD/directorysnapshot.h \
+    $$PWD/directorypoller.h \
+    $$PWD/ignorematcher.h \
+    $$PWD/deltasync.h \
+    $$PWD/documentframecache.h \
+    $$PWD/remoteprotocol.h \
     $$PWD/imageadapter.h \
     $$PWD/contentpluginfactory.h \
     $$PWD/fontadapter.h
@@ -58,4 +78,9 @@ OTHER_FILES += \
 RESOURCES += \
     $$PWD/livert.qrc
 
+linux {
+    SOURCES += $$PWD/inotifywatcher.cpp
+    HEADERS += $$PWD/inotifywatcher.h
+}
+
 include(ipc/ipc.pri)
@@ -31,6 +31,12 @@
 ****************************************************************************/
 
 #include "watcher.h"
+#include "directoryscanner.h"
+#include "directorypoller.h"
+
+#ifdef Q_OS_LINUX
+#include "inotifywatcher.h"
+#endif
 
 
 /*!
@@ -39,6 +45,18 @@
  \brief A class which watches Directories and notifies you about changes
 
  A class which watches Directories and notifies you about every change in this Directory or in it's SubDirectories
+
+ Depending on the backend() the changes are either reported per directory only
+ (QFileSystemWatcher) or additionally per individual file (inotify on Linux).
+
+ When more directories exist than can be watched, either because of
+ setMaximumWatches() or because the system runs out of watches, the remaining
+ directories are covered by a DirectoryPoller instead, see
+ setPollingFallback(). As the tree is scanned breadth first, the shallow
+ directories get the native watches. A polled directory in which files change
+ takes over the native watch of the directory that was least recently active.
+
+ Entries matched by the ignoreMatcher() are neither watched nor reported.
  */
 
 /*!
@@ -49,11 +67,29 @@
         No error
  \value MaximumReached
         The maximum number of watches set with setMaximumWatches() was exceeded
+        and pollingFallback() is disabled
  \value SystemError
-        QFileSystemWatcher::addPath failed for an unspecified reason
+        QFileSystemWatcher::addPath failed for an unspecified reason and
+        pollingFallback() is disabled
+ */
+
+/*!
+ \enum Watcher::Backend
+ \brief Selects the mechanism used to get notified about changes
+
+ \value DefaultBackend
+        InotifyBackend where available, FileSystemWatcherBackend otherwise
+ \value FileSystemWatcherBackend
+        QFileSystemWatcher, reports changed directories only
+ \value InotifyBackend
+        Linux inotify, reports individual created, modified, removed and
+        renamed files
  */
 
 int Watcher::s_maximumWatches = -1;
+Watcher::Backend Watcher::s_backend = Watcher::DefaultBackend;
+bool Watcher::s_pollingFallback = true;
+int Watcher::s_pollBudget = 5;
 
 /*!
  Default Constructor using parent as parent
@@ -61,12 +97,36 @@ int Watcher::s_maximumWatches = -1;
 Watcher::Watcher(QObject *parent)
     : QObject(parent)
     , m_watcher(new QFileSystemWatcher(this))
+    , m_inotify(0)
+    , m_poller(new DirectoryPoller(this))
+    , m_scanner(0)
     , m_waitTimer(new QTimer(this))
+    , m_quietPeriod(20)
+    , m_maximumLatency(500)
+    , m_burstEvents(0)
+    , m_ready(false)
 {
     connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &Watcher::recordChange);
     connect(m_waitTimer, &QTimer::timeout, this, &Watcher::notifyChanges);
-    m_waitTimer->setInterval(100);
     m_waitTimer->setSingleShot(true);
+    m_waitTimer->setTimerType(Qt::PreciseTimer);
+
+    connect(m_poller, &DirectoryPoller::fileChanged, this, &Watcher::recordFileChange);
+    connect(m_poller, &DirectoryPoller::fileRemoved, this, &Watcher::recordFileRemoval);
+    connect(m_poller, &DirectoryPoller::directoryCreated, this, &Watcher::recordChange);
+    connect(m_poller, &DirectoryPoller::directoryRemoved, this, &Watcher::recordChange);
+    m_clock.start();
+}
+
+/*!
+ Destructor, stops a running scan
+ */
+Watcher::~Watcher()
+{
+    cancelScan();
+    // Cancelled scans may still be busy finishing their current directory
+    foreach (DirectoryScanner *scanner, findChildren<DirectoryScanner *>())
+        scanner->wait();
 }
 
 /*!
@@ -74,13 +134,91 @@ Watcher::Watcher(QObject *parent)
 
  Every change within this Directory and it's sub Directories will be reported by
  the directoriesChanged() signal
+
+ The directory tree is enumerated on a worker thread, this call returns
+ immediately. Sub directories are watched as they are found, scanProgress()
+ is emitted on the way and ready() once all of them are watched. A scan
+ still running for the previous directory is cancelled.
  */
 void Watcher::setDirectory(const QString &path)
 {
+    cancelScan();
     m_rootDir = QDir(path);
     removeAllPaths();
+    initBackend();
+    m_poller->setBudget(s_pollBudget);
     setError(NoError);
-    addDirectoriesRecursively(m_rootDir.absolutePath());
+    m_ready = false;
+
+    m_scanner = new DirectoryScanner(m_rootDir.absolutePath(), m_ignore, this);
+    connect(m_scanner, &DirectoryScanner::directoriesFound, this, &Watcher::onDirectoriesFound);
+    connect(m_scanner, &QThread::finished, this, &Watcher::onScanFinished);
+    m_scanner->start(QThread::LowPriority);
+}
+
+/*!
+ Stops a running scan. Directories found so far stay watched, ready() will not
+ be emitted.
+ */
+void Watcher::cancelScan()
+{
+    if (!m_scanner)
+        return;
+
+    DirectoryScanner *scanner = m_scanner;
+    m_scanner = 0;
+    scanner->requestInterruption();
+    connect(scanner, &QThread::finished, scanner, &QObject::deleteLater);
+    if (scanner->isFinished())
+        scanner->deleteLater();
+}
+
+void Watcher::onDirectoriesFound(const QStringList &paths)
+{
+    // Batches may still be queued from a cancelled scan
+    if (sender() != m_scanner)
+        return;
+
+    foreach (const QString &path, paths) {
+        if (hasError())
+            break;
+        addDirectory(path);
+    }
+
+    if (hasError()) {
+        cancelScan();
+        return;
+    }
+
+    emit scanProgress(watchCount());
+}
+
+void Watcher::onScanFinished()
+{
+    if (sender() != m_scanner)
+        return;
+
+    m_scanner->deleteLater();
+    m_scanner = 0;
+    m_ready = true;
+    emit ready();
+}
+
+/*!
+ \fn Watcher::ignoreMatcher() const
+
+ Returns the rules deciding which directories and files are not watched
+ */
+
+/*!
+ Sets the rules deciding which directories and files are not watched to
+ \a ignore
+
+ This will only take effect with next setDirectory() call.
+ */
+void Watcher::setIgnoreMatcher(const IgnoreMatcher &ignore)
+{
+    m_ignore = ignore;
 }
 
 /*!
@@ -107,6 +245,183 @@ void Watcher::setMaximumWatches(int maximumWatches)
     s_maximumWatches = maximumWatches;
 }
 
+/*!
+ \fn Watcher::pollingFallback()
+
+ Returns true if directories which can not be watched natively are polled
+ */
+
+/*!
+ Enables or disables polling directories which can not be watched natively
+
+ When disabled, exceeding the watch limit stops watching altogether and sets
+ error(). Enabled by default. This will only take effect with next
+ setDirectory() call.
+ */
+void Watcher::setPollingFallback(bool enabled)
+{
+    s_pollingFallback = enabled;
+}
+
+/*!
+ \fn Watcher::pollBudget()
+
+ Returns the share of time in percent which may be spent polling
+ */
+
+/*!
+ Sets the share of time which may be spent polling to \a percent
+
+ A lower budget means less CPU usage but a longer delay until changes in
+ polled directories are noticed. This will only take effect with next
+ setDirectory() call.
+ */
+void Watcher::setPollBudget(int percent)
+{
+    s_pollBudget = qBound(1, percent, 100);
+}
+
+/*!
+ Returns the number of directories which are polled instead of watched
+ natively
+ */
+int Watcher::polledCount() const
+{
+    return m_poller->count();
+}
+
+/*!
+ \fn Watcher::backend()
+
+ Returns the requested backend
+ */
+
+/*!
+ Requests \a backend to be used for watching.
+
+ This will only take effect with next setDirectory() call. When the requested
+ backend is not available on this system, FileSystemWatcherBackend is used.
+ */
+void Watcher::setBackend(Watcher::Backend backend)
+{
+    s_backend = backend;
+}
+
+/*!
+ Returns the backend actually used by this watcher
+ */
+Watcher::Backend Watcher::activeBackend() const
+{
+    return m_inotify ? InotifyBackend : FileSystemWatcherBackend;
+}
+
+void Watcher::initBackend()
+{
+#ifdef Q_OS_LINUX
+    const bool wantInotify = s_backend == DefaultBackend || s_backend == InotifyBackend;
+    if (wantInotify && !m_inotify) {
+        m_inotify = new InotifyWatcher(this);
+        if (!m_inotify->isValid()) {
+            qWarning() << "inotify not available, falling back to QFileSystemWatcher";
+            delete m_inotify;
+            m_inotify = 0;
+            return;
+        }
+        connect(m_inotify, &InotifyWatcher::fileChanged, this, &Watcher::recordFileChange);
+        connect(m_inotify, &InotifyWatcher::fileRemoved, this, &Watcher::recordFileRemoval);
+        connect(m_inotify, &InotifyWatcher::directoryCreated, this, &Watcher::recordChange);
+        connect(m_inotify, &InotifyWatcher::directoryRemoved, this, &Watcher::recordChange);
+        connect(m_inotify, &InotifyWatcher::overflowed, this, &Watcher::recordOverflow);
+    } else if (!wantInotify && m_inotify) {
+        delete m_inotify;
+        m_inotify = 0;
+    }
+#endif
+}
+
+/*!
+ \fn Watcher::quietPeriod() const
+
+ Returns the time in milliseconds without any further event after which
+ recorded changes are notified
+ */
+
+/*!
+ Sets the quiet period to \a msecs
+
+ Changes are notified once no further event arrived for this long. Keep it
+ short, a single save pays it as latency.
+ */
+void Watcher::setQuietPeriod(int msecs)
+{
+    m_quietPeriod = qMax(0, msecs);
+}
+
+/*!
+ \fn Watcher::maximumLatency() const
+
+ Returns the maximum time in milliseconds changes are held back
+ */
+
+/*!
+ Sets the maximum latency to \a msecs
+
+ A burst of events that never quiets down, e.g. a checkout or a code
+ generator, is notified in slices at least this often.
+ */
+void Watcher::setMaximumLatency(int msecs)
+{
+    m_maximumLatency = qMax(0, msecs);
+}
+
+/*!
+ Returns counters about the coalesced change bursts and polling
+
+ \c bursts counts the notifications, \c events the raw events coalesced into
+ them and \c largestBurst the most events coalesced into one notification.
+ \c totalDelay and \c maximumDelay is the time in milliseconds the first event
+ of a burst was held back.
+
+ \c polledDirectories is the number of directories polled, \c pollCost the
+ average cost in nanoseconds to poll one of them and \c pollCycle the time in
+ milliseconds the last round over all of them took.
+ */
+Watcher::Statistics Watcher::statistics() const
+{
+    Statistics statistics = m_statistics;
+    statistics.polledDirectories = m_poller->count();
+    statistics.pollCost = m_poller->averageCost();
+    statistics.pollCycle = m_poller->cycleTime();
+    return statistics;
+}
+
+/*!
+ Resets all statistics() counters
+ */
+void Watcher::resetStatistics()
+{
+    m_statistics = Statistics();
+}
+
+/*!
+ \fn Watcher::isReady() const
+
+ Returns true once the initial scan of directory() finished and all sub
+ directories are watched
+ */
+
+/*!
+ \fn Watcher::scanProgress(int directories)
+
+ Reports the number of \a directories watched so far during the initial scan
+ */
+
+/*!
+ \fn Watcher::ready()
+
+ Emitted when the initial scan started by setDirectory() finished
+ */
+
 /*!
  \fn Watcher::hasError() const
 
@@ -131,36 +446,139 @@ void Watcher::setMaximumWatches(int maximumWatches)
 void Watcher::addDirectoriesRecursively(const QString &path)
 {
 //    qDebug() << "scan: " << path;
+    if (isIgnored(path, true))
+        return;
+
     addDirectory(path);
-    QDirIterator iter(path, QDir::Dirs|QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
-    while (iter.hasNext() && !hasError()) {
-        QDir entry(iter.next());
-        addDirectory(entry.absolutePath());
+    const int rootLength = m_rootDir.absolutePath().length() + 1;
+    // Walk manually so ignored directories are not descended into
+    QStack<QString> pending;
+    pending.push(path);
+    while (!pending.isEmpty() && !hasError()) {
+        QDirIterator iter(pending.pop(), QDir::Dirs|QDir::NoDotAndDotDot);
+        while (iter.hasNext() && !hasError()) {
+            QDir entry(iter.next());
+            if (m_ignore.matches(entry.absolutePath().mid(rootLength), true))
+                continue;
+            addDirectory(entry.absolutePath());
+            if (!iter.fileInfo().isSymLink())
+                pending.push(entry.absolutePath());
+        }
     }
 }
 
+/*!
+ Returns true if the ignoreMatcher() excludes \a path or one of its parents
+ below directory()
+ */
+bool Watcher::isIgnored(const QString &path, bool isDir) const
+{
+    if (m_ignore.isEmpty())
+        return false;
+    const QString root = m_rootDir.absolutePath();
+    if (path.length() <= root.length() || !path.startsWith(root))
+        return false;
+    return m_ignore.isIgnored(path.mid(root.length() + 1), isDir);
+}
+
 void Watcher::addDirectory(const QString &path)
 {
-    if (m_watcher->directories().contains(path))
+    if (isWatching(path))
         return;
 
-    if (s_maximumWatches > 0 &&
-            m_watcher->directories().count() + m_watcher->files().count() > s_maximumWatches) {
+    if (s_maximumWatches > 0 && watchCount() > s_maximumWatches) {
+        if (s_pollingFallback) {
+            m_poller->addPath(path);
+            return;
+        }
         removeAllPaths();
         setError(MaximumReached);
         return;
     }
 
-    m_watcher->addPath(path);
-
-    if (!m_watcher->directories().contains(path)) {
+    if (!addWatch(path)) {
+        if (s_pollingFallback) {
+            if (m_poller->count() == 0)
+                qWarning() << "Out of file system watches, polling remaining directories";
+            m_poller->addPath(path);
+            return;
+        }
         removeAllPaths();
         setError(SystemError);
     }
 }
 
+/*!
+ Returns true if \a path is watched natively or polled.
+
+ Uses the index of watched paths owned by this watcher, the backends' own path
+ lists are expensive to query.
+ */
+bool Watcher::isWatching(const QString &path) const
+{
+    return m_watched.contains(path) || m_poller->contains(path);
+}
+
+int Watcher::watchCount() const
+{
+    return m_watched.count();
+}
+
+bool Watcher::addWatch(const QString &path)
+{
+    bool added = false;
+#ifdef Q_OS_LINUX
+    if (m_inotify)
+        added = m_inotify->addPath(path);
+    else
+#endif
+        added = m_watcher->addPath(path);
+
+    if (added)
+        m_watched.insert(path);
+    return added;
+}
+
+/*!
+ Stops watching \a path and everything watched or polled below it
+ */
+void Watcher::removeWatch(const QString &path)
+{
+    m_poller->removeTree(path);
+    if (!m_watched.contains(path))
+        return;
+
+    const QString prefix = path + QLatin1Char('/');
+    QStringList stale;
+    for (auto it = m_watched.begin(); it != m_watched.end();) {
+        if (*it == path || it->startsWith(prefix)) {
+            stale.append(*it);
+            m_activity.remove(*it);
+            it = m_watched.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+#ifdef Q_OS_LINUX
+    if (m_inotify) {
+        m_inotify->removePath(path);
+        return;
+    }
+#endif
+    m_watcher->removePaths(stale);
+}
+
 void Watcher::removeAllPaths()
 {
+    m_watched.clear();
+    m_activity.clear();
+    m_promotions.clear();
+    m_poller->removeAllPaths();
+#ifdef Q_OS_LINUX
+    if (m_inotify)
+        m_inotify->removeAllPaths();
+#endif
     if (!m_watcher->directories().isEmpty()) {
         m_watcher->removePaths(m_watcher->directories());
     }
@@ -169,6 +587,79 @@ void Watcher::removeAllPaths()
     }
 }
 
+/*!
+ Records activity in the directory \a path, marking it for promotion to a
+ native watch if it is polled
+ */
+void Watcher::noteActivity(const QString &path)
+{
+    // Only needed to pick promotion victims, no bookkeeping without polling
+    if (m_poller->count() == 0)
+        return;
+
+    m_activity.insert(path, m_clock.elapsed());
+    if (m_poller->contains(path))
+        m_promotions.insert(path);
+}
+
+/*!
+ Moves the polled directory \a path to a native watch, demoting the
+ coldestWatch() to polling if no watch is left
+ */
+void Watcher::promote(const QString &path)
+{
+    if (!m_poller->contains(path))
+        return;
+
+    const bool atLimit = s_maximumWatches > 0 && watchCount() > s_maximumWatches;
+    if (atLimit || !addWatch(path)) {
+        const QString victim = coldestWatch();
+        if (victim.isEmpty())
+            return;
+
+        // Take the snapshot before dropping the watch, so nothing is missed
+        m_poller->addPath(victim, true);
+        m_watched.remove(victim);
+#ifdef Q_OS_LINUX
+        if (m_inotify)
+            m_inotify->removePath(victim, false);
+        else
+#endif
+            m_watcher->removePath(victim);
+
+        if (!addWatch(path))
+            return;
+    }
+
+    m_poller->removePath(path);
+}
+
+/*!
+ Returns the natively watched directory with the oldest activity, preferring
+ deeper directories. The root directory is never returned.
+ */
+QString Watcher::coldestWatch() const
+{
+    const QString root = m_rootDir.absolutePath();
+    QString coldest;
+    qint64 coldestActivity = 0;
+    int coldestDepth = 0;
+    foreach (const QString &path, m_watched) {
+        if (path == root)
+            continue;
+        const qint64 activity = m_activity.value(path, -1);
+        if (!coldest.isEmpty() && activity > coldestActivity)
+            continue;
+        const int depth = path.count(QLatin1Char('/'));
+        if (coldest.isEmpty() || activity < coldestActivity || depth > coldestDepth) {
+            coldest = path;
+            coldestActivity = activity;
+            coldestDepth = depth;
+        }
+    }
+    return coldest;
+}
+
 void Watcher::setError(Watcher::Error error)
 {
     if (m_error == error)
@@ -181,14 +672,57 @@ void Watcher::setError(Watcher::Error error)
 void Watcher::recordChange(const QString &path)
 {
 //    qDebug() << "Watcher::recordChange: " << path;
-    m_changes.append(path);
-    m_waitTimer->start();
+    if (isIgnored(path, true))
+        return;
+    m_changes.insert(path);
+    scheduleNotify();
+}
+
+void Watcher::recordFileChange(const QString &path)
+{
+    if (isIgnored(path, false))
+        return;
+    m_fileChanges.insert(path, false);
+    noteActivity(path.left(path.lastIndexOf(QLatin1Char('/'))));
+    scheduleNotify();
+}
+
+void Watcher::recordFileRemoval(const QString &path)
+{
+    if (isIgnored(path, false))
+        return;
+    m_fileChanges.insert(path, true);
+    noteActivity(path.left(path.lastIndexOf(QLatin1Char('/'))));
+    scheduleNotify();
+}
+
+/*!
+ Restarts the quiet period, but never beyond the maximum latency counted from
+ the first event of the current burst
+ */
+void Watcher::scheduleNotify()
+{
+    if (!m_burstTimer.isValid()) {
+        m_burstTimer.start();
+        m_burstEvents = 0;
+    }
+    ++m_burstEvents;
+
+    const qint64 remaining = m_maximumLatency - m_burstTimer.elapsed();
+    m_waitTimer->start(int(qBound<qint64>(0, remaining, m_quietPeriod)));
+}
+
+void Watcher::recordOverflow()
+{
+    // Individual events were lost, fall back to rescanning everything
+    m_fileChanges.clear();
+    recordChange(m_rootDir.absolutePath());
 }
 
 /*!
   Filters all the Directory changes.
 
-  It tries to minimize the List of changes to the minimal common path.
+  Rescanning for new sub directories is limited to the minimal common paths.
   Example:
 
   Changes:
@@ -197,43 +731,116 @@ void Watcher::recordChange(const QString &path)
   /home/qmllive/test
   /home/user
 
-  Will be filtered to:
+  Will be rescanned as:
 
   /home/qmllive/test
   /home/user
 
+  All of them are reported with directoriesChanged() though, so receivers can
+  look at each directory individually instead of walking whole trees.
+
+  Individual file changes, as reported by the InotifyBackend, are emitted with
+  filesChanged() first, unless they are already covered by a reported directory.
+  directoriesChanged() is emitted last and concludes each change set, even when
+  only individual files changed.
   */
 void Watcher::notifyChanges()
 {
 //    qDebug() << "changes" << m_changes;
-    // sort to be able to avoid re-scan of recorded sub-folders
-    QStringList final;
-    QString top;
-    // sort changes so top-most dirs stay first
+    if (m_burstTimer.isValid()) {
+        const qint64 delay = m_burstTimer.elapsed();
+        ++m_statistics.bursts;
+        m_statistics.events += m_burstEvents;
+        m_statistics.largestBurst = qMax(m_statistics.largestBurst, m_burstEvents);
+        m_statistics.totalDelay += delay;
+        m_statistics.maximumDelay = qMax(m_statistics.maximumDelay, delay);
+        m_burstTimer.invalidate();
+    }
 
-    //TODO: wrong assumption, since "aaa<a-umlaut>/" > "aaa/very/deep/hierarchy"
-    // we need to sort according to the number of sections when split by QDir::Separator
+    // sort changes by depth, so top-most dirs are always visited before their
+    // sub-folders and re-scan of recorded sub-folders can be avoided
+    QStringList changes = m_changes.values();
+    std::sort(changes.begin(), changes.end(), [](const QString &a, const QString &b) {
+        const int depthA = a.count(QLatin1Char('/'));
+        const int depthB = b.count(QLatin1Char('/'));
+        return depthA != depthB ? depthA < depthB : a < b;
+    });
+    m_changes.clear();
 
-    m_changes.sort();
-    foreach (const QString& entry, m_changes) {
+    QStringList final;
+    QSet<QString> rescanned;
+    QSet<QString> reported;
+    foreach (const QString& entry, changes) {
+        reported.insert(entry);
         if (!QDir(entry).exists()) {
             // dir was removed
-            if (m_watcher->directories().contains(entry)) {
-                m_watcher->removePath(entry);
-            }
-        } else {
-            if (top.isNull() || !entry.startsWith(top)) {
-                top = entry;
-                final.append(entry);
-            }
+            removeWatch(entry);
+        } else if (!isCovered(entry, rescanned)) {
+            rescanned.insert(entry);
+            final.append(entry);
         }
     }
-    m_changes.clear();
     // need to rescan these top-most dirs
     foreach (const QString& entry, final) {
         addDirectoriesRecursively(entry);
     }
-    emit directoriesChanged(final);
-//    qDebug() << "watcher directories: " << m_watcher->directories();
+
+    QStringList changedFiles;
+    QStringList removedFiles;
+    for (auto it = m_fileChanges.constBegin(); it != m_fileChanges.constEnd(); ++it) {
+        const QString dirPath = it.key().left(it.key().lastIndexOf(QLatin1Char('/')));
+        if (!it.value() && reported.contains(dirPath))
+            continue;
+        if (it.value())
+            removedFiles.append(it.key());
+        else
+            changedFiles.append(it.key());
+    }
+    m_fileChanges.clear();
+
+    foreach (const QString &path, m_promotions)
+        promote(path);
+    m_promotions.clear();
+
+    if (!changedFiles.isEmpty() || !removedFiles.isEmpty())
+        emit filesChanged(changedFiles, removedFiles);
+    emit directoriesChanged(changes);
+//    qDebug() << "watched directories: " << m_watched;
+}
+
+/*!
+ Returns true if \a path or any of its parent directories is in \a set.
+
+ Costs one hash lookup per path section.
+ */
+bool Watcher::isCovered(const QString &path, const QSet<QString> &set)
+{
+    if (set.isEmpty())
+        return false;
+
+    int end = path.length();
+    while (end > 0) {
+        if (set.contains(path.left(end)))
+            return true;
+        end = path.lastIndexOf(QLatin1Char('/'), end - 1);
+    }
+    return false;
 }
 
+/*!
+ \fn Watcher::directoriesChanged(const QStringList& changes)
+
+ Notifies about changed directories \a changes, sorted by depth. Removed
+ directories are included. Directories created inside a new directory before
+ it was watched are not reported individually. This always concludes a change
+ set.
+ */
+
+/*!
+ \fn Watcher::filesChanged(const QStringList &changed, const QStringList &removed)
+
+ Notifies about individual files which were \a changed (created, modified or
+ renamed to) and \a removed (deleted or renamed from). Only emitted by the
+ InotifyBackend and for polled directories.
+ */
+
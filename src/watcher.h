@@ -34,6 +34,12 @@
 
 #include <QtCore>
 
+#include "ignorematcher.h"
+
+class InotifyWatcher;
+class DirectoryScanner;
+class DirectoryPoller;
+
 class Watcher : public QObject
 {
     Q_OBJECT
@@ -44,29 +50,102 @@ public:
         SystemError,
     };
 
+    enum Backend {
+        DefaultBackend,
+        FileSystemWatcherBackend,
+        InotifyBackend
+    };
+
+    struct Statistics {
+        int bursts = 0;
+        qint64 events = 0;
+        int largestBurst = 0;
+        qint64 totalDelay = 0;
+        qint64 maximumDelay = 0;
+        int polledDirectories = 0;
+        qint64 pollCost = 0;
+        qint64 pollCycle = -1;
+    };
+
     explicit Watcher(QObject *parent = 0);
+    ~Watcher();
     void setDirectory(const QString& path);
     QString directory() const;
+    bool isReady() const { return m_ready; }
+    void cancelScan();
+    IgnoreMatcher ignoreMatcher() const { return m_ignore; }
+    void setIgnoreMatcher(const IgnoreMatcher &ignore);
     bool hasError() const { return m_error != NoError; }
     Error error() const { return m_error; }
     static int maximumWatches() { return s_maximumWatches; }
     static void setMaximumWatches(int maximumWatches);
+    static bool pollingFallback() { return s_pollingFallback; }
+    static void setPollingFallback(bool enabled);
+    static int pollBudget() { return s_pollBudget; }
+    static void setPollBudget(int percent);
+    int polledCount() const;
+    static Backend backend() { return s_backend; }
+    static void setBackend(Backend backend);
+    Backend activeBackend() const;
+    int quietPeriod() const { return m_quietPeriod; }
+    void setQuietPeriod(int msecs);
+    int maximumLatency() const { return m_maximumLatency; }
+    void setMaximumLatency(int msecs);
+    Statistics statistics() const;
+    void resetStatistics();
 private Q_SLOTS:
     void recordChange(const QString &path);
+    void recordFileChange(const QString &path);
+    void recordFileRemoval(const QString &path);
+    void recordOverflow();
     void notifyChanges();
+    void onDirectoriesFound(const QStringList &paths);
+    void onScanFinished();
 Q_SIGNALS:
     void directoriesChanged(const QStringList& changes);
+    void filesChanged(const QStringList &changed, const QStringList &removed);
     void errorChanged();
+    void scanProgress(int directories);
+    void ready();
 private:
+    void initBackend();
+    void scheduleNotify();
     void addDirectoriesRecursively(const QString& path);
     void addDirectory(const QString &path);
+    bool isIgnored(const QString &path, bool isDir) const;
+    bool isWatching(const QString &path) const;
+    int watchCount() const;
+    bool addWatch(const QString &path);
+    void removeWatch(const QString &path);
     void removeAllPaths();
+    void noteActivity(const QString &path);
+    void promote(const QString &path);
+    QString coldestWatch() const;
+    static bool isCovered(const QString &path, const QSet<QString> &set);
     void setError(Error error);
     static int s_maximumWatches;
+    static Backend s_backend;
+    static bool s_pollingFallback;
+    static int s_pollBudget;
     QFileSystemWatcher *m_watcher;
+    InotifyWatcher *m_inotify;
+    DirectoryPoller *m_poller;
+    DirectoryScanner *m_scanner;
     QDir m_rootDir;
+    IgnoreMatcher m_ignore;
     QTimer *m_waitTimer;
-    QStringList m_changes;
+    int m_quietPeriod;
+    int m_maximumLatency;
+    QElapsedTimer m_burstTimer;
+    int m_burstEvents;
+    Statistics m_statistics;
+    bool m_ready;
+    QSet<QString> m_watched;
+    QElapsedTimer m_clock;
+    QHash<QString, qint64> m_activity;
+    QSet<QString> m_promotions;
+    QSet<QString> m_changes;
+    QHash<QString, bool> m_fileChanges;
     Error m_error = NoError;
 };
 
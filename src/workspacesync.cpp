@@ -0,0 +1,211 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include "workspacesync.h"
+#include "livehubengine.h"
+
+#include <QtConcurrent>
+
+#ifdef QMLLIVE_DEBUG
+#define DEBUG qDebug()
+#else
+#define DEBUG if (0) qDebug()
+#endif
+
+/*!
+ * \class WorkspaceSync
+ * \brief Determines which workspace documents a node is missing
+ * \inmodule qmllive
+ *
+ * A node asking for the workspace reports what it already has with a
+ * ContentManifest. WorkspaceSync compares it against the workspace of a
+ * LiveHubEngine, so only outdatedDocuments() need to be published.
+ *
+ * The workspace is listed and the files not hashed by the hub yet are hashed
+ * in parallel using QtConcurrent, the hashes the hub already knows are
+ * reused. So start() returns immediately and finished() is emitted once the
+ * comparison is complete.
+ *
+ * Documents the node has but the hub does not are left alone, the same as
+ * with a full LiveHubEngine::publishWorkspace().
+ */
+
+/*!
+ * Standard constructor comparing the workspace of \a hub against \a manifest,
+ * using \a parent as parent
+ */
+WorkspaceSync::WorkspaceSync(LiveHubEngine *hub, const ContentManifest &manifest, QObject *parent)
+    : QObject(parent)
+    , m_hub(hub)
+    , m_manifest(manifest)
+    , m_upToDate(0)
+    , m_finished(false)
+    , m_filesWatcher(new QFutureWatcher<QStringList>(this))
+    , m_hashWatcher(new QFutureWatcher<HashedFile>(this))
+{
+    connect(m_filesWatcher, &QFutureWatcherBase::finished, this, &WorkspaceSync::onFilesReady);
+    connect(m_hashWatcher, &QFutureWatcherBase::finished, this, &WorkspaceSync::onHashesReady);
+}
+
+/*!
+ * Destroys the sync, cancelling a pending comparison
+ */
+WorkspaceSync::~WorkspaceSync()
+{
+    cancel();
+}
+
+/*!
+ * Starts the comparison
+ *
+ * The workspace is listed in the background. Files whose hash is known to
+ * the hub are compared as soon as the list is available, the others are
+ * hashed in the background.
+ */
+void WorkspaceSync::start()
+{
+    if (!m_hub) {
+        m_finished = true;
+        emit finished();
+        return;
+    }
+
+    m_workspace = QDir(m_hub->workspace());
+    m_outdated.clear();
+    m_upToDate = 0;
+    m_finished = false;
+
+    m_filesWatcher->setFuture(m_hub->workspaceFiles());
+}
+
+void WorkspaceSync::onFilesReady()
+{
+    if (m_filesWatcher->isCanceled())
+        return;
+
+    if (!m_hub) {
+        m_finished = true;
+        emit finished();
+        return;
+    }
+
+    QStringList unknown;
+    foreach (const QString &path, m_filesWatcher->result()) {
+        const LiveDocument document = LiveDocument::resolve(m_workspace, path);
+        const ContentHash remote = m_manifest.value(document.relativeFilePath());
+        if (remote.isNull()) {
+            m_outdated.append(document);
+            continue;
+        }
+
+        const ContentHash local = m_hub->contentHash(path);
+        if (local.isNull())
+            unknown.append(path);
+        else if (local != remote)
+            m_outdated.append(document);
+        else
+            ++m_upToDate;
+    }
+
+    DEBUG << "WorkspaceSync: " << m_outdated.count() << "outdated," << unknown.count() << "to hash";
+
+    m_hashWatcher->setFuture(QtConcurrent::mapped(unknown, &WorkspaceSync::hashFile));
+}
+
+/*!
+ * Cancels a pending comparison, finished() will not be emitted
+ */
+void WorkspaceSync::cancel()
+{
+    // The listing cannot be interrupted, its result is just dropped
+    m_filesWatcher->cancel();
+    if (m_hashWatcher->isRunning()) {
+        m_hashWatcher->cancel();
+        m_hashWatcher->waitForFinished();
+    }
+}
+
+/*!
+ * Returns true once the comparison is complete
+ */
+bool WorkspaceSync::isFinished() const
+{
+    return m_finished;
+}
+
+/*!
+ * Returns the documents which are missing on the node or differ from the
+ * workspace
+ */
+QList<LiveDocument> WorkspaceSync::outdatedDocuments() const
+{
+    return m_outdated;
+}
+
+/*!
+ * Returns the number of documents the node already has in their current
+ * version
+ */
+int WorkspaceSync::upToDateCount() const
+{
+    return m_upToDate;
+}
+
+void WorkspaceSync::onHashesReady()
+{
+    if (m_hashWatcher->isCanceled())
+        return;
+
+    const QList<HashedFile> results = m_hashWatcher->future().results();
+    foreach (const HashedFile &file, results) {
+        const LiveDocument document = LiveDocument::resolve(m_workspace, file.first);
+        if (file.second.isNull() || file.second != m_manifest.value(document.relativeFilePath()))
+            m_outdated.append(document);
+        else
+            ++m_upToDate;
+    }
+
+    m_finished = true;
+    emit finished();
+}
+
+WorkspaceSync::HashedFile WorkspaceSync::hashFile(const QString &path)
+{
+    return HashedFile(path, ContentHash::fromFile(path));
+}
+
+/*!
+ * \fn void WorkspaceSync::finished()
+ *
+ * The signal is emitted when the comparison started with start() is complete
+ * and outdatedDocuments() is available.
+ */
@@ -0,0 +1,79 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore>
+
+#include "contenthash.h"
+#include "contentmanifest.h"
+#include "livedocument.h"
+#include "qmllive_global.h"
+
+class LiveHubEngine;
+
+class QMLLIVESHARED_EXPORT WorkspaceSync : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WorkspaceSync(LiveHubEngine *hub, const ContentManifest &manifest, QObject *parent = 0);
+    ~WorkspaceSync();
+
+    void start();
+    void cancel();
+    bool isFinished() const;
+
+    QList<LiveDocument> outdatedDocuments() const;
+    int upToDateCount() const;
+
+Q_SIGNALS:
+    void finished();
+
+private Q_SLOTS:
+    void onFilesReady();
+    void onHashesReady();
+
+private:
+    typedef QPair<QString, ContentHash> HashedFile;
+
+    static HashedFile hashFile(const QString &path);
+
+private:
+    QPointer<LiveHubEngine> m_hub;
+    ContentManifest m_manifest;
+    QDir m_workspace;
+    QList<LiveDocument> m_outdated;
+    int m_upToDate;
+    bool m_finished;
+    QFutureWatcher<QStringList> *m_filesWatcher;
+    QFutureWatcher<HashedFile> *m_hashWatcher;
+};
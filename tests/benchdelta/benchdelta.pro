@@ -0,0 +1,19 @@
+QT       += testlib core
+QT       -= gui
+
+TARGET = tst_benchdelta
+CONFIG   += testcase c++11
+
+INCLUDEPATH += $$PWD/../../src
+DEFINES += QMLLIVE_LIBRARY
+
+TEMPLATE = app
+
+SOURCES += \
+    tst_benchdelta.cpp \
+    $$PWD/../../src/deltasync.cpp \
+    $$PWD/../../src/contenthash.cpp
+
+HEADERS += \
+    $$PWD/../../src/deltasync.h \
+    $$PWD/../../src/contenthash.h
@@ -0,0 +1,195 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include <QtTest>
+
+#include "deltasync.h"
+
+class BenchDelta : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchDelta() {}
+
+private:
+    // Larger than any document sent in the benchmarks
+    static const qint64 MaximumSize = 64 * 1024 * 1024;
+
+    // Generated QML data file of roughly size bytes
+    static QByteArray document(int size)
+    {
+        QByteArray data("import QtQuick 2.0\n\nListModel {\n");
+        for (int i = 0; data.size() < size; ++i) {
+            data += QByteArray("    ListElement { name: \"item") + QByteArray::number(i)
+                    + "\"; value: " + QByteArray::number(i * 7919 % 10007) + " }\n";
+        }
+        data += "}\n";
+        return data;
+    }
+
+    // Replaces the line around the middle, like a one-line edit
+    static QByteArray edited(const QByteArray &data)
+    {
+        const int start = data.indexOf('\n', data.size() / 2) + 1;
+        const int end = data.indexOf('\n', start);
+        QByteArray result = data;
+        result.replace(start, end - start, "    ListElement { name: \"edited\"; value: -1 }");
+        return result;
+    }
+
+    static void addSizes()
+    {
+        QTest::addColumn<int>("size");
+
+        QTest::newRow("64KiB") << 64 * 1024;
+        QTest::newRow("1MiB") << 1024 * 1024;
+        QTest::newRow("8MiB") << 8 * 1024 * 1024;
+    }
+
+private Q_SLOTS:
+    void roundTrip_data()
+    {
+        QTest::addColumn<QByteArray>("base");
+        QTest::addColumn<QByteArray>("target");
+
+        const QByteArray data = document(100 * 1024);
+        QTest::newRow("identical") << data << data;
+        QTest::newRow("edit") << data << edited(data);
+        QTest::newRow("insert") << data << QByteArray(data).insert(1000, "// comment\n");
+        QTest::newRow("remove") << data << QByteArray(data).remove(5000, 333);
+        QTest::newRow("append") << data << data + "// end\n";
+        QTest::newRow("truncate") << data << data.left(data.size() / 3);
+        QTest::newRow("empty base") << QByteArray("") << data;
+        QTest::newRow("empty target") << data << QByteArray("");
+        QTest::newRow("small") << QByteArray("Item {}\n") << QByteArray("Item { id: root }\n");
+    }
+
+    void roundTrip()
+    {
+        QFETCH(QByteArray, base);
+        QFETCH(QByteArray, target);
+
+        const QByteArray delta = DeltaSync::delta(DeltaSync::signature(base), target);
+        QVERIFY(!delta.isNull());
+
+        const QByteArray patched = DeltaSync::patch(base, delta, MaximumSize);
+        QVERIFY(!patched.isNull());
+        QCOMPARE(patched, target);
+    }
+
+    // A delta must not be applied to anything but the version it was made for
+    void wrongBase()
+    {
+        const QByteArray base = document(100 * 1024);
+        const QByteArray delta = DeltaSync::delta(DeltaSync::signature(base), edited(base));
+        QVERIFY(DeltaSync::patch(edited(base), delta, MaximumSize).isNull());
+        QVERIFY(DeltaSync::patch(base, QByteArray("garbage"), MaximumSize).isNull());
+        QVERIFY(DeltaSync::delta(QByteArray("garbage"), base).isNull());
+    }
+
+    // Sizes claimed by the peer must not make the receiving side allocate
+    void claimedSizes()
+    {
+        // Signatures claiming blocks which are not there, the second one of
+        // a terabyte document
+        const qint64 sizes[] = { 1024 * 1024, qint64(1) << 40 };
+        for (const qint64 size : sizes) {
+            QByteArray signature;
+            QDataStream out(&signature, QIODevice::WriteOnly);
+            out << quint32(0x514c5347) << quint8(1) << size << quint64(1)
+                << quint32(512) << quint32(size / 512);
+            QVERIFY(DeltaSync::delta(signature, document(1024)).isNull());
+        }
+
+        const QByteArray base = document(100 * 1024);
+        const QByteArray target = edited(base);
+        const QByteArray delta = DeltaSync::delta(DeltaSync::signature(base), target);
+        QCOMPARE(DeltaSync::patch(base, delta, target.size()), target);
+        QVERIFY(DeltaSync::patch(base, delta, target.size() - 1).isNull());
+    }
+
+    void signature_data() { addSizes(); }
+
+    void signature()
+    {
+        QFETCH(int, size);
+
+        const QByteArray base = document(size);
+        QByteArray signature;
+        QBENCHMARK {
+            signature = DeltaSync::signature(base);
+        }
+        QVERIFY(signature.size() < base.size() / 20);
+    }
+
+    void delta_data() { addSizes(); }
+
+    // One line edits should cost a small fraction of the document on the wire
+    void delta()
+    {
+        QFETCH(int, size);
+
+        const QByteArray base = document(size);
+        const QByteArray target = edited(base);
+        const QByteArray signature = DeltaSync::signature(base);
+        QByteArray delta;
+        QBENCHMARK {
+            delta = DeltaSync::delta(signature, target);
+        }
+
+        qDebug() << "document" << target.size() << "signature" << signature.size()
+                 << "delta" << delta.size();
+        QVERIFY(delta.size() + signature.size() < target.size() / 10);
+        QCOMPARE(DeltaSync::patch(base, delta, MaximumSize), target);
+    }
+
+    void patch_data() { addSizes(); }
+
+    void patch()
+    {
+        QFETCH(int, size);
+
+        const QByteArray base = document(size);
+        const QByteArray target = edited(base);
+        const QByteArray delta = DeltaSync::delta(DeltaSync::signature(base), target);
+        QByteArray patched;
+        QBENCHMARK {
+            patched = DeltaSync::patch(base, delta, MaximumSize);
+        }
+        QCOMPARE(patched, target);
+    }
+};
+
+QTEST_MAIN(BenchDelta)
+
+#include "tst_benchdelta.moc"
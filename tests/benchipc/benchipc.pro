@@ -0,0 +1,13 @@
+QT       += testlib core network
+QT       -= gui
+
+TARGET = tst_benchipc
+CONFIG   += testcase c++11
+
+include($$PWD/../../src/ipc/ipc.pri)
+INCLUDEPATH += $$PWD/../../src
+
+TEMPLATE = app
+
+SOURCES += \
+    tst_benchipc.cpp
@@ -0,0 +1,400 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include <QtTest>
+#include <QtNetwork>
+
+#include "ipc/ipcserver.h"
+#include "ipc/ipcclient.h"
+#include "ipc/ipcprotocol.h"
+
+// Forwards connections to another port, delaying all data by a fixed latency.
+// With a bandwidth, data is only read from the sender as fast as the link
+// takes it, so the backlog builds up on the sending side.
+class DelayProxy : public QObject
+{
+    Q_OBJECT
+
+public:
+    DelayProxy(quint16 targetPort, int latency, qint64 bytesPerSecond = 0)
+        : m_targetPort(targetPort)
+        , m_latency(latency)
+        , m_bytesPerSecond(bytesPerSecond)
+        , m_linkFree(0)
+    {
+        connect(&m_server, &QTcpServer::newConnection, this, &DelayProxy::onNewConnection);
+        m_timer.setTimerType(Qt::PreciseTimer);
+        m_timer.setSingleShot(true);
+        connect(&m_timer, &QTimer::timeout, this, &DelayProxy::forward);
+        m_pumpTimer.setTimerType(Qt::PreciseTimer);
+        m_pumpTimer.setSingleShot(true);
+        connect(&m_pumpTimer, &QTimer::timeout, this, &DelayProxy::pump);
+        m_clock.start();
+    }
+
+    bool listen(quint16 port) { return m_server.listen(QHostAddress::LocalHost, port); }
+
+private:
+    struct Pending
+    {
+        qint64 due;
+        QPointer<QTcpSocket> to;
+        QByteArray data;
+    };
+
+    void onNewConnection()
+    {
+        QTcpSocket *client = m_server.nextPendingConnection();
+        QTcpSocket *target = new QTcpSocket(client);
+        target->connectToHost(QHostAddress::LocalHost, m_targetPort);
+        if (m_bytesPerSecond > 0) {
+            client->setReadBufferSize(64 * 1024);
+            target->setReadBufferSize(64 * 1024);
+        }
+        m_links.append(qMakePair(QPointer<QTcpSocket>(client), QPointer<QTcpSocket>(target)));
+        connect(client, &QTcpSocket::readyRead, this, [this, client, target]() { delay(client, target); });
+        connect(target, &QTcpSocket::readyRead, this, [this, client, target]() { delay(target, client); });
+        connect(client, &QTcpSocket::disconnected, client, &QObject::deleteLater);
+    }
+
+    void delay(QTcpSocket *from, QTcpSocket *to)
+    {
+        const qint64 now = m_clock.elapsed();
+        if (m_linkFree > now) {
+            // The rest waits in the buffers of the sender
+            if (!m_pumpTimer.isActive())
+                m_pumpTimer.start(int(m_linkFree - now));
+            return;
+        }
+
+        Pending pending;
+        pending.to = to;
+        pending.data = from->readAll();
+        if (pending.data.isEmpty())
+            return;
+        if (m_bytesPerSecond > 0)
+            m_linkFree = now + pending.data.size() * 1000 / m_bytesPerSecond;
+        pending.due = qMax(now, m_linkFree) + m_latency;
+        m_pending.enqueue(pending);
+        if (!m_timer.isActive())
+            m_timer.start(int(pending.due - now));
+    }
+
+    void pump()
+    {
+        for (int i = 0; i < m_links.count(); ++i) {
+            const QPointer<QTcpSocket> client = m_links.at(i).first;
+            const QPointer<QTcpSocket> target = m_links.at(i).second;
+            if (client && target && client->bytesAvailable())
+                delay(client, target);
+            if (client && target && target->bytesAvailable())
+                delay(target, client);
+        }
+    }
+
+    void forward()
+    {
+        while (!m_pending.isEmpty() && m_pending.head().due <= m_clock.elapsed()) {
+            const Pending pending = m_pending.dequeue();
+            if (pending.to)
+                pending.to->write(pending.data);
+        }
+        if (!m_pending.isEmpty())
+            m_timer.start(int(qMax<qint64>(0, m_pending.head().due - m_clock.elapsed())));
+    }
+
+    QTcpServer m_server;
+    quint16 m_targetPort;
+    int m_latency;
+    qint64 m_bytesPerSecond;
+    qint64 m_linkFree;
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+    QTimer m_pumpTimer;
+    QQueue<Pending> m_pending;
+    QList<QPair<QPointer<QTcpSocket>, QPointer<QTcpSocket> > > m_links;
+};
+
+class BenchIpc : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchIpc() {}
+
+private Q_SLOTS:
+    void messages_data()
+    {
+        QTest::addColumn<int>("version");
+        QTest::newRow("text") << int(IpcProtocol::TextVersion);
+        QTest::newRow("binary") << int(IpcProtocol::BinaryVersion);
+    }
+
+    // Small calls like setXOffset(int) over loopback, where the framing
+    // overhead dominates
+    void messages()
+    {
+        QFETCH(int, version);
+        const int count = 10000;
+
+        IpcServer peer1;
+        peer1.listen(10234);
+        int received = 0;
+        QEventLoop loop;
+        int expected = 0;
+        connect(&peer1, &IpcServer::received, [&]() {
+            if (++received == expected)
+                loop.quit();
+        });
+
+        QScopedPointer<IpcClient> reply;
+        void (IpcServer::*IpcServer__clientConnected_transport)(IpcTransport*) = &IpcServer::clientConnected;
+        connect(&peer1, IpcServer__clientConnected_transport, [&reply](IpcTransport *transport) {
+            reply.reset(new IpcClient(transport));
+        });
+
+        IpcClient peer2;
+        peer2.setProtocolVersion(version);
+        peer2.connectToServer("127.0.0.1", 10234);
+        QTRY_VERIFY(reply);
+        QTest::qWait(100);
+
+        QByteArray content;
+        QDataStream out(&content, QIODevice::WriteOnly);
+        out << 42;
+
+        QTimer timeout;
+        timeout.setSingleShot(true);
+        connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+
+        qint64 sent = 0;
+        QElapsedTimer timer;
+        timer.start();
+        QBENCHMARK {
+            expected = received + count;
+            for (int i = 0; i < count; ++i)
+                peer2.send("setXOffset(int)", content);
+            timeout.start(60000);
+            loop.exec();
+            QCOMPARE(received, expected);
+            sent += count;
+        }
+
+        qDebug() << "frame version" << version << ":"
+                 << qRound64(sent * 1000.0 / qMax<qint64>(1, timer.elapsed())) << "messages/s";
+    }
+
+    void transports_data()
+    {
+        QTest::addColumn<bool>("local");
+        QTest::addColumn<int>("sharedMemorySize");
+        QTest::newRow("tcp") << false << 0;
+        QTest::newRow("local socket") << true << 0;
+        QTest::newRow("shared memory") << true << 16 * 1024 * 1024;
+    }
+
+    // Throughput of document sized messages to a runtime on the same machine,
+    // depending on the transport
+    void transports()
+    {
+        QFETCH(bool, local);
+        QFETCH(int, sharedMemorySize);
+        const int count = 256;
+        const QByteArray content(1024 * 1024, 'x');
+
+        IpcServer peer1;
+        peer1.listen(10234);
+        int received = 0;
+        QEventLoop loop;
+        int expected = 0;
+        connect(&peer1, &IpcServer::received, [&]() {
+            if (++received == expected)
+                loop.quit();
+        });
+
+        QScopedPointer<IpcClient> reply;
+        void (IpcServer::*IpcServer__clientConnected_transport)(IpcTransport*) = &IpcServer::clientConnected;
+        connect(&peer1, IpcServer__clientConnected_transport, [&reply](IpcTransport *transport) {
+            reply.reset(new IpcClient(transport));
+        });
+
+        IpcClient peer2;
+        peer2.setLocalTransportEnabled(local);
+        peer2.setSharedMemorySize(sharedMemorySize);
+        peer2.setCompressionLevel(0);
+        peer2.connectToServer("127.0.0.1", 10234);
+        QTRY_VERIFY(reply);
+        QTest::qWait(100);
+
+        QTimer timeout;
+        timeout.setSingleShot(true);
+        connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+
+        qint64 bytes = 0;
+        QElapsedTimer timer;
+        timer.start();
+        QBENCHMARK {
+            expected = received + count;
+            for (int i = 0; i < count; ++i)
+                peer2.send("sendFile(QString,QByteArray)", content);
+            timeout.start(60000);
+            loop.exec();
+            QCOMPARE(received, expected);
+            bytes += qint64(count) * content.size();
+        }
+
+        qDebug() << QTest::currentDataTag() << ":"
+                 << qRound64(bytes / 1024.0 / 1024.0 * 1000.0 / qMax<qint64>(1, timer.elapsed())) << "MiB/s";
+    }
+
+    void pipelining_data()
+    {
+        QTest::addColumn<qint64>("window");
+        QTest::newRow("16 KiB") << qint64(16 * 1024);
+        QTest::newRow("64 KiB") << qint64(64 * 1024);
+        QTest::newRow("256 KiB") << qint64(256 * 1024);
+        QTest::newRow("1 MiB") << qint64(1024 * 1024);
+    }
+
+    // Throughput of document sized messages over a loopback link with 20 ms
+    // of latency in each direction, depending on the in-flight window
+    void pipelining()
+    {
+        QFETCH(qint64, window);
+        const int count = 64;
+        const QByteArray content(64 * 1024, 'x');
+
+        IpcServer peer1;
+        peer1.listen(10234);
+        DelayProxy proxy(10234, 20);
+        QVERIFY(proxy.listen(10235));
+
+        int received = 0;
+        QEventLoop loop;
+        int expected = 0;
+        connect(&peer1, &IpcServer::received, [&]() {
+            if (++received == expected)
+                loop.quit();
+        });
+        QTimer timeout;
+        timeout.setSingleShot(true);
+        connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+
+        IpcClient peer2;
+        peer2.setHighWaterMark(window);
+        peer2.setCompressionLevel(0);
+        peer2.connectToServer("127.0.0.1", 10235);
+        QVERIFY(peer2.waitForConnected());
+
+        qint64 bytes = 0;
+        QElapsedTimer timer;
+        timer.start();
+        QBENCHMARK_ONCE {
+            expected = received + count;
+            for (int i = 0; i < count; ++i)
+                peer2.send("sendFile(QString,QByteArray)", content);
+            timeout.start(60000);
+            loop.exec();
+            QCOMPARE(received, expected);
+            bytes += qint64(count) * content.size();
+        }
+
+        qDebug() << "window" << window << ":"
+                 << qRound64(bytes / 1024.0 * 1000.0 / qMax<qint64>(1, timer.elapsed())) << "KiB/s";
+    }
+
+    void controlLatency_data()
+    {
+        QTest::addColumn<int>("lane");
+        QTest::newRow("bulk lane") << int(IpcClient::BulkLane);
+        QTest::newRow("control lane") << int(IpcClient::ControlLane);
+    }
+
+    // Time a small call takes while 16 MiB of documents are being sent over a
+    // 10 MB/s link, depending on the lane it is sent in
+    void controlLatency()
+    {
+        QFETCH(int, lane);
+        const int count = 64;
+        const QByteArray content(256 * 1024, 'x');
+
+        IpcServer peer1;
+        peer1.listen(10234);
+        DelayProxy proxy(10234, 1, 10 * 1000 * 1000);
+        QVERIFY(proxy.listen(10235));
+
+        int received = 0;
+        qint64 latency = -1;
+        QElapsedTimer probe;
+        QEventLoop loop;
+        connect(&peer1, &IpcServer::received, [&](const QString &method, const QByteArray &) {
+            if (method == QLatin1String("setXOffset(int)"))
+                latency = probe.elapsed();
+            if (++received == count + 1)
+                loop.quit();
+        });
+        QTimer timeout;
+        timeout.setSingleShot(true);
+        connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+
+        // A small send buffer keeps the backlog in the client, where the
+        // lanes can reorder it
+        QTcpSocket *socket = new QTcpSocket;
+        socket->connectToHost(QHostAddress::LocalHost, 10235);
+        QVERIFY(socket->waitForConnected());
+        socket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, 64 * 1024);
+        IpcClient peer2(socket);
+        socket->setParent(&peer2);
+        peer2.setCompressionLevel(0);
+
+        QByteArray offset;
+        QDataStream out(&offset, QIODevice::WriteOnly);
+        out << 42;
+
+        QBENCHMARK_ONCE {
+            for (int i = 0; i < count; ++i)
+                peer2.send("sendFile(QString,QByteArray)", content);
+            QTest::qWait(200);
+            probe.start();
+            peer2.send("setXOffset(int)", offset, QString(), IpcClient::Lane(lane));
+            timeout.start(60000);
+            loop.exec();
+        }
+
+        QCOMPARE(received, count + 1);
+        qDebug() << QTest::currentDataTag() << ":" << latency << "ms";
+    }
+};
+
+QTEST_MAIN(BenchIpc)
+
+#include "tst_benchipc.moc"
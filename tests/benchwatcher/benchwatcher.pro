@@ -0,0 +1,29 @@
+QT       += testlib core
+QT       -= gui
+
+TARGET = tst_benchwatcher
+CONFIG   += testcase c++11
+
+INCLUDEPATH += $$PWD/../../src
+
+TEMPLATE = app
+
+SOURCES += \
+    tst_benchwatcher.cpp \
+    $$PWD/../../src/watcher.cpp \
+    $$PWD/../../src/directoryscanner.cpp \
+    $$PWD/../../src/directorysnapshot.cpp \
+    $$PWD/../../src/directorypoller.cpp \
+    $$PWD/../../src/ignorematcher.cpp
+
+HEADERS += \
+    $$PWD/../../src/watcher.h \
+    $$PWD/../../src/directoryscanner.h \
+    $$PWD/../../src/directorysnapshot.h \
+    $$PWD/../../src/directorypoller.h \
+    $$PWD/../../src/ignorematcher.h
+
+linux {
+    SOURCES += $$PWD/../../src/inotifywatcher.cpp
+    HEADERS += $$PWD/../../src/inotifywatcher.h
+}
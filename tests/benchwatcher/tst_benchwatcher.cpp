@@ -0,0 +1,180 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include <QtTest>
+
+#include "watcher.h"
+#include "directorypoller.h"
+
+class BenchWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchWatcher() {}
+
+private:
+    // Creates a tree with a fan-out of 10 holding exactly count directories
+    static void createTree(const QString &root, int count)
+    {
+        QQueue<QString> parents;
+        parents.enqueue(root);
+        int created = 0;
+        while (created < count) {
+            const QString parent = parents.dequeue();
+            for (int i = 0; i < 10 && created < count; ++i, ++created) {
+                const QString path = QString("%1/d%2").arg(parent).arg(i);
+                QVERIFY(QDir().mkdir(path));
+                parents.enqueue(path);
+            }
+        }
+    }
+
+private Q_SLOTS:
+    // The watcher settings are static, a failing test must not leave them
+    // changed for the following ones
+    void cleanup()
+    {
+        Watcher::setBackend(Watcher::DefaultBackend);
+        Watcher::setMaximumWatches(-1);
+        Watcher::setPollingFallback(true);
+    }
+
+    void setDirectory_data()
+    {
+        QTest::addColumn<int>("backend");
+        QTest::addColumn<int>("directories");
+
+        const QList<int> sizes = QList<int>() << 1000 << 2000 << 4000 << 8000;
+        foreach (int size, sizes) {
+            QTest::newRow(qPrintable(QString("QFileSystemWatcher/%1").arg(size)))
+                    << int(Watcher::FileSystemWatcherBackend) << size;
+        }
+#ifdef Q_OS_LINUX
+        foreach (int size, sizes) {
+            QTest::newRow(qPrintable(QString("inotify/%1").arg(size)))
+                    << int(Watcher::InotifyBackend) << size;
+        }
+#endif
+    }
+
+    // Setup time is expected to grow linearly with the number of directories
+    void setDirectory()
+    {
+        QFETCH(int, backend);
+        QFETCH(int, directories);
+
+        QTemporaryDir root;
+        QVERIFY(root.isValid());
+        createTree(root.path(), directories);
+
+        Watcher::setBackend(Watcher::Backend(backend));
+        Watcher::setMaximumWatches(-1);
+        Watcher watcher;
+
+        QBENCHMARK {
+            QSignalSpy ready(&watcher, &Watcher::ready);
+            watcher.setDirectory(root.path());
+            QVERIFY(ready.wait(60000));
+        }
+
+        QVERIFY(!watcher.hasError());
+    }
+
+    void pollSweep_data()
+    {
+        QTest::addColumn<int>("directories");
+
+        QTest::newRow("1000") << 1000;
+        QTest::newRow("4000") << 4000;
+    }
+
+    // Cost of one poll round over all directories, each holding a few files
+    void pollSweep()
+    {
+        QFETCH(int, directories);
+
+        QTemporaryDir root;
+        QVERIFY(root.isValid());
+        createTree(root.path(), directories);
+
+        DirectoryPoller poller;
+        QDirIterator iter(root.path(), QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (iter.hasNext()) {
+            const QString path = iter.next();
+            for (int i = 0; i < 4; ++i) {
+                QFile file(QString("%1/f%2.qml").arg(path).arg(i));
+                QVERIFY(file.open(QIODevice::WriteOnly));
+            }
+            poller.addPath(path, true);
+        }
+
+        QSignalSpy changed(&poller, &DirectoryPoller::fileChanged);
+        QBENCHMARK {
+            poller.sweep();
+        }
+        QCOMPARE(changed.count(), 0);
+    }
+
+    // Directories beyond the limit are polled, changes in them still arrive
+    void pollingFallback()
+    {
+        QTemporaryDir root;
+        QVERIFY(root.isValid());
+        createTree(root.path(), 100);
+
+        Watcher::setBackend(Watcher::DefaultBackend);
+        Watcher::setMaximumWatches(10);
+        Watcher::setPollingFallback(true);
+        Watcher watcher;
+        QSignalSpy ready(&watcher, &Watcher::ready);
+        watcher.setDirectory(root.path());
+        QVERIFY(ready.wait(10000));
+        QVERIFY(!watcher.hasError());
+        QVERIFY(watcher.polledCount() > 0);
+
+        // Polled directories take their first snapshot with the first round
+        QTRY_VERIFY_WITH_TIMEOUT(watcher.statistics().pollCycle >= 0, 10000);
+
+        // d8/d9 is the last directory found
+        QSignalSpy files(&watcher, &Watcher::filesChanged);
+        QFile file(root.path() + "/d8/d9/changed.qml");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.close();
+        QTRY_VERIFY_WITH_TIMEOUT(!files.isEmpty(), 10000);
+        QVERIFY(files.first().at(0).toStringList().contains(file.fileName()));
+    }
+};
+
+QTEST_MAIN(BenchWatcher)
+
+#include "tst_benchwatcher.moc"
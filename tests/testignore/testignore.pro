@@ -0,0 +1,16 @@
+QT       += testlib core
+QT       -= gui
+
+TARGET = tst_testignore
+CONFIG   += testcase c++11
+
+INCLUDEPATH += $$PWD/../../src
+
+TEMPLATE = app
+
+SOURCES += \
+    tst_testignore.cpp \
+    $$PWD/../../src/ignorematcher.cpp
+
+HEADERS += \
+    $$PWD/../../src/ignorematcher.h
@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include <QtTest>
+
+#include "ignorematcher.h"
+
+class TestIgnore : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestIgnore() {}
+
+private Q_SLOTS:
+    void isIgnored_data()
+    {
+        QTest::addColumn<QStringList>("rules");
+        QTest::addColumn<QString>("path");
+        QTest::addColumn<bool>("isDir");
+        QTest::addColumn<bool>("expected");
+
+        // Literal names match at any depth
+        QTest::newRow("name") << QStringList(".git") << ".git" << true << true;
+        QTest::newRow("name nested") << QStringList(".git") << "a/b/.git" << true << true;
+        QTest::newRow("name whole") << QStringList(".git") << "a/.gitignore" << false << false;
+
+        // Suffix and prefix fast paths
+        QTest::newRow("suffix") << QStringList("*.swp") << "src/main.qml.swp" << false << true;
+        QTest::newRow("suffix other") << QStringList("*.swp") << "src/main.qml" << false << false;
+        QTest::newRow("prefix") << QStringList(".#*") << "ui/.#Main.qml" << false << true;
+        QTest::newRow("prefix other") << QStringList(".#*") << "ui/Main.qml" << false << false;
+
+        // Patterns with a slash are anchored at the workspace
+        QTest::newRow("anchored") << QStringList("/build") << "build" << true << true;
+        QTest::newRow("anchored nested") << QStringList("/build") << "src/build" << true << false;
+        QTest::newRow("path") << QStringList("assets/cache") << "assets/cache" << true << true;
+        QTest::newRow("path nested") << QStringList("assets/cache") << "lib/assets/cache" << true << false;
+
+        // A trailing slash matches directories only, and what is inside
+        QTest::newRow("dir only") << QStringList("build/") << "build" << true << true;
+        QTest::newRow("dir only file") << QStringList("build/") << "build" << false << false;
+        QTest::newRow("dir only contents") << QStringList("build/") << "x/build/out.qml" << false << true;
+
+        // Wildcards stay within one path section
+        QTest::newRow("question mark") << QStringList("test?.qml") << "a/test1.qml" << false << true;
+        QTest::newRow("question mark one") << QStringList("test?.qml") << "a/test10.qml" << false << false;
+        QTest::newRow("class") << QStringList("*.[oa]") << "lib/x.o" << false << true;
+        QTest::newRow("class other") << QStringList("*.[oa]") << "lib/x.c" << false << false;
+        QTest::newRow("negated class") << QStringList("file[!0-9].txt") << "fileA.txt" << false << true;
+        QTest::newRow("negated class other") << QStringList("file[!0-9].txt") << "file1.txt" << false << false;
+        QTest::newRow("star section") << QStringList("src/*.qml") << "src/sub/a.qml" << false << false;
+
+        // ** crosses sections
+        QTest::newRow("leading **") << QStringList("**/cache") << "a/b/cache" << true << true;
+        QTest::newRow("leading ** path") << QStringList("**/gen/out") << "x/y/gen/out" << true << true;
+        QTest::newRow("inner **") << QStringList("assets/**/*.png") << "assets/img/x/a.png" << false << true;
+        QTest::newRow("inner ** empty") << QStringList("assets/**/*.png") << "assets/a.png" << false << true;
+        QTest::newRow("inner ** anchored") << QStringList("assets/**/*.png") << "other/assets/a.png" << false << false;
+
+        // The last matching rule wins
+        const QStringList keep = QStringList() << "*.qmlc" << "!keep.qmlc";
+        QTest::newRow("negation") << keep << "a/keep.qmlc" << false << false;
+        QTest::newRow("negation other") << keep << "a/other.qmlc" << false << true;
+        QTest::newRow("negation order") << (QStringList() << "!keep.qmlc" << "*.qmlc") << "keep.qmlc" << false << true;
+        // Nothing inside an ignored directory is included again
+        QTest::newRow("negation parent") << (QStringList() << "build/" << "!build/keep.qml")
+                                         << "build/keep.qml" << false << true;
+
+        QTest::newRow("defaults") << IgnoreMatcher::defaultRules() << "src/.git/HEAD" << false << true;
+        QTest::newRow("defaults qml") << IgnoreMatcher::defaultRules() << "src/main.qml" << false << false;
+    }
+
+    void isIgnored()
+    {
+        QFETCH(QStringList, rules);
+        QFETCH(QString, path);
+        QFETCH(bool, isDir);
+        QFETCH(bool, expected);
+
+        const IgnoreMatcher matcher(rules);
+        QCOMPARE(matcher.isIgnored(path, isDir), expected);
+    }
+
+    // Parents are only considered by isIgnored()
+    void matches()
+    {
+        const IgnoreMatcher matcher(QStringList("build/"));
+        QVERIFY(matcher.matches("x/build", true));
+        QVERIFY(!matcher.matches("x/build/out.qml", false));
+        QVERIFY(matcher.isIgnored("x/build/out.qml", false));
+    }
+
+    void skippedLines()
+    {
+        const IgnoreMatcher matcher(QStringList() << "# comment" << "" << "   " << " *.swp ");
+        QCOMPARE(matcher.rules(), QStringList("*.swp"));
+        QVERIFY(matcher.isIgnored("a.swp", false));
+        QVERIFY(IgnoreMatcher(QStringList("# only a comment")).isEmpty());
+    }
+};
+
+QTEST_MAIN(TestIgnore)
+
+#include "tst_testignore.moc"
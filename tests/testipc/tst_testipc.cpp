@@ -34,6 +34,8 @@
 
 #include "ipc/ipcserver.h"
 #include "ipc/ipcclient.h"
+#include "ipc/ipcprotocol.h"
+#include "ipc/ipcmethod.h"
 
 class TestIpc : public QObject
 {
@@ -87,6 +89,269 @@ private Q_SLOTS:
         QSignalSpy received(&peer1, &IpcServer::received);
         QTRY_COMPARE(received.count(), 1);
     }
+
+    void deferredContent() {
+        IpcServer peer1;
+        peer1.listen(10234);
+        QSignalSpy received(&peer1, &IpcServer::received);
+        IpcClient peer2;
+        peer2.setHighWaterMark(1024);
+        peer2.connectToServer("127.0.0.1", 10234);
+
+        const int count = 50;
+        int produced = 0;
+        int maximumAhead = 0;
+        for (int i = 0; i < count; ++i) {
+            peer2.send("sendFile(QString,QByteArray)", [&]() {
+                ++produced;
+                maximumAhead = qMax(maximumAhead, produced - received.count());
+                QByteArray bytes;
+                QDataStream stream(&bytes, QIODevice::WriteOnly);
+                stream << QString("file%1").arg(produced);
+                stream << QByteArray(16 * 1024, 'x');
+                return bytes;
+            });
+        }
+
+        // Content is only produced once the socket can take it
+        QCOMPARE(produced, 0);
+        QTRY_COMPARE(received.count(), count);
+        QCOMPARE(produced, count);
+        QVERIFY(maximumAhead < count);
+        QTRY_COMPARE(peer2.pendingCount(), 0);
+    }
+
+    void compression() {
+        IpcServer peer1;
+        peer1.listen(10234);
+        QSignalSpy received(&peer1, &IpcServer::received);
+
+        // The server side announces it accepts compressed content
+        QScopedPointer<IpcClient> reply;
+        void (IpcServer::*IpcServer__clientConnected_transport)(IpcTransport*) = &IpcServer::clientConnected;
+        connect(&peer1, IpcServer__clientConnected_transport, [&reply](IpcTransport *transport) {
+            reply.reset(new IpcClient(transport));
+        });
+
+        // Local connections are never compressed
+        IpcClient peer2;
+        peer2.setLocalTransportEnabled(false);
+        qint64 written = 0;
+        connect(&peer2, &IpcClient::bytesWritten, [&written](qint64 bytes) { written += bytes; });
+        peer2.connectToServer("127.0.0.1", 10234);
+        QTRY_VERIFY(reply);
+        QTest::qWait(100);
+
+        QByteArray text;
+        for (int i = 0; i < 1000; ++i)
+            text += "Rectangle { width: 100; height: 100; color: \"red\" }\n";
+        peer2.send("sendFile(QString,QByteArray)", text);
+
+        QTRY_COMPARE(received.count(), 1);
+        QCOMPARE(received.at(0).at(0).toString(), QString("sendFile(QString,QByteArray)"));
+        QCOMPARE(received.at(0).at(1).toByteArray(), text);
+        QVERIFY(written < text.size() / 4);
+    }
+
+    void frameVersions_data() {
+        QTest::addColumn<int>("version");
+        QTest::newRow("text") << int(IpcProtocol::TextVersion);
+        QTest::newRow("binary") << int(IpcProtocol::BinaryVersion);
+    }
+
+    void frameVersions() {
+        QFETCH(int, version);
+
+        IpcServer peer1;
+        peer1.listen(10234);
+        QSignalSpy received(&peer1, &IpcServer::received);
+
+        // The server side announces the frame version it reads
+        QScopedPointer<IpcClient> reply;
+        void (IpcServer::*IpcServer__clientConnected_transport)(IpcTransport*) = &IpcServer::clientConnected;
+        connect(&peer1, IpcServer__clientConnected_transport, [&reply](IpcTransport *transport) {
+            reply.reset(new IpcClient(transport));
+        });
+
+        IpcClient peer2;
+        peer2.setProtocolVersion(version);
+        QCOMPARE(peer2.protocolVersion(), version);
+        peer2.connectToServer("127.0.0.1", 10234);
+        QTRY_VERIFY(reply);
+        QTest::qWait(100);
+
+        // Methods are named once per connection in binary frames
+        const QStringList methods = QStringList() << "echo(QString)" << "sendFile(QString,QByteArray)";
+        for (int i = 0; i < 10; ++i)
+            peer2.send(methods.at(i % 2), QByteArray::number(i));
+        const QByteArray large(4096, 'x');
+        peer2.send("sendFile(QString,QByteArray)", large);
+
+        QTRY_COMPARE(received.count(), 11);
+        for (int i = 0; i < 10; ++i) {
+            QCOMPARE(received.at(i).at(0).toString(), methods.at(i % 2));
+            QCOMPARE(received.at(i).at(1).toByteArray(), QByteArray::number(i));
+        }
+        QCOMPARE(received.at(10).at(1).toByteArray(), large);
+    }
+
+    void localTransport_data() {
+        QTest::addColumn<bool>("local");
+        QTest::addColumn<int>("sharedMemorySize");
+        QTest::newRow("tcp") << false << 16 * 1024 * 1024;
+        QTest::newRow("local") << true << 0;
+        QTest::newRow("shared memory") << true << 16 * 1024 * 1024;
+    }
+
+    void localTransport() {
+        QFETCH(bool, local);
+        QFETCH(int, sharedMemorySize);
+
+        IpcServer peer1;
+        peer1.listen(10234);
+        QSignalSpy received(&peer1, &IpcServer::received);
+
+        QScopedPointer<IpcClient> reply;
+        void (IpcServer::*IpcServer__clientConnected_transport)(IpcTransport*) = &IpcServer::clientConnected;
+        connect(&peer1, IpcServer__clientConnected_transport, [&reply](IpcTransport *transport) {
+            reply.reset(new IpcClient(transport));
+        });
+
+        IpcClient peer2;
+        peer2.setLocalTransportEnabled(local);
+        peer2.setSharedMemorySize(sharedMemorySize);
+        peer2.connectToServer("127.0.0.1", 10234);
+        QVERIFY(peer2.waitForConnected());
+        QCOMPARE(peer2.transport()->kind(), local ? IpcTransport::LocalTransport : IpcTransport::TcpTransport);
+        QTRY_VERIFY(reply);
+        QTest::qWait(100);
+
+        // More than the ring takes at once, so it wraps around and overflows
+        QList<QByteArray> contents;
+        for (int i = 0; i < 24; ++i)
+            contents.append(QByteArray(1024 * 1024 + i, char('a' + i)));
+        contents.append(QByteArray("small"));
+        foreach (const QByteArray &content, contents)
+            peer2.send("sendFile(QString,QByteArray)", content);
+
+        QTRY_COMPARE(received.count(), contents.count());
+        for (int i = 0; i < contents.count(); ++i)
+            QCOMPARE(received.at(i).at(1).toByteArray(), contents.at(i));
+    }
+
+    void localTransportFallback() {
+        // Nothing listens locally on the port of a plain TCP server
+        QTcpServer server;
+        QVERIFY(server.listen(QHostAddress::LocalHost, 10235));
+
+        IpcClient peer2;
+        peer2.connectToServer("127.0.0.1", 10235);
+        QVERIFY(peer2.waitForConnected());
+        QCOMPARE(peer2.transport()->kind(), IpcTransport::TcpTransport);
+    }
+
+    void typedCalls() {
+        const IpcMethod<QString, qint64, QByteArray> chunk(0, "chunk(QString,qint64,QByteArray)");
+        const IpcMethod<> ping(1, "ping()");
+        const IpcMethod<IpcRawContent> raw(2, "raw()");
+
+        // Same encoding as streaming the arguments by hand
+        QByteArray bytes;
+        QDataStream stream(&bytes, QIODevice::WriteOnly);
+        stream << QString("main.qml") << qint64(42) << QByteArray("data");
+        QCOMPARE(chunk.pack(QString("main.qml"), 42, QByteArray("data")), bytes);
+        QCOMPARE(raw.pack(IpcRawContent{QByteArray("1")}), QByteArray("1"));
+
+        IpcDispatcher dispatcher;
+        QString document;
+        qint64 offset = 0;
+        QByteArray data;
+        int pings = 0;
+        dispatcher.on(chunk, [&](const QString &d, qint64 o, const QByteArray &c) {
+            document = d;
+            offset = o;
+            data = c;
+        });
+        dispatcher.on(ping, [&]() { ++pings; });
+        dispatcher.on(raw, [&](const IpcRawContent &content) { data = content.data; });
+
+        QCOMPARE(dispatcher.methodId("chunk(QString,qint64,QByteArray)"), 0);
+        QCOMPARE(dispatcher.methodId("unknown()"), -1);
+        QVERIFY(dispatcher.dispatch(dispatcher.methodId("chunk(QString,qint64,QByteArray)"), bytes));
+        QCOMPARE(document, QString("main.qml"));
+        QCOMPARE(offset, qint64(42));
+        QCOMPARE(data, QByteArray("data"));
+        QVERIFY(dispatcher.dispatch(ping.id(), QByteArray()));
+        QCOMPARE(pings, 1);
+        QVERIFY(dispatcher.dispatch(raw.id(), QByteArray("0")));
+        QCOMPARE(data, QByteArray("0"));
+
+        // Truncated content is rejected before the handler runs
+        QVERIFY(!dispatcher.dispatch(chunk.id(), bytes.left(6)));
+        QCOMPARE(data, QByteArray("0"));
+        QVERIFY(!dispatcher.dispatch(-1, bytes));
+    }
+
+    void supersede() {
+        IpcServer peer1;
+        peer1.listen(10234);
+        QSignalSpy received(&peer1, &IpcServer::received);
+        IpcClient peer2;
+        peer2.connectToServer("127.0.0.1", 10234);
+        QVERIFY(peer2.waitForConnected());
+
+        // Queued in one go, nothing is written before returning to the event loop
+        QSignalSpy superseded(&peer2, &IpcClient::superseded);
+        const QUuid first = peer2.send("sendFile(QString,QByteArray)", QByteArray("v1"), "main.qml");
+        peer2.send("echo(QString)", QByteArray("unkeyed"));
+        const QUuid second = peer2.send("sendFile(QString,QByteArray)", QByteArray("v2"), "main.qml");
+        peer2.send("sendFile(QString,QByteArray)", QByteArray("v3"), "main.qml");
+
+        QTRY_COMPARE(received.count(), 2);
+        QTest::qWait(100);
+        QCOMPARE(received.count(), 2);
+        QCOMPARE(superseded.count(), 2);
+        QCOMPARE(superseded.at(0).at(0).value<QUuid>(), first);
+        QCOMPARE(superseded.at(1).at(0).value<QUuid>(), second);
+
+        // The latest version takes the place of the first one
+        QCOMPARE(received.at(0).at(1).toByteArray(), QByteArray("v3"));
+        QCOMPARE(received.at(1).at(1).toByteArray(), QByteArray("unkeyed"));
+    }
+
+    void lanes() {
+        IpcServer peer1;
+        peer1.listen(10234);
+        QSignalSpy received(&peer1, &IpcServer::received);
+        IpcClient peer2;
+        peer2.connectToServer("127.0.0.1", 10234);
+        QVERIFY(peer2.waitForConnected());
+
+        // Queued in one go, so the lanes decide the order
+        peer2.send("sendFile(QString,QByteArray)", QByteArray("bulk1"));
+        peer2.send("sendFile(QString,QByteArray)", QByteArray("interactive"), "main.qml",
+                   IpcClient::InteractiveLane);
+        peer2.send("sendFile(QString,QByteArray)", QByteArray("bulk2"));
+        peer2.send("setXOffset(int)", QByteArray("control"), QString(), IpcClient::ControlLane);
+
+        QTRY_COMPARE(received.count(), 4);
+        QCOMPARE(received.at(0).at(1).toByteArray(), QByteArray("control"));
+        QCOMPARE(received.at(1).at(1).toByteArray(), QByteArray("interactive"));
+        QCOMPARE(received.at(2).at(1).toByteArray(), QByteArray("bulk1"));
+        QCOMPARE(received.at(3).at(1).toByteArray(), QByteArray("bulk2"));
+
+        // Superseding moves a package to the lane of its newer version
+        QSignalSpy superseded(&peer2, &IpcClient::superseded);
+        peer2.send("sendFile(QString,QByteArray)", QByteArray("bulk3"));
+        peer2.send("sendFile(QString,QByteArray)", QByteArray("v1"), "main.qml");
+        peer2.send("sendFile(QString,QByteArray)", QByteArray("v2"), "main.qml",
+                   IpcClient::InteractiveLane);
+
+        QTRY_COMPARE(received.count(), 6);
+        QCOMPARE(superseded.count(), 1);
+        QCOMPARE(received.at(4).at(1).toByteArray(), QByteArray("v2"));
+        QCOMPARE(received.at(5).at(1).toByteArray(), QByteArray("bulk3"));
+    }
 };
 
 QTEST_MAIN(TestIpc)
@@ -0,0 +1,11 @@
+QT       += testlib core network quick
+
+TARGET = tst_testreceiver
+CONFIG   += testcase c++11
+
+include($$PWD/../../src/lib.pri)
+
+TEMPLATE = app
+
+SOURCES += \
+    tst_testreceiver.cpp
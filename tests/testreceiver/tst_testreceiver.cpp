@@ -0,0 +1,195 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 Luxoft Sweden AB
+** Copyright (C) 2018 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QML Live tool.
+**
+** $QT_BEGIN_LICENSE:GPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: GPL-3.0
+**
+****************************************************************************/
+
+#include <QtTest>
+
+#include "remotereceiver.h"
+#include "remoteprotocol.h"
+#include "livenodeengine.h"
+#include "livedocument.h"
+#include "ipc/ipcclient.h"
+
+static const int Port = 10236;
+
+class TestReceiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestReceiver() {}
+
+private:
+    template <typename... Args>
+    void send(IpcClient *client, const IpcMethod<Args...> &method,
+              const typename std::common_type<Args>::type &... args)
+    {
+        client->send(method.signature(), method.pack(args...));
+    }
+
+    // Records what reaches the node, so the order across connections shows
+    void record(RemoteReceiver *receiver)
+    {
+        connect(receiver, &RemoteReceiver::pinOk, [this](bool ok) {
+            m_events.append(ok ? "pinOk" : "pinFailed");
+        });
+        connect(receiver, &RemoteReceiver::beginBulkUpdate, [this]() {
+            m_events.append("beginBulk");
+        });
+        connect(receiver, &RemoteReceiver::endBulkUpdate, [this]() {
+            m_events.append("endBulk");
+        });
+        connect(receiver, &RemoteReceiver::updateDocument, [this](const LiveDocument &document, const QByteArray &) {
+            m_events.append("update " + document.relativeFilePath());
+        });
+        connect(receiver, &RemoteReceiver::updateDocumentChunk,
+                [this](const LiveDocument &document, qint64, const QByteArray &) {
+            m_events.append("chunk " + document.relativeFilePath());
+        });
+        connect(receiver, &RemoteReceiver::endUpdateDocument, [this](const LiveDocument &document) {
+            m_events.append("end " + document.relativeFilePath());
+        });
+    }
+
+    QStringList m_events;
+
+private Q_SLOTS:
+    void init()
+    {
+        m_events.clear();
+    }
+
+    void pinPerConnection()
+    {
+        LiveNodeEngine node;
+        RemoteReceiver receiver;
+        receiver.registerNode(&node);
+        receiver.setPin("1234");
+        receiver.listen(Port);
+        record(&receiver);
+        int connections = 0;
+        connect(&receiver, &RemoteReceiver::clientConnected, [&connections]() { ++connections; });
+
+        IpcClient a;
+        a.connectToServer("127.0.0.1", Port);
+        IpcClient b;
+        b.connectToServer("127.0.0.1", Port);
+        QTRY_COMPARE(connections, 2);
+
+        send(&a, RemoteProtocol::checkPin, QString("1234"));
+        QTRY_COMPARE(m_events, QStringList() << "pinOk");
+
+        // Authenticating one hub does not let the other one in
+        send(&b, RemoteProtocol::sendDocument, QString("b.qml"), QByteArray("b"));
+        send(&b, RemoteProtocol::checkPin, QString("0000"));
+        QTRY_COMPARE(m_events.count(), 2);
+        send(&b, RemoteProtocol::sendDocument, QString("b.qml"), QByteArray("b"));
+        send(&a, RemoteProtocol::sendDocument, QString("a.qml"), QByteArray("a"));
+        QTRY_COMPARE(m_events.count(), 3);
+        QTest::qWait(100);
+        QCOMPARE(m_events, QStringList() << "pinOk" << "pinFailed" << "update a.qml");
+    }
+
+    void bulkSendDefersOthers()
+    {
+        LiveNodeEngine node;
+        RemoteReceiver receiver;
+        receiver.registerNode(&node);
+        receiver.listen(Port);
+        record(&receiver);
+        int connections = 0;
+        connect(&receiver, &RemoteReceiver::clientConnected, [&connections]() { ++connections; });
+
+        IpcClient a;
+        a.connectToServer("127.0.0.1", Port);
+        IpcClient b;
+        b.connectToServer("127.0.0.1", Port);
+        QTRY_COMPARE(connections, 2);
+
+        send(&a, RemoteProtocol::beginBulkSend);
+        send(&a, RemoteProtocol::sendDocument, QString("a1.qml"), QByteArray("a1"));
+        QTRY_COMPARE(m_events, QStringList() << "beginBulk" << "update a1.qml");
+
+        // The other hub waits while the bulk send is open ...
+        send(&b, RemoteProtocol::sendDocument, QString("b.qml"), QByteArray("b"));
+        QTest::qWait(200);
+        send(&a, RemoteProtocol::sendDocument, QString("a2.qml"), QByteArray("a2"));
+        QTRY_COMPARE(m_events.count(), 3);
+        QCOMPARE(m_events.last(), QString("update a2.qml"));
+
+        // ... and is applied once it ends
+        send(&a, RemoteProtocol::endBulkSend);
+        QTRY_COMPARE(m_events.count(), 5);
+        QCOMPARE(m_events.mid(3), QStringList() << "endBulk" << "update b.qml");
+    }
+
+    void disconnectDuringChunks()
+    {
+        LiveNodeEngine node;
+        RemoteReceiver receiver;
+        receiver.registerNode(&node);
+        receiver.listen(Port);
+        record(&receiver);
+        int connections = 0;
+        connect(&receiver, &RemoteReceiver::clientConnected, [&connections]() { ++connections; });
+        int disconnections = 0;
+        connect(&receiver, &RemoteReceiver::clientDisconnected, [&disconnections]() { ++disconnections; });
+
+        IpcClient a;
+        a.connectToServer("127.0.0.1", Port);
+        IpcClient b;
+        b.connectToServer("127.0.0.1", Port);
+        QTRY_COMPARE(connections, 2);
+
+        send(&a, RemoteProtocol::beginDocument, QString("a.qml"), qint64(100));
+        send(&a, RemoteProtocol::sendDocumentChunk, QString("a.qml"), qint64(0), QByteArray(10, 'a'));
+        QTRY_COMPARE(m_events, QStringList() << "chunk a.qml");
+
+        send(&b, RemoteProtocol::sendDocument, QString("b.qml"), QByteArray("b"));
+        QTest::qWait(200);
+        QCOMPARE(m_events.count(), 1);
+
+        // The partial document is discarded and the hold released
+        a.disconnectFromServer();
+        QTRY_COMPARE(disconnections, 1);
+        QTRY_COMPARE(m_events.count(), 3);
+        QCOMPARE(m_events.mid(1), QStringList() << "end a.qml" << "update b.qml");
+
+        // Nothing is held anymore
+        send(&b, RemoteProtocol::sendDocument, QString("c.qml"), QByteArray("c"));
+        QTRY_COMPARE(m_events.count(), 4);
+        QCOMPARE(m_events.last(), QString("update c.qml"));
+    }
+};
+
+QTEST_MAIN(TestReceiver)
+
+#include "tst_testreceiver.moc"
@@ -3,6 +3,11 @@ TEMPLATE = subdirs
 
 
 SUBDIRS += \
-    testipc
+    testipc \
+    testreceiver \
+    testignore \
+    benchwatcher \
+    benchdelta \
+    benchipc
     #testsync \
     #http